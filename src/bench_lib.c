@@ -0,0 +1,508 @@
+/**
+ * Library benchmark source (not to be built with library)
+ * Build executable with self + library source to time texture loading, shader
+ * loading/compiling, drawing and camera math headless (no window or input)
+ *
+ * Usage: bench [--resources <dir>] [--iterations <n>] [--output <file.json>]
+ * Results: See README.md
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <SDL.h>
+
+#include "sdl_gl.h"
+#include "glsl_shader.h"
+#include "gl_state.h"
+#include "gl_batch.h"
+#include "gl_math.h"
+#include "texture_mipmap.h"
+
+#define BENCH_MAX_SAMPLES 1000
+#define BENCH_MAX_RESULTS 32
+#define BENCH_PATH_SIZE 1000
+#define BENCH_NAME_SIZE 64 // Resource file name, including NUL
+
+#define BENCH_WIDTH 1280
+#define BENCH_HEIGHT 720
+#define BENCH_LARGE_BMP_SIZE 2048    // Generated stress texture (width and height)
+#define BENCH_LARGE_SHADER_LINES 4000 // Generated stress shader
+#define BENCH_SHADER_VARIANTS 200     // Programs compiled per sample
+#define BENCH_DRAWS 5000              // Shader switches + draws per sample
+#define BENCH_SPRITES 100000          // Batched quads per sample
+#define BENCH_CAMERA_UPDATES 100000   // Camera matrix rebuilds per sample
+#define BENCH_MATRICES 10000          // mat4MultiplyBatch() size
+
+#define NUM_BENCH_TEXTURES 4
+#define NUM_BENCH_FRAGMENTS 4
+
+typedef struct {
+	const char* name;
+	const char* work_unit;      // Unit of work per sample (eg: "MB", "draws")
+	double work;                // Work per sample, reported as work_unit per second at median
+	double samples[BENCH_MAX_SAMPLES]; // Milliseconds
+	int count;
+} BenchResult;
+
+BenchResult BENCH_RESULTS[BENCH_MAX_RESULTS];
+int BENCH_RESULT_COUNT = 0;
+int BENCH_ITERATIONS = 20;
+char BENCH_RESOURCES[BENCH_PATH_SIZE - BENCH_NAME_SIZE] = "resources"; // Leaves room for '/' + file name
+
+const char BENCH_TEXTURE_FILENAMES[NUM_BENCH_TEXTURES][BENCH_NAME_SIZE] = {
+	"test_corners_colors_oddres_32bit_alpha.bmp",
+	"test_corners_colors_oddres_24bit.bmp",
+	"test_corners_colors_oddres_16bit.bmp",
+	"test_corners_colors_oddres_16bit_alpha.bmp"
+};
+const char BENCH_FRAGMENT_FILENAMES[NUM_BENCH_FRAGMENTS][BENCH_NAME_SIZE] = {
+	"shader_color.frag",
+	"shader_texture.frag",
+	"shader_color_texcoord_alpha.frag",
+	"shader_noise_mask.frag"
+};
+const char BENCH_VERTEX_FILENAME[] = "common_color_textcoord.vert";
+const char BENCH_LARGE_BMP[] = "bench_large.bmp";
+const char BENCH_LARGE_SHADER[] = "bench_large.frag";
+
+/*
+ * Timing and results
+ */
+static double benchNow() {
+	return (double)SDL_GetPerformanceCounter() * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+static BenchResult* beginBench(const char* name, const char* work_unit, double work) {
+	BenchResult* result = &BENCH_RESULTS[BENCH_RESULT_COUNT++];
+
+	result->name = name;
+	result->work_unit = work_unit;
+	result->work = work;
+	result->count = 0;
+	fprintf(stderr, "Running %s\n", name);
+	return result;
+}
+
+static void addBenchSample(BenchResult* result, double ms) {
+	if (result->count < BENCH_MAX_SAMPLES) result->samples[result->count++] = ms;
+}
+
+static int compareBenchSamples(const void* a, const void* b) {
+	double da = *(const double*)a;
+	double db = *(const double*)b;
+	return (da > db) - (da < db);
+}
+
+static void writeBenchString(FILE* file, const char* string) {
+	fputc('"', file);
+	for (; *string; string++) {
+		if (*string == '"' || *string == '\\') fputc('\\', file);
+		if ((unsigned char)*string >= 0x20) fputc(*string, file);
+	}
+	fputc('"', file);
+}
+
+static void writeBenchResult(FILE* file, BenchResult* result) {
+	double sum = 0.0, median;
+	int i, p99;
+
+	qsort(result->samples, result->count, sizeof(double), compareBenchSamples);
+	for (i = 0; i < result->count; i++) sum += result->samples[i];
+	median = result->samples[result->count / 2];
+	p99 = (int)(result->count * 0.99 + 0.999999) - 1;
+	if (p99 < 0) p99 = 0;
+
+	fprintf(file, "    {\"name\": ");
+	writeBenchString(file, result->name);
+	fprintf(file, ", \"samples\": %d, \"min_ms\": %.4f, \"median_ms\": %.4f, \"p99_ms\": %.4f, \"mean_ms\": %.4f, ",
+		result->count, result->samples[0], median, result->samples[p99], sum / result->count);
+	fprintf(file, "\"throughput\": %.2f, \"throughput_unit\": \"%s/s\"}",
+		median > 0.0 ? result->work * 1000.0 / median : 0.0, result->work_unit);
+}
+
+static bool writeBenchResults(const char* filename) {
+	FILE* file = stdout;
+	int i;
+
+	if (filename != NULL) {
+		file = fopen(filename, "w");
+		if (file == NULL) {
+			fprintf(stderr, "Unable to open %s\n", filename);
+			return false;
+		}
+	}
+
+	fprintf(file, "{\n  \"gl_vendor\": ");
+	writeBenchString(file, (const char*)glGetString(GL_VENDOR));
+	fprintf(file, ",\n  \"gl_renderer\": ");
+	writeBenchString(file, (const char*)glGetString(GL_RENDERER));
+	fprintf(file, ",\n  \"gl_version\": ");
+	writeBenchString(file, SDL_GL_VERSION);
+	fprintf(file, ",\n  \"glsl_version\": ");
+	writeBenchString(file, SDL_GLSL_VERSION);
+	fprintf(file, ",\n  \"iterations\": %d,\n  \"results\": [\n", BENCH_ITERATIONS);
+	for (i = 0; i < BENCH_RESULT_COUNT; i++) {
+		writeBenchResult(file, &BENCH_RESULTS[i]);
+		fprintf(file, i + 1 < BENCH_RESULT_COUNT ? ",\n" : "\n");
+	}
+	fprintf(file, "  ]\n}\n");
+
+	if (file != stdout) fclose(file);
+	return true;
+}
+
+static void getResourcePath(char* path, const char* filename) {
+	// Directory and file name are both size limited, so the path always fits
+	snprintf(path, BENCH_PATH_SIZE, "%s/%.*s", BENCH_RESOURCES, BENCH_NAME_SIZE - 1, filename);
+}
+
+/*
+ * Generated stress inputs
+ */
+static bool createLargeBMP(const char* filename) {
+	SDL_Surface* surface;
+	Uint8* row;
+	int x, y;
+	bool saved;
+
+	surface = SDL_CreateRGBSurfaceWithFormat(0, BENCH_LARGE_BMP_SIZE, BENCH_LARGE_BMP_SIZE, 24, SDL_PIXELFORMAT_BGR24);
+	if (surface == NULL) return false;
+
+	for (y = 0; y < surface->h; y++) {
+		row = (Uint8*)surface->pixels + (size_t)surface->pitch * y;
+		for (x = 0; x < surface->w; x++) {
+			row[x * 3 + 0] = (Uint8)(x ^ y);
+			row[x * 3 + 1] = (Uint8)y;
+			row[x * 3 + 2] = (Uint8)x;
+		}
+	}
+	saved = SDL_SaveBMP(surface, filename) == 0;
+	SDL_FreeSurface(surface);
+
+	return saved;
+}
+
+static bool createLargeShader(const char* filename) {
+	FILE* file;
+	int i;
+
+	file = fopen(filename, "w");
+	if (file == NULL) return false;
+
+	fprintf(file, "// Generated by bench_lib.c\nvarying vec4 v_color;\n\nvoid main()\n{\n    vec4 color = v_color;\n");
+	for (i = 0; i < BENCH_LARGE_SHADER_LINES; i++) {
+		fprintf(file, "    color.rgb = color.rgb * %d.0 / %d.0; // Line %d keeps the compiler busy\n", i + 2, i + 3, i);
+	}
+	fprintf(file, "    gl_FragColor = color;\n}\n");
+
+	return fclose(file) == 0;
+}
+
+/*
+ * Benchmarks
+ */
+static void benchTextureLoad() {
+	char path[BENCH_PATH_SIZE];
+	Texture* texture;
+	BenchResult* result;
+	double start, bytes = 0.0;
+	int n, i;
+
+	// Size work from first load
+	for (i = 0; i < NUM_BENCH_TEXTURES; i++) {
+		getResourcePath(path, BENCH_TEXTURE_FILENAMES[i]);
+		texture = loadTextureBMP(path, false);
+		if (texture == NULL) {
+			fprintf(stderr, "Skipping texture_load_bmp: %s\n", SDL_GetError());
+			return;
+		}
+		bytes += texture->bytes;
+		freeTexture(texture);
+	}
+
+	result = beginBench("texture_load_bmp", "MB", bytes / (1024.0 * 1024.0));
+	for (n = 0; n < BENCH_ITERATIONS; n++) {
+		start = benchNow();
+		for (i = 0; i < NUM_BENCH_TEXTURES; i++) {
+			getResourcePath(path, BENCH_TEXTURE_FILENAMES[i]);
+			texture = loadTextureBMP(path, false);
+			glFinish();
+			freeTexture(texture);
+		}
+		addBenchSample(result, benchNow() - start);
+	}
+}
+
+static void benchLargeTextureLoad(const char* name, Uint32 flags) {
+	Texture* texture;
+	BenchResult* result;
+	double start;
+	int n;
+
+	result = beginBench(name, "MB", (double)BENCH_LARGE_BMP_SIZE * BENCH_LARGE_BMP_SIZE * 3 / (1024.0 * 1024.0));
+	for (n = 0; n < BENCH_ITERATIONS; n++) {
+		start = benchNow();
+		texture = loadTextureBMPEx(BENCH_LARGE_BMP, flags);
+		glFinish();
+		addBenchSample(result, benchNow() - start);
+		if (texture == NULL) {
+			fprintf(stderr, "%s failed: %s\n", name, SDL_GetError());
+			BENCH_RESULT_COUNT--;
+			return;
+		}
+		freeTexture(texture);
+	}
+}
+
+static void benchShaderSource() {
+	char path[BENCH_PATH_SIZE];
+	Shader shader;
+	BenchResult* result;
+	double start, bytes = 0.0;
+	int n, i;
+
+	result = beginBench("shader_load_source", "MB", 0.0);
+	for (n = 0; n < BENCH_ITERATIONS; n++) {
+		// Drop memoized files so each sample reads from disk
+		freeGLSLFiles();
+		start = benchNow();
+		memset(&shader, 0, sizeof(Shader));
+		for (i = 0; i < NUM_BENCH_FRAGMENTS + 1; i++) {
+			if (i < NUM_BENCH_FRAGMENTS) getResourcePath(path, BENCH_FRAGMENT_FILENAMES[i]);
+			else snprintf(path, BENCH_PATH_SIZE, "%s", BENCH_LARGE_SHADER);
+			if (loadGLSLFile(&shader, GLSL_FRAG, path) != GLSL_SUCCESS) {
+				fprintf(stderr, "shader_load_source failed: %s\n", SDL_GetError());
+				BENCH_RESULT_COUNT--;
+				return;
+			}
+			if (n == 0) bytes += shader.frag_source_len;
+			free(shader.frag_source);
+			shader.frag_source = NULL;
+		}
+		addBenchSample(result, benchNow() - start);
+	}
+	result->work = bytes / (1024.0 * 1024.0);
+}
+
+static void benchShaderCompile() {
+	char vert_path[BENCH_PATH_SIZE];
+	char frag_path[BENCH_PATH_SIZE];
+	char define[32];
+	const char* defines[1];
+	Shader* shaders;
+	BenchResult* result;
+	double start;
+	int n, i;
+	int iterations = BENCH_ITERATIONS < 5 ? BENCH_ITERATIONS : 5;
+
+	if (!SDL_GLSL_SUPPORTED) {
+		fprintf(stderr, "Skipping shader_compile: shaders unsupported\n");
+		return;
+	}
+	shaders = (Shader*)calloc(BENCH_SHADER_VARIANTS, sizeof(Shader));
+	if (shaders == NULL) return;
+
+	getResourcePath(vert_path, BENCH_VERTEX_FILENAME);
+	result = beginBench("shader_compile", "programs", BENCH_SHADER_VARIANTS);
+	for (n = 0; n < iterations; n++) {
+		// Every variant differs so drivers cannot reuse an earlier compile
+		memset(shaders, 0, sizeof(Shader) * BENCH_SHADER_VARIANTS);
+		for (i = 0; i < BENCH_SHADER_VARIANTS; i++) {
+			getResourcePath(frag_path, BENCH_FRAGMENT_FILENAMES[i % NUM_BENCH_FRAGMENTS]);
+			snprintf(define, sizeof(define), "BENCH_VARIANT %d", n * BENCH_SHADER_VARIANTS + i);
+			defines[0] = define;
+			preprocessGLSLFile(&shaders[i], GLSL_VERT, vert_path, defines, 1);
+			preprocessGLSLFile(&shaders[i], GLSL_FRAG, frag_path, defines, 1);
+		}
+
+		start = benchNow();
+		compileShaders(shaders, BENCH_SHADER_VARIANTS);
+		glFinish();
+		addBenchSample(result, benchNow() - start);
+
+		freeShaders(shaders);
+	}
+	free(shaders);
+}
+
+static void benchShaderDraw() {
+	char vert_path[BENCH_PATH_SIZE];
+	char frag_path[BENCH_PATH_SIZE];
+	Shader shaders[NUM_BENCH_FRAGMENTS];
+	BenchResult* result;
+	double start;
+	int n, i;
+
+	if (!SDL_GLSL_SUPPORTED) {
+		fprintf(stderr, "Skipping shader_draw: shaders unsupported\n");
+		return;
+	}
+
+	memset(shaders, 0, sizeof(shaders));
+	getResourcePath(vert_path, BENCH_VERTEX_FILENAME);
+	for (i = 0; i < NUM_BENCH_FRAGMENTS; i++) {
+		getResourcePath(frag_path, BENCH_FRAGMENT_FILENAMES[i]);
+		loadGLSLFile(&shaders[i], GLSL_VERT, vert_path);
+		loadGLSLFile(&shaders[i], GLSL_FRAG, frag_path);
+	}
+	compileShaders(shaders, NUM_BENCH_FRAGMENTS);
+
+	result = beginBench("shader_draw", "draws", BENCH_DRAWS);
+	for (n = 0; n < BENCH_ITERATIONS; n++) {
+		start = benchNow();
+		drawGLBegin();
+		glTranslatef(0.0f, 0.0f, -4.0f);
+		for (i = 0; i < BENCH_DRAWS; i++) {
+			glslShaderDraw(&shaders[i % NUM_BENCH_FRAGMENTS], true);
+			glBegin(GL_QUADS);
+			glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+			glTexCoord2f(0.0f, 0.0f); glVertex3f(-0.1f, 0.1f, 0.0f);
+			glTexCoord2f(1.0f, 0.0f); glVertex3f(0.1f, 0.1f, 0.0f);
+			glTexCoord2f(1.0f, 1.0f); glVertex3f(0.1f, -0.1f, 0.0f);
+			glTexCoord2f(0.0f, 1.0f); glVertex3f(-0.1f, -0.1f, 0.0f);
+			glEnd();
+		}
+		glslShaderDraw(NULL, false);
+		drawGLEnd(NULL);
+		glFinish();
+		addBenchSample(result, benchNow() - start);
+	}
+
+	freeShaders(shaders);
+}
+
+static void benchBatchDraw() {
+	const SDL_Color white = {255, 255, 255, 255};
+	BenchResult* result;
+	double start;
+	int n, i;
+
+	if (!glBatchInit(GL_BATCH_MAX_QUADS)) {
+		fprintf(stderr, "Skipping batch_draw: %s\n", SDL_GetError());
+		return;
+	}
+
+	result = beginBench("batch_draw", "quads", BENCH_SPRITES);
+	for (n = 0; n < BENCH_ITERATIONS; n++) {
+		start = benchNow();
+		drawGLBegin();
+		glTranslatef(0.0f, 0.0f, -4.0f);
+		glBatchTexture(0);
+		for (i = 0; i < BENCH_SPRITES; i++) {
+			glBatchSprite((i % 320) * 0.01f - 1.6f, (i / 320) * 0.01f - 1.6f, 0.008f, 0.008f, 0.0f, 0.0f, 1.0f, 1.0f, white);
+		}
+		glBatchFlush();
+		drawGLEnd(NULL);
+		glFinish();
+		addBenchSample(result, benchNow() - start);
+	}
+
+	glBatchQuit();
+}
+
+static void benchCameraMath() {
+	float* matrices;
+	float view[16];
+	float projection[16];
+	float view_projection[16];
+	BenchResult* result;
+	volatile float sink = 0.0f;
+	double start;
+	int n, i;
+
+	result = beginBench("camera_update", "matrices", BENCH_CAMERA_UPDATES);
+	for (n = 0; n < BENCH_ITERATIONS; n++) {
+		start = benchNow();
+		// Per-frame camera work as debugCameraControl() + setShaderMatrices() do it
+		mat4Perspective(projection, BENCH_WIDTH, BENCH_HEIGHT, 75.0, 0.001, 100000.0);
+		mat4Identity(view);
+		for (i = 0; i < BENCH_CAMERA_UPDATES; i++) {
+			mat4Rotate(view, 0.01f, 0.0f, 1.0f, 0.0f);
+			mat4Translate(view, 0.0f, 0.0f, 0.001f);
+			mat4Multiply(view_projection, projection, view);
+		}
+		addBenchSample(result, benchNow() - start);
+		sink += view_projection[0];
+	}
+
+	matrices = (float*)malloc(sizeof(float) * 16 * BENCH_MATRICES);
+	if (matrices == NULL) return;
+	for (i = 0; i < BENCH_MATRICES; i++) {
+		mat4Identity(&matrices[i * 16]);
+		mat4Translate(&matrices[i * 16], (float)i, 0.0f, 0.0f);
+	}
+
+	result = beginBench("mat4_multiply_batch", "matrices", BENCH_MATRICES);
+	for (n = 0; n < BENCH_ITERATIONS; n++) {
+		start = benchNow();
+		mat4MultiplyBatch(matrices, view_projection, matrices, BENCH_MATRICES);
+		addBenchSample(result, benchNow() - start);
+		sink += matrices[0];
+	}
+
+	free(matrices);
+}
+
+int main(int argc, char** argv) {
+	HeadlessGL* headless;
+	const char* output = NULL;
+	bool written;
+	int i;
+
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--resources") == 0 && i + 1 < argc) {
+			if (snprintf(BENCH_RESOURCES, sizeof(BENCH_RESOURCES), "%s", argv[++i]) >= (int)sizeof(BENCH_RESOURCES)) {
+				fprintf(stderr, "Resource directory too long (max %d characters): %s\n", (int)sizeof(BENCH_RESOURCES) - 1, argv[i]);
+				return 1;
+			}
+		} else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) BENCH_ITERATIONS = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) output = argv[++i];
+		else {
+			fprintf(stderr, "Usage: %s [--resources <dir>] [--iterations <n>] [--output <file.json>]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (BENCH_ITERATIONS < 1) BENCH_ITERATIONS = 1;
+	if (BENCH_ITERATIONS > BENCH_MAX_SAMPLES) BENCH_ITERATIONS = BENCH_MAX_SAMPLES;
+
+	// Compiles must hit the compiler each run, not Mesa's on-disk cache
+	SDL_setenv("MESA_SHADER_CACHE_DISABLE", "true", 0);
+
+	headless = createHeadlessGL(BENCH_WIDTH, BENCH_HEIGHT, 75.0f, false);
+	if (headless == NULL) {
+		fprintf(stderr, "Unable to create headless context: %s\n", SDL_GetError());
+		SDL_Quit();
+		return 1;
+	}
+	initShaders();
+
+	if (!createLargeBMP(BENCH_LARGE_BMP) || !createLargeShader(BENCH_LARGE_SHADER)) {
+		fprintf(stderr, "Unable to write generated inputs: %s\n", SDL_GetError());
+		freeHeadlessGL(headless);
+		SDL_Quit();
+		return 1;
+	}
+
+	benchTextureLoad();
+	benchLargeTextureLoad("texture_load_bmp_large", 0);
+	benchLargeTextureLoad("texture_load_bmp_large_mipmaps", TEXTURE_MIPMAPS);
+	benchShaderSource();
+	benchShaderCompile();
+	benchShaderDraw();
+	benchBatchDraw();
+	benchCameraMath();
+
+	written = writeBenchResults(output);
+
+	// Clean Up
+	remove(BENCH_LARGE_BMP);
+	remove(BENCH_LARGE_SHADER);
+	freeGLSLFiles();
+	quitTextureRowThreads();
+	freeHeadlessGL(headless);
+	SDL_Quit();
+
+	return written ? 0 : 1;
+}
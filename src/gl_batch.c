@@ -0,0 +1,239 @@
+#include "gl_batch.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gl_state.h"
+#include "glsl_ext.h"
+
+#define GL_BATCH_UPLOAD_CLIENT 0 // Client-side arrays (no VBO)
+#define GL_BATCH_UPLOAD_SUBDATA 1 // Orphan + glBufferSubData every flush
+#define GL_BATCH_UPLOAD_MAP 2 // Unsynchronized mapped ranges, orphan when full
+
+// Flushes held in vertex buffer before it is orphaned (mapped upload only)
+#define GL_BATCH_STREAM_FLUSHES 8
+
+typedef struct {
+	int upload;
+	int max_quads;
+	int num_quads;
+	GLuint texture;
+	GLBatchVertex* vertices;
+	GLushort* indices;       // Client-side copy (GL_BATCH_UPLOAD_CLIENT only)
+	GLuint vertex_buffer;
+	GLuint index_buffer;
+	GLsizeiptr stream_size;
+	GLintptr stream_offset;
+} GLBatch;
+
+GLBatch GL_BATCH;
+GLBatchStats GL_BATCH_STATS;
+
+/*
+ * Upload
+ */
+// Returns offset of uploaded vertices in bound vertex buffer
+static GLintptr uploadGLBatchVertices(GLsizeiptr size) {
+	GLintptr offset;
+	void* mapped;
+
+	if (GL_BATCH.upload == GL_BATCH_UPLOAD_MAP) {
+		// Start a new buffer store instead of waiting on draws still reading this one
+		if (GL_BATCH.stream_offset + size > GL_BATCH.stream_size) {
+			glBufferData(GL_ARRAY_BUFFER, GL_BATCH.stream_size, NULL, GL_STREAM_DRAW);
+			GL_BATCH.stream_offset = 0;
+			GL_BATCH_STATS.orphans++;
+		}
+		offset = GL_BATCH.stream_offset;
+		mapped = glMapBufferRange(GL_ARRAY_BUFFER, offset, size,
+			GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+		if (mapped != NULL) {
+			memcpy(mapped, GL_BATCH.vertices, size);
+			if (glUnmapBuffer(GL_ARRAY_BUFFER)) {
+				GL_BATCH.stream_offset += size;
+				return offset;
+			}
+		}
+
+		// Mapping failed or store was lost; fall back for this flush
+		GL_BATCH.stream_offset = GL_BATCH.stream_size;
+	}
+
+	glBufferData(GL_ARRAY_BUFFER, GL_BATCH.stream_size, NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, size, GL_BATCH.vertices);
+	GL_BATCH_STATS.orphans++;
+	return 0;
+}
+
+/*
+ * Public API
+ */
+bool glBatchInit(int max_quads) {
+	int i;
+
+	if (GL_BATCH.vertices) glBatchQuit();
+	if (max_quads < 1 || max_quads > GL_BATCH_MAX_QUADS) {
+		SDL_SetError("Invalid batch size: %d quads (1 to %d)", max_quads, GL_BATCH_MAX_QUADS);
+		return false;
+	}
+
+	memset(&GL_BATCH, 0, sizeof(GLBatch));
+	GL_BATCH.max_quads = max_quads;
+	GL_BATCH.vertices = (GLBatchVertex*)malloc(sizeof(GLBatchVertex) * 4 * max_quads);
+	GL_BATCH.indices = (GLushort*)malloc(sizeof(GLushort) * 6 * max_quads);
+	if (!GL_BATCH.vertices || !GL_BATCH.indices) {
+		free(GL_BATCH.vertices);
+		free(GL_BATCH.indices);
+		GL_BATCH.vertices = NULL;
+		SDL_SetError("Failed to allocate batch memory for %d quads", max_quads);
+		return false;
+	}
+
+	// Every quad uses the same index pattern, so indices never change
+	for (i = 0; i < max_quads; i++) {
+		GL_BATCH.indices[i * 6 + 0] = (GLushort)(i * 4 + 0);
+		GL_BATCH.indices[i * 6 + 1] = (GLushort)(i * 4 + 1);
+		GL_BATCH.indices[i * 6 + 2] = (GLushort)(i * 4 + 2);
+		GL_BATCH.indices[i * 6 + 3] = (GLushort)(i * 4 + 2);
+		GL_BATCH.indices[i * 6 + 4] = (GLushort)(i * 4 + 3);
+		GL_BATCH.indices[i * 6 + 5] = (GLushort)(i * 4 + 0);
+	}
+
+	GL_BATCH.upload = GL_BATCH_UPLOAD_CLIENT;
+	if (createVertexBufferFunctions()) {
+		GL_BATCH.upload = (glMapBufferRange && glUnmapBuffer) ? GL_BATCH_UPLOAD_MAP : GL_BATCH_UPLOAD_SUBDATA;
+		GL_BATCH.stream_size = (GLsizeiptr)sizeof(GLBatchVertex) * 4 * max_quads;
+		if (GL_BATCH.upload == GL_BATCH_UPLOAD_MAP) GL_BATCH.stream_size *= GL_BATCH_STREAM_FLUSHES;
+		GL_BATCH.stream_offset = GL_BATCH.stream_size; // Orphan on first flush
+
+		glGenBuffers(1, &GL_BATCH.vertex_buffer);
+		glGenBuffers(1, &GL_BATCH.index_buffer);
+		glBindBuffer(GL_ARRAY_BUFFER, GL_BATCH.vertex_buffer);
+		glBufferData(GL_ARRAY_BUFFER, GL_BATCH.stream_size, NULL, GL_STREAM_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, GL_BATCH.index_buffer);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLushort) * 6 * max_quads, GL_BATCH.indices, GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+		// Index buffer now holds the only copy needed
+		free(GL_BATCH.indices);
+		GL_BATCH.indices = NULL;
+	}
+
+	return true;
+}
+
+void glBatchTexture(GLuint texture) {
+	if (GL_BATCH.texture != texture) {
+		glBatchFlush();
+		GL_BATCH.texture = texture;
+	}
+	glStateBindTexture(texture);
+}
+
+void glBatchShader(Shader* shader) {
+	GLhandleARB program = 0;
+
+	// Permutation shaders flush on change of variant actually bound
+	if (SDL_GLSL_SUPPORTED && SDL_GLSL_READY && shader != NULL) shader = getShaderVariant(shader, shader->features);
+	if (SDL_GLSL_SUPPORTED && SDL_GLSL_READY && shader != NULL && shader->ready) program = shader->program;
+	if (program != glStateGetProgram()) glBatchFlush();
+	glslShaderDraw(shader, shader != NULL);
+}
+
+void glBatchQuad(const GLBatchVertex* vertices) {
+	if (GL_BATCH.num_quads == GL_BATCH.max_quads) glBatchFlush();
+	memcpy(&GL_BATCH.vertices[GL_BATCH.num_quads * 4], vertices, sizeof(GLBatchVertex) * 4);
+	GL_BATCH.num_quads++;
+}
+
+void glBatchTriangle(const GLBatchVertex* vertices) {
+	GLBatchVertex* dst;
+
+	// Repeat last vertex; second triangle (2-2-0) is degenerate and never rasterized
+	if (GL_BATCH.num_quads == GL_BATCH.max_quads) glBatchFlush();
+	dst = &GL_BATCH.vertices[GL_BATCH.num_quads * 4];
+	memcpy(dst, vertices, sizeof(GLBatchVertex) * 3);
+	dst[3] = vertices[2];
+	GL_BATCH.num_quads++;
+}
+
+void glBatchSprite(float x, float y, float w, float h, float u0, float v0, float u1, float v1, SDL_Color color) {
+	GLBatchVertex* dst;
+	int i;
+
+	if (GL_BATCH.num_quads == GL_BATCH.max_quads) glBatchFlush();
+	dst = &GL_BATCH.vertices[GL_BATCH.num_quads * 4];
+
+	// Clockwise starting at top left
+	dst[0].x = x;     dst[0].y = y;     dst[0].u = u0; dst[0].v = v0;
+	dst[1].x = x + w; dst[1].y = y;     dst[1].u = u1; dst[1].v = v0;
+	dst[2].x = x + w; dst[2].y = y - h; dst[2].u = u1; dst[2].v = v1;
+	dst[3].x = x;     dst[3].y = y - h; dst[3].u = u0; dst[3].v = v1;
+	for (i = 0; i < 4; i++) {
+		dst[i].z = 0.0f;
+		dst[i].r = color.r;
+		dst[i].g = color.g;
+		dst[i].b = color.b;
+		dst[i].a = color.a;
+	}
+	GL_BATCH.num_quads++;
+}
+
+void glBatchFlush() {
+	const Uint8* base;
+	const GLushort* indices;
+	GLsizeiptr size;
+
+	if (GL_BATCH.num_quads == 0) return;
+
+	size = (GLsizeiptr)sizeof(GLBatchVertex) * 4 * GL_BATCH.num_quads;
+	if (GL_BATCH.upload == GL_BATCH_UPLOAD_CLIENT) {
+		base = (const Uint8*)GL_BATCH.vertices;
+		indices = GL_BATCH.indices;
+	} else {
+		glBindBuffer(GL_ARRAY_BUFFER, GL_BATCH.vertex_buffer);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, GL_BATCH.index_buffer);
+		base = (const Uint8*)(size_t)uploadGLBatchVertices(size);
+		indices = NULL;
+	}
+
+	// Offsetting pointers per flush keeps indices 0-based (no base vertex needed)
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(3, GL_FLOAT, sizeof(GLBatchVertex), base + offsetof(GLBatchVertex, x));
+	glTexCoordPointer(2, GL_FLOAT, sizeof(GLBatchVertex), base + offsetof(GLBatchVertex, u));
+	glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(GLBatchVertex), base + offsetof(GLBatchVertex, r));
+	glDrawElements(GL_TRIANGLES, GL_BATCH.num_quads * 6, GL_UNSIGNED_SHORT, indices);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+
+	// Leave buffers unbound so immediate mode and client arrays elsewhere still work
+	if (GL_BATCH.upload != GL_BATCH_UPLOAD_CLIENT) {
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+
+	GL_BATCH_STATS.quads += GL_BATCH.num_quads;
+	GL_BATCH_STATS.draws++;
+	GL_BATCH.num_quads = 0;
+}
+
+GLBatchStats glBatchGetStats() {
+	return GL_BATCH_STATS;
+}
+
+void glBatchResetStats() {
+	memset(&GL_BATCH_STATS, 0, sizeof(GLBatchStats));
+}
+
+void glBatchQuit() {
+	if (GL_BATCH.vertex_buffer) glDeleteBuffers(1, &GL_BATCH.vertex_buffer);
+	if (GL_BATCH.index_buffer) glDeleteBuffers(1, &GL_BATCH.index_buffer);
+	free(GL_BATCH.vertices);
+	free(GL_BATCH.indices);
+	memset(&GL_BATCH, 0, sizeof(GLBatch));
+}
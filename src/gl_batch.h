@@ -0,0 +1,115 @@
+#pragma once
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include <stdbool.h>
+
+#include <SDL.h>
+#include <SDL_opengl.h>
+
+#include "glsl_shader.h"
+
+// Quads per draw call (indices are 16-bit, 4 vertices per quad)
+#define GL_BATCH_MAX_QUADS 16384
+
+// Interleaved vertex as uploaded (24 bytes)
+typedef struct {
+	float x, y, z;
+	float u, v;
+	Uint8 r, g, b, a;
+} GLBatchVertex;
+
+typedef struct {
+	Uint64 quads;    // Quads (and triangles) submitted
+	Uint64 draws;    // glDrawElements calls
+	Uint64 orphans;  // Vertex buffer reallocations to avoid waiting on GPU
+} GLBatchStats;
+
+/**
+ * Create streaming vertex buffer and static index buffer for batched drawing
+ *
+ * Vertices are uploaded into an unsynchronized mapped range of a buffer
+ * that is orphaned when full (GL_ARB_map_buffer_range), otherwise by
+ * orphaning and glBufferSubData each flush. Without vertex buffer objects
+ * client-side arrays are drawn instead; either way each flush is one
+ * glDrawElements call.
+ *
+ * \param max_quads Quads buffered before an automatic flush (1 to GL_BATCH_MAX_QUADS)
+ * \returns true on success or false on failure; call SDL_GetError() for more information.
+ *
+ * \sa glBatchQuit
+ */
+extern bool glBatchInit(int max_quads);
+
+/**
+ * Bind texture for following quads, flushing pending quads if it changed
+ *
+ * \param texture Texture name or 0
+ */
+extern void glBatchTexture(GLuint texture);
+
+/**
+ * Use shader for following quads, flushing pending quads if the bound program changes
+ *
+ * \param shader Shader to draw with or NULL for fixed-function
+ *
+ * \sa glslShaderDraw
+ */
+extern void glBatchShader(Shader* shader);
+
+/**
+ * Queue quad (drawn as triangles 0-1-2 and 2-3-0)
+ *
+ * \param vertices 4 vertices in winding order
+ */
+extern void glBatchQuad(const GLBatchVertex* vertices);
+
+/**
+ * Queue triangle (takes up one quad slot)
+ *
+ * \param vertices 3 vertices in winding order
+ */
+extern void glBatchTriangle(const GLBatchVertex* vertices);
+
+/**
+ * Queue axis aligned textured rectangle on the z = 0 plane
+ *
+ * \param x Left edge
+ * \param y Top edge
+ * \param w Width
+ * \param h Height (rectangle spans y to y - h, matching drawQuad())
+ * \param u0 Left texture coordinate
+ * \param v0 Top texture coordinate
+ * \param u1 Right texture coordinate
+ * \param v1 Bottom texture coordinate
+ * \param color Vertex color (modulates texture)
+ */
+extern void glBatchSprite(float x, float y, float w, float h, float u0, float v0, float u1, float v1, SDL_Color color);
+
+/**
+ * Draw pending quads with current GL state (matrices, blending, etc.)
+ *
+ * Call before changing GL state outside of glBatch* functions and at end of frame.
+ */
+extern void glBatchFlush();
+
+/**
+ * Get counts of batched quads, draw calls and buffer orphans
+ *
+ * \sa glBatchResetStats
+ */
+extern GLBatchStats glBatchGetStats();
+
+extern void glBatchResetStats();
+
+/**
+ * Free batch buffers
+ *
+ * \sa glBatchInit
+ */
+extern void glBatchQuit();
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,395 @@
+#include "gl_capture.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "glsl_ext.h"
+
+#define CAPTURE_SLOT_FREE 0
+#define CAPTURE_SLOT_READING 1  // Read queued on GPU
+#define CAPTURE_SLOT_ENCODING 2 // Mapped, owned by workers
+#define CAPTURE_SLOT_ENCODED 3  // Waiting for render thread to unmap
+
+#define CAPTURE_PATH_SIZE 1000
+#define CAPTURE_FENCE_TIMEOUT_NS 1000000000
+
+typedef struct {
+	GLuint buffer;       // 0 if pixel buffers are unsupported
+	GLsync fence;        // NULL without sync objects
+	Uint8* memory;       // Read target without pixel buffers
+	const Uint8* pixels; // Bottom-up rows while encoding
+	Uint64 frame;
+	int state;
+} CaptureSlot;
+
+SDL_mutex* CAPTURE_LOCK = NULL;
+SDL_cond* CAPTURE_WAKE = NULL; // Slot queued for workers (or quitting)
+SDL_cond* CAPTURE_DONE = NULL; // Slot encoded
+SDL_Thread* CAPTURE_WORKERS[CAPTURE_MAX_WORKERS];
+int CAPTURE_WORKER_COUNT = 0;
+bool CAPTURE_QUIT = false;
+
+CaptureSlot CAPTURE_SLOTS[CAPTURE_MAX_BUFFERS];
+int CAPTURE_SLOT_COUNT = 0;
+int CAPTURE_SLOT_NEXT = 0;
+int CAPTURE_QUEUE[CAPTURE_MAX_BUFFERS]; // Slots waiting for workers, FIFO
+int CAPTURE_QUEUE_HEAD = 0;
+int CAPTURE_QUEUE_COUNT = 0;
+
+bool CAPTURE_PBO_SUPPORTED = false;
+bool CAPTURE_SYNC_SUPPORTED = false;
+int CAPTURE_WIDTH = 0;
+int CAPTURE_HEIGHT = 0;
+int CAPTURE_FORMAT = CAPTURE_FORMAT_BMP;
+char CAPTURE_PATH[CAPTURE_PATH_SIZE];
+FILE* CAPTURE_STREAM = NULL;
+Uint64 CAPTURE_FRAME = 0;
+CaptureStats CAPTURE_STATS;
+
+/*
+ * Encoding (worker threads)
+ */
+static bool encodeCaptureBMP(const CaptureSlot* slot, SDL_Surface* surface) {
+	char filename[CAPTURE_PATH_SIZE];
+	const Uint8* source;
+	Uint8* destination;
+	int x, y;
+
+	// GL rows are bottom-up and BGRA; SDL's writer expects top-down and saves 24-bit BGR as is
+	for (y = 0; y < CAPTURE_HEIGHT; y++) {
+		source = slot->pixels + (size_t)CAPTURE_WIDTH * 4 * (CAPTURE_HEIGHT - 1 - y);
+		destination = (Uint8*)surface->pixels + (size_t)surface->pitch * y;
+		for (x = 0; x < CAPTURE_WIDTH; x++, source += 4, destination += 3) {
+			destination[0] = source[0];
+			destination[1] = source[1];
+			destination[2] = source[2];
+		}
+	}
+
+	snprintf(filename, CAPTURE_PATH_SIZE, CAPTURE_PATH, (int)slot->frame);
+	if (SDL_SaveBMP(surface, filename) != 0) {
+		printf("[WARN] Failed to write capture \"%s\": %s\n", filename, SDL_GetError());
+		return false;
+	}
+	return true;
+}
+
+static bool encodeCaptureRaw(const CaptureSlot* slot) {
+	size_t row = (size_t)CAPTURE_WIDTH * 4;
+	int y;
+
+	for (y = CAPTURE_HEIGHT - 1; y >= 0; y--) {
+		if (fwrite(slot->pixels + row * y, 1, row, CAPTURE_STREAM) != row) {
+			printf("[WARN] Failed to write capture frame %llu to \"%s\"\n", (unsigned long long)slot->frame, CAPTURE_PATH);
+			return false;
+		}
+	}
+	return true;
+}
+
+int captureWorker(void* data) {
+	SDL_Surface* surface = NULL;
+	CaptureSlot* slot;
+	bool encoded;
+
+	(void)data;
+
+	// Reused every frame; BMP layout so SDL_SaveBMP() writes without converting
+	if (CAPTURE_FORMAT == CAPTURE_FORMAT_BMP) {
+		surface = SDL_CreateRGBSurfaceWithFormat(0, CAPTURE_WIDTH, CAPTURE_HEIGHT, 24, SDL_PIXELFORMAT_BGR24);
+		if (surface == NULL) printf("[WARN] Capture worker has no surface: %s\n", SDL_GetError());
+	}
+
+	while (true) {
+		// Wait for mapped slot; queue is drained before quitting
+		SDL_LockMutex(CAPTURE_LOCK);
+		while (CAPTURE_QUEUE_COUNT == 0 && !CAPTURE_QUIT) SDL_CondWait(CAPTURE_WAKE, CAPTURE_LOCK);
+		if (CAPTURE_QUEUE_COUNT == 0) {
+			SDL_UnlockMutex(CAPTURE_LOCK);
+			break;
+		}
+		slot = &CAPTURE_SLOTS[CAPTURE_QUEUE[CAPTURE_QUEUE_HEAD]];
+		CAPTURE_QUEUE_HEAD = (CAPTURE_QUEUE_HEAD + 1) % CAPTURE_MAX_BUFFERS;
+		CAPTURE_QUEUE_COUNT--;
+		SDL_UnlockMutex(CAPTURE_LOCK);
+
+		if (slot->pixels == NULL) encoded = false;
+		else if (CAPTURE_FORMAT == CAPTURE_FORMAT_RAW) encoded = encodeCaptureRaw(slot);
+		else encoded = surface != NULL && encodeCaptureBMP(slot, surface);
+
+		SDL_LockMutex(CAPTURE_LOCK);
+		slot->state = CAPTURE_SLOT_ENCODED;
+		if (encoded) CAPTURE_STATS.written++;
+		else CAPTURE_STATS.failed++;
+		SDL_CondSignal(CAPTURE_DONE);
+		SDL_UnlockMutex(CAPTURE_LOCK);
+	}
+
+	if (surface) SDL_FreeSurface(surface);
+	return 0;
+}
+
+/*
+ * Slots (render thread)
+ */
+static int getCaptureSlotState(int index) {
+	int state;
+
+	SDL_LockMutex(CAPTURE_LOCK);
+	state = CAPTURE_SLOTS[index].state;
+	SDL_UnlockMutex(CAPTURE_LOCK);
+
+	return state;
+}
+
+static void queueCaptureSlot(int index) {
+	SDL_LockMutex(CAPTURE_LOCK);
+	CAPTURE_SLOTS[index].state = CAPTURE_SLOT_ENCODING;
+	CAPTURE_QUEUE[(CAPTURE_QUEUE_HEAD + CAPTURE_QUEUE_COUNT) % CAPTURE_MAX_BUFFERS] = index;
+	CAPTURE_QUEUE_COUNT++;
+	SDL_CondSignal(CAPTURE_WAKE);
+	SDL_UnlockMutex(CAPTURE_LOCK);
+}
+
+// Map finished read and hand to workers; false if GPU has not finished (only when not waiting)
+static bool mapCaptureSlot(int index, bool wait) {
+	CaptureSlot* slot = &CAPTURE_SLOTS[index];
+	GLenum status;
+
+	if (slot->fence) {
+		do {
+			status = glClientWaitSync(slot->fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? CAPTURE_FENCE_TIMEOUT_NS : 0);
+		} while (wait && status == GL_TIMEOUT_EXPIRED);
+		if (status == GL_TIMEOUT_EXPIRED) return false;
+		glDeleteSync(slot->fence);
+		slot->fence = NULL;
+	} else if (!wait && CAPTURE_FRAME - slot->frame < (Uint64)CAPTURE_SLOT_COUNT - 1) {
+		// No fences; leave as long as the ring allows so mapping is unlikely to block
+		return false;
+	}
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->buffer);
+	slot->pixels = (const Uint8*)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	if (slot->pixels == NULL) printf("[WARN] Failed to map capture buffer for frame %llu\n", (unsigned long long)slot->frame);
+
+	queueCaptureSlot(index);
+	return true;
+}
+
+static void unmapCaptureSlot(int index) {
+	CaptureSlot* slot = &CAPTURE_SLOTS[index];
+
+	if (slot->buffer && slot->pixels) {
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->buffer);
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	}
+	slot->pixels = NULL;
+	slot->state = CAPTURE_SLOT_FREE;
+}
+
+// Advance slots oldest first; reads complete in order so stop at first unfinished
+static void updateCaptureSlots() {
+	int i, index;
+	int state;
+	bool reading = true;
+
+	for (i = 0; i < CAPTURE_SLOT_COUNT; i++) {
+		index = (CAPTURE_SLOT_NEXT + i) % CAPTURE_SLOT_COUNT;
+		state = getCaptureSlotState(index);
+
+		if (state == CAPTURE_SLOT_READING && reading) reading = mapCaptureSlot(index, false);
+		else if (state == CAPTURE_SLOT_ENCODED) unmapCaptureSlot(index);
+	}
+}
+
+// Block until slot is free (ring full)
+static void waitCaptureSlot(int index) {
+	CaptureSlot* slot = &CAPTURE_SLOTS[index];
+
+	if (getCaptureSlotState(index) == CAPTURE_SLOT_READING) mapCaptureSlot(index, true);
+
+	SDL_LockMutex(CAPTURE_LOCK);
+	while (slot->state == CAPTURE_SLOT_ENCODING) SDL_CondWait(CAPTURE_DONE, CAPTURE_LOCK);
+	SDL_UnlockMutex(CAPTURE_LOCK);
+
+	if (getCaptureSlotState(index) == CAPTURE_SLOT_ENCODED) unmapCaptureSlot(index);
+}
+
+/*
+ * Public API
+ */
+bool initCapture(int width, int height, int num_buffers, int num_workers, int format, const char* path) {
+	size_t size = (size_t)width * height * 4;
+	int i;
+
+	if (CAPTURE_LOCK) {
+		SDL_SetError("Failed to start capture: already capturing");
+		return false;
+	}
+	if (width <= 0 || height <= 0) {
+		SDL_SetError("Invalid capture size: %dx%d", width, height);
+		return false;
+	}
+	if (format != CAPTURE_FORMAT_BMP && format != CAPTURE_FORMAT_RAW) {
+		SDL_SetError("Unknown capture format: %d", format);
+		return false;
+	}
+	if (strlen(path) >= CAPTURE_PATH_SIZE) {
+		SDL_SetError("Capture path too long: %s", path);
+		return false;
+	}
+
+	if (num_buffers < 2) num_buffers = 2;
+	if (num_buffers > CAPTURE_MAX_BUFFERS) num_buffers = CAPTURE_MAX_BUFFERS;
+	if (num_workers <= 0) num_workers = SDL_GetCPUCount() - 1;
+	if (num_workers < 1) num_workers = 1;
+	if (num_workers > CAPTURE_MAX_WORKERS) num_workers = CAPTURE_MAX_WORKERS;
+	// Stream frames must be written in order
+	if (format == CAPTURE_FORMAT_RAW) num_workers = 1;
+
+	CAPTURE_WIDTH = width;
+	CAPTURE_HEIGHT = height;
+	CAPTURE_FORMAT = format;
+	strcpy(CAPTURE_PATH, path);
+	CAPTURE_FRAME = 0;
+	CAPTURE_QUIT = false;
+	CAPTURE_QUEUE_HEAD = CAPTURE_QUEUE_COUNT = 0;
+	CAPTURE_SLOT_NEXT = 0;
+	memset(&CAPTURE_STATS, 0, sizeof(CaptureStats));
+	memset(CAPTURE_SLOTS, 0, sizeof(CAPTURE_SLOTS));
+
+	if (format == CAPTURE_FORMAT_RAW) {
+		CAPTURE_STREAM = fopen(path, "wb");
+		if (CAPTURE_STREAM == NULL) {
+			SDL_SetError("Failed to open capture stream: %s", path);
+			return false;
+		}
+	}
+
+	CAPTURE_LOCK = SDL_CreateMutex();
+	CAPTURE_WAKE = SDL_CreateCond();
+	CAPTURE_DONE = SDL_CreateCond();
+	if (!CAPTURE_LOCK || !CAPTURE_WAKE || !CAPTURE_DONE) {
+		SDL_SetError("Failed to create capture lock | SDL error: %s", SDL_GetError());
+		quitCapture();
+		return false;
+	}
+
+	// Pixel buffers make glReadPixels return immediately; fences tell when they can be mapped
+	CAPTURE_PBO_SUPPORTED = createPixelBufferFunctions();
+	CAPTURE_SYNC_SUPPORTED = CAPTURE_PBO_SUPPORTED && createSyncFunctions();
+	if (!CAPTURE_PBO_SUPPORTED) printf("[WARN] GL_ARB_pixel_buffer_object unsupported, capture reads will stall\n");
+
+	CAPTURE_SLOT_COUNT = num_buffers;
+	for (i = 0; i < CAPTURE_SLOT_COUNT; i++) {
+		if (CAPTURE_PBO_SUPPORTED) {
+			glGenBuffers(1, &CAPTURE_SLOTS[i].buffer);
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, CAPTURE_SLOTS[i].buffer);
+			glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		} else {
+			CAPTURE_SLOTS[i].memory = (Uint8*)malloc(size);
+			if (CAPTURE_SLOTS[i].memory == NULL) {
+				SDL_SetError("Failed to allocate capture buffer of %dx%d", width, height);
+				quitCapture();
+				return false;
+			}
+		}
+	}
+
+	for (i = 0; i < num_workers; i++) {
+		CAPTURE_WORKERS[i] = SDL_CreateThread(captureWorker, "CaptureEncoder", NULL);
+		if (!CAPTURE_WORKERS[i]) {
+			SDL_SetError("Failed to create capture worker | SDL error: %s", SDL_GetError());
+			quitCapture();
+			return false;
+		}
+		CAPTURE_WORKER_COUNT++;
+	}
+
+	return true;
+}
+
+Uint64 captureFrame() {
+	CaptureSlot* slot;
+	int index;
+
+	if (!CAPTURE_LOCK) return 0;
+
+	updateCaptureSlots();
+
+	index = CAPTURE_SLOT_NEXT;
+	slot = &CAPTURE_SLOTS[index];
+	if (getCaptureSlotState(index) != CAPTURE_SLOT_FREE) {
+		CAPTURE_STATS.stalls++;
+		waitCaptureSlot(index);
+	}
+	CAPTURE_SLOT_NEXT = (CAPTURE_SLOT_NEXT + 1) % CAPTURE_SLOT_COUNT;
+	slot->frame = CAPTURE_FRAME++;
+	CAPTURE_STATS.frames++;
+
+	// BGRA is the native readback layout on most drivers (no conversion); bytes B, G, R, A in memory
+	if (CAPTURE_PBO_SUPPORTED) {
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->buffer);
+		glReadPixels(0, 0, CAPTURE_WIDTH, CAPTURE_HEIGHT, GL_BGRA, GL_UNSIGNED_BYTE, (void*)0);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		if (CAPTURE_SYNC_SUPPORTED) slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		slot->state = CAPTURE_SLOT_READING;
+	} else {
+		glReadPixels(0, 0, CAPTURE_WIDTH, CAPTURE_HEIGHT, GL_BGRA, GL_UNSIGNED_BYTE, slot->memory);
+		slot->pixels = slot->memory;
+		queueCaptureSlot(index);
+	}
+
+	return slot->frame;
+}
+
+CaptureStats getCaptureStats() {
+	CaptureStats stats;
+
+	if (CAPTURE_LOCK) SDL_LockMutex(CAPTURE_LOCK);
+	stats = CAPTURE_STATS;
+	if (CAPTURE_LOCK) SDL_UnlockMutex(CAPTURE_LOCK);
+
+	return stats;
+}
+
+void quitCapture() {
+	int i, index;
+
+	// Flush every outstanding frame, oldest first
+	if (CAPTURE_WORKER_COUNT > 0) {
+		for (i = 0; i < CAPTURE_SLOT_COUNT; i++) {
+			index = (CAPTURE_SLOT_NEXT + i) % CAPTURE_SLOT_COUNT;
+			if (getCaptureSlotState(index) != CAPTURE_SLOT_FREE) waitCaptureSlot(index);
+		}
+	}
+
+	if (CAPTURE_LOCK) {
+		SDL_LockMutex(CAPTURE_LOCK);
+		CAPTURE_QUIT = true;
+		SDL_CondBroadcast(CAPTURE_WAKE);
+		SDL_UnlockMutex(CAPTURE_LOCK);
+	}
+	for (i = 0; i < CAPTURE_WORKER_COUNT; i++) SDL_WaitThread(CAPTURE_WORKERS[i], NULL);
+	CAPTURE_WORKER_COUNT = 0;
+
+	for (i = 0; i < CAPTURE_SLOT_COUNT; i++) {
+		if (CAPTURE_SLOTS[i].fence) glDeleteSync(CAPTURE_SLOTS[i].fence);
+		if (CAPTURE_SLOTS[i].buffer) glDeleteBuffers(1, &CAPTURE_SLOTS[i].buffer);
+		free(CAPTURE_SLOTS[i].memory);
+	}
+	memset(CAPTURE_SLOTS, 0, sizeof(CAPTURE_SLOTS));
+	CAPTURE_SLOT_COUNT = 0;
+
+	if (CAPTURE_STREAM) fclose(CAPTURE_STREAM);
+	CAPTURE_STREAM = NULL;
+	if (CAPTURE_DONE) SDL_DestroyCond(CAPTURE_DONE);
+	if (CAPTURE_WAKE) SDL_DestroyCond(CAPTURE_WAKE);
+	if (CAPTURE_LOCK) SDL_DestroyMutex(CAPTURE_LOCK);
+	CAPTURE_DONE = CAPTURE_WAKE = NULL;
+	CAPTURE_LOCK = NULL;
+}
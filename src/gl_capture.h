@@ -0,0 +1,65 @@
+#pragma once
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include <stdbool.h>
+
+#include <SDL.h>
+#include <SDL_opengl.h>
+
+#define CAPTURE_MAX_BUFFERS 16
+#define CAPTURE_MAX_WORKERS 8
+
+// Capture output formats for initCapture()
+#define CAPTURE_FORMAT_BMP 0 // One BMP per frame, path is a printf pattern taking frame number (eg: "frame_%05d.bmp")
+#define CAPTURE_FORMAT_RAW 1 // Top-down 32-bit BGRA frames appended to one file (eg: ffmpeg -f rawvideo -pix_fmt bgra)
+
+typedef struct {
+	Uint64 frames;  // Frames queued by captureFrame()
+	Uint64 written; // Frames encoded to disk
+	Uint64 failed;  // Frames that failed to encode or write
+	Uint64 stalls;  // captureFrame() calls that waited on GPU or workers (all buffers busy)
+} CaptureStats;
+
+/**
+ * Start capturing frames with pixel buffer ring and encoder threads
+ *
+ * Reads are queued into pixel pack buffers and mapped once a fence signals
+ * (several frames later), then encoded from the mapped memory by workers,
+ * so the render thread never waits on the GPU or disk while a buffer is free.
+ * Falls back to synchronous reads if pixel buffer objects are unsupported.
+ *
+ * \param width Width of region read from (0, 0) of current read framebuffer
+ * \param height Height of region read
+ * \param num_buffers Pixel buffers in ring (frames in flight), 2 to CAPTURE_MAX_BUFFERS
+ * \param num_workers Encoder threads (0 or less for CPU count - 1); CAPTURE_FORMAT_RAW always uses one
+ * \param format CAPTURE_FORMAT_*
+ * \param path Output path (see CAPTURE_FORMAT_*)
+ * \returns true on success or false on failure; call SDL_GetError() for more information.
+ *
+ * \sa captureFrame
+ * \sa quitCapture
+ */
+extern bool initCapture(int width, int height, int num_buffers, int num_workers, int format, const char* path);
+
+/**
+ * Queue capture of current frame
+ *
+ * Call after drawing and before drawGLEnd() (back buffer is undefined after swapping).
+ * Also hands finished reads to workers and recycles encoded buffers.
+ *
+ * \returns Frame number captured
+ */
+extern Uint64 captureFrame();
+
+extern CaptureStats getCaptureStats();
+
+/**
+ * Finish all queued frames, then stop workers and free buffers
+ */
+extern void quitCapture();
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,293 @@
+#include "gl_instance.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gl_math.h"
+#include "gl_state.h"
+#include "glsl_ext.h"
+
+bool INSTANCING_SUPPORTED = false;
+bool INSTANCE_MESH_SUPPORTED = false;
+bool INSTANCE_ATTRIB_SUPPORTED = false;
+
+typedef struct {
+	GLint matrix;
+	GLint color;
+	GLint layer;
+} InstanceLocations;
+
+// Attribute locations of a drawn program (keyed by Shader too, so a recycled program name never matches)
+typedef struct {
+	const Shader* shader;
+	GLhandleARB program;
+	InstanceLocations locations;
+} InstanceLocationEntry;
+
+InstanceLocationEntry INSTANCE_LOCATION_CACHE[INSTANCE_LOCATION_CACHE_SIZE];
+int INSTANCE_LOCATION_NEXT = 0;
+
+/*
+ * Drawing
+ */
+static void getInstanceLocations(const Shader* shader, GLhandleARB program, InstanceLocations* locations) {
+	int i;
+	InstanceLocationEntry* entry;
+
+	locations->matrix = locations->color = locations->layer = -1;
+	if (!program || !INSTANCE_ATTRIB_SUPPORTED) return;
+
+	for (i = 0; i < INSTANCE_LOCATION_CACHE_SIZE; i++) {
+		entry = &INSTANCE_LOCATION_CACHE[i];
+		if (entry->program == program && entry->shader == shader) {
+			*locations = entry->locations;
+			return;
+		}
+	}
+
+	// First draw with program; replace oldest entry
+	locations->matrix = glGetAttribLocation(program, INSTANCE_ATTRIB_MATRIX);
+	locations->color = glGetAttribLocation(program, INSTANCE_ATTRIB_COLOR);
+	locations->layer = glGetAttribLocation(program, INSTANCE_ATTRIB_LAYER);
+	entry = &INSTANCE_LOCATION_CACHE[INSTANCE_LOCATION_NEXT];
+	entry->shader = shader;
+	entry->program = program;
+	entry->locations = *locations;
+	INSTANCE_LOCATION_NEXT = (INSTANCE_LOCATION_NEXT + 1) % INSTANCE_LOCATION_CACHE_SIZE;
+}
+
+static void bindInstanceMesh(const InstanceMesh* mesh) {
+	glBindBuffer(GL_ARRAY_BUFFER, mesh->vertex_buffer);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(3, GL_FLOAT, sizeof(GLBatchVertex), (const void*)offsetof(GLBatchVertex, x));
+	glTexCoordPointer(2, GL_FLOAT, sizeof(GLBatchVertex), (const void*)offsetof(GLBatchVertex, u));
+	glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(GLBatchVertex), (const void*)offsetof(GLBatchVertex, r));
+	if (mesh->index_buffer) glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->index_buffer);
+}
+
+static void unbindInstanceMesh(const InstanceMesh* mesh) {
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	if (mesh->index_buffer) glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+static void drawInstanceMesh(const InstanceMesh* mesh) {
+	if (mesh->index_buffer) glDrawElements(mesh->mode, mesh->num_indices, GL_UNSIGNED_SHORT, NULL);
+	else glDrawArrays(mesh->mode, 0, mesh->num_vertices);
+}
+
+// Point instance attributes at buffer, advancing once per instance
+static void enableInstanceAttributes(const InstanceLocations* locations, GLuint buffer) {
+	int c;
+
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	for (c = 0; c < 4; c++) {
+		glEnableVertexAttribArray(locations->matrix + c);
+		glVertexAttribPointer(locations->matrix + c, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceAttributes),
+			(const void*)(offsetof(InstanceAttributes, matrix) + sizeof(float) * 4 * c));
+		glVertexAttribDivisor(locations->matrix + c, 1);
+	}
+	if (locations->color >= 0) {
+		glEnableVertexAttribArray(locations->color);
+		glVertexAttribPointer(locations->color, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceAttributes), (const void*)offsetof(InstanceAttributes, color));
+		glVertexAttribDivisor(locations->color, 1);
+	}
+	if (locations->layer >= 0) {
+		glEnableVertexAttribArray(locations->layer);
+		glVertexAttribPointer(locations->layer, 1, GL_FLOAT, GL_FALSE, sizeof(InstanceAttributes), (const void*)offsetof(InstanceAttributes, layer));
+		glVertexAttribDivisor(locations->layer, 1);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Divisors are global state; reset so later non-instanced draws are unaffected
+static void disableInstanceAttributes(const InstanceLocations* locations) {
+	int c;
+
+	for (c = 0; c < 4; c++) {
+		glVertexAttribDivisor(locations->matrix + c, 0);
+		glDisableVertexAttribArray(locations->matrix + c);
+	}
+	if (locations->color >= 0) {
+		glVertexAttribDivisor(locations->color, 0);
+		glDisableVertexAttribArray(locations->color);
+	}
+	if (locations->layer >= 0) {
+		glVertexAttribDivisor(locations->layer, 0);
+		glDisableVertexAttribArray(locations->layer);
+	}
+}
+
+/*
+ * Public API
+ */
+bool initInstancing() {
+	INSTANCE_MESH_SUPPORTED = createVertexBufferFunctions();
+	INSTANCE_ATTRIB_SUPPORTED = SDL_GLSL_SUPPORTED && createVertexAttribFunctions();
+	INSTANCING_SUPPORTED = INSTANCE_MESH_SUPPORTED && INSTANCE_ATTRIB_SUPPORTED && createInstancedArrayFunctions();
+
+	if (!INSTANCE_MESH_SUPPORTED) {
+		SDL_SetError("Instancing unsupported: requires vertex buffer objects");
+		return false;
+	}
+	return true;
+}
+
+InstanceMesh* createInstanceMesh(GLenum mode, const GLBatchVertex* vertices, int num_vertices, const GLushort* indices, int num_indices) {
+	InstanceMesh* mesh;
+
+	if (!INSTANCE_MESH_SUPPORTED) {
+		SDL_SetError("Failed to create instance mesh: instancing not initialized or unsupported");
+		return NULL;
+	}
+
+	mesh = (InstanceMesh*)calloc(1, sizeof(InstanceMesh));
+	if (mesh == NULL) {
+		SDL_SetError("Failed to allocate instance mesh");
+		return NULL;
+	}
+	mesh->mode = mode;
+	mesh->num_vertices = num_vertices;
+
+	glGenBuffers(1, &mesh->vertex_buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, mesh->vertex_buffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(GLBatchVertex) * num_vertices, vertices, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	if (indices != NULL) {
+		mesh->num_indices = num_indices;
+		glGenBuffers(1, &mesh->index_buffer);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->index_buffer);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLushort) * num_indices, indices, GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+
+	return mesh;
+}
+
+void freeInstanceMesh(InstanceMesh* mesh) {
+	if (mesh == NULL) return;
+
+	glDeleteBuffers(1, &mesh->vertex_buffer);
+	if (mesh->index_buffer) glDeleteBuffers(1, &mesh->index_buffer);
+	free(mesh);
+}
+
+InstanceBuffer* createInstanceBuffer(int capacity) {
+	InstanceBuffer* instances;
+
+	if (capacity <= 0) {
+		SDL_SetError("Invalid instance buffer capacity: %d", capacity);
+		return NULL;
+	}
+
+	instances = (InstanceBuffer*)calloc(1, sizeof(InstanceBuffer));
+	if (instances == NULL) {
+		SDL_SetError("Failed to allocate instance buffer");
+		return NULL;
+	}
+	instances->capacity = capacity;
+
+	// Fallback draws read attributes on CPU, otherwise they only live in GL
+	instances->attributes = (InstanceAttributes*)malloc(sizeof(InstanceAttributes) * capacity);
+	if (instances->attributes == NULL) {
+		free(instances);
+		SDL_SetError("Failed to allocate instance buffer for %d instances", capacity);
+		return NULL;
+	}
+	if (INSTANCING_SUPPORTED) {
+		glGenBuffers(1, &instances->buffer);
+		glBindBuffer(GL_ARRAY_BUFFER, instances->buffer);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(InstanceAttributes) * capacity, NULL, GL_STREAM_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	return instances;
+}
+
+bool updateInstanceBuffer(InstanceBuffer* instances, const InstanceAttributes* attributes, int count) {
+	if (count < 0 || count > instances->capacity) {
+		SDL_SetError("Instance count %d exceeds instance buffer capacity %d", count, instances->capacity);
+		return false;
+	}
+
+	memcpy(instances->attributes, attributes, sizeof(InstanceAttributes) * count);
+	instances->count = count;
+	if (instances->buffer && count > 0) {
+		glBindBuffer(GL_ARRAY_BUFFER, instances->buffer);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(InstanceAttributes) * instances->capacity, NULL, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(InstanceAttributes) * count, attributes);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	return true;
+}
+
+void drawInstances(Shader* shader, const InstanceMesh* mesh, const InstanceBuffer* instances) {
+	const InstanceAttributes* instance;
+	InstanceLocations locations;
+	GLhandleARB program;
+	GLhandleARB previous;
+	float layer[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+	int i, c;
+
+	if (instances->count == 0) return;
+
+	// Program used by following draws (eg: a batch) is restored afterwards
+	previous = glStateGetProgram();
+	if (SDL_GLSL_SUPPORTED && SDL_GLSL_READY && shader != NULL) shader = getShaderVariant(shader, shader->features);
+	glslShaderDraw(shader, shader != NULL);
+	program = glStateGetProgram();
+	getInstanceLocations(shader, program, &locations);
+
+	bindInstanceMesh(mesh);
+	if (locations.matrix >= 0 && INSTANCING_SUPPORTED) {
+		// Single draw; attributes advance per instance instead of per vertex
+		enableInstanceAttributes(&locations, instances->buffer);
+		if (mesh->index_buffer) glDrawElementsInstanced(mesh->mode, mesh->num_indices, GL_UNSIGNED_SHORT, NULL, instances->count);
+		else glDrawArraysInstanced(mesh->mode, 0, mesh->num_vertices, instances->count);
+		disableInstanceAttributes(&locations);
+	} else if (locations.matrix >= 0) {
+		// Same shader, attributes set as constants between draws
+		for (i = 0; i < instances->count; i++) {
+			instance = &instances->attributes[i];
+			for (c = 0; c < 4; c++) glVertexAttrib4fv(locations.matrix + c, &instance->matrix[c * 4]);
+			if (locations.color >= 0) glVertexAttrib4fv(locations.color, instance->color);
+			if (locations.layer >= 0) {
+				layer[0] = instance->layer;
+				glVertexAttrib4fv(locations.layer, layer);
+			}
+			drawInstanceMesh(mesh);
+		}
+	} else {
+		// Shader without instance attributes or fixed-function
+		for (i = 0; i < instances->count; i++) {
+			glPushMatrix();
+			glMultMatrixf(instances->attributes[i].matrix);
+			drawInstanceMesh(mesh);
+			glPopMatrix();
+		}
+	}
+	unbindInstanceMesh(mesh);
+	glStateUseProgram(previous);
+}
+
+void freeInstanceBuffer(InstanceBuffer* instances) {
+	if (instances == NULL) return;
+
+	if (instances->buffer) glDeleteBuffers(1, &instances->buffer);
+	free(instances->attributes);
+	free(instances);
+}
+
+void setInstanceTransform(InstanceAttributes* instance, float x, float y, float z, float angle, float ax, float ay, float az, float scale) {
+	mat4Identity(instance->matrix);
+	mat4Translate(instance->matrix, x, y, z);
+	mat4Rotate(instance->matrix, angle, ax, ay, az);
+	mat4Scale(instance->matrix, scale, scale, scale);
+}
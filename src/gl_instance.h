@@ -0,0 +1,128 @@
+#pragma once
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include <stdbool.h>
+
+#include <SDL.h>
+#include <SDL_opengl.h>
+
+#include "gl_batch.h"
+#include "glsl_shader.h"
+
+// Vertex shader attribute names read per instance (see common_instanced.vert)
+#define INSTANCE_ATTRIB_MATRIX "a_instance_matrix"
+#define INSTANCE_ATTRIB_COLOR  "a_instance_color"
+#define INSTANCE_ATTRIB_LAYER  "a_instance_layer"
+#define INSTANCE_LOCATION_CACHE_SIZE 16 // Programs whose attribute locations are kept
+
+extern bool INSTANCING_SUPPORTED;
+
+// Per-instance data as uploaded (96 bytes)
+typedef struct {
+	float matrix[16]; // Column-major model matrix, applied before modelview
+	float color[4];   // Multiplies vertex color
+	float layer;      // Texture layer (eg: array texture slice), passed to fragment stage
+	float padding[3];
+} InstanceAttributes;
+
+typedef struct {
+	GLenum mode;
+	GLuint vertex_buffer;
+	GLuint index_buffer; // 0 if drawn without indices
+	int num_vertices;
+	int num_indices;
+} InstanceMesh;
+
+typedef struct {
+	GLuint buffer;
+	InstanceAttributes* attributes; // CPU copy when instancing is unsupported
+	int capacity;
+	int count;
+} InstanceBuffer;
+
+/**
+ * Load vertex buffer, attribute and instancing functions
+ *
+ * Sets INSTANCING_SUPPORTED when glVertexAttribDivisor and instanced draws
+ * are available. Without them drawInstances() still works by drawing once
+ * per instance with constant attributes.
+ *
+ * \returns true if meshes can be created (vertex buffer objects supported)
+ *          or false on failure; call SDL_GetError() for more information.
+ */
+extern bool initInstancing();
+
+/**
+ * Upload mesh drawn by drawInstances()
+ *
+ * \param mode Primitive mode (eg: GL_TRIANGLES)
+ * \param vertices Vertices (position, UV and color as gl_Vertex, gl_MultiTexCoord0 and gl_Color)
+ * \param num_vertices Number of vertices
+ * \param indices Indices into vertices or NULL to draw vertices in order
+ * \param num_indices Number of indices (ignored if indices is NULL)
+ * \returns InstanceMesh or NULL on failure; call SDL_GetError() for more information.
+ *
+ * \warning User must free returned mesh with freeInstanceMesh()
+ */
+extern InstanceMesh* createInstanceMesh(GLenum mode, const GLBatchVertex* vertices, int num_vertices, const GLushort* indices, int num_indices);
+
+extern void freeInstanceMesh(InstanceMesh* mesh);
+
+/**
+ * Create buffer of per-instance attributes
+ *
+ * \param capacity Maximum instances per update
+ * \returns InstanceBuffer or NULL on failure; call SDL_GetError() for more information.
+ *
+ * \warning User must free returned buffer with freeInstanceBuffer()
+ */
+extern InstanceBuffer* createInstanceBuffer(int capacity);
+
+/**
+ * Replace instance attributes (orphans previous contents, safe every frame)
+ *
+ * \param instances Buffer to update
+ * \param attributes Per-instance attributes
+ * \param count Number of instances (up to capacity)
+ * \returns true on success or false if count exceeds capacity
+ */
+extern bool updateInstanceBuffer(InstanceBuffer* instances, const InstanceAttributes* attributes, int count);
+
+/**
+ * Draw every instance of mesh in one call
+ *
+ * Shader should read INSTANCE_ATTRIB_* attributes (see common_instanced.vert).
+ * Shaders without them (or fixed-function when shader is NULL) are drawn
+ * once per instance with matrix multiplied onto modelview instead;
+ * instance color and layer are then ignored.
+ * Attribute locations are looked up once per program; the program in use
+ * before the call is restored after it.
+ *
+ * \param shader Shader to draw with (see glslShaderDraw()) or NULL
+ * \param mesh Mesh to draw
+ * \param instances Instances to draw
+ */
+extern void drawInstances(Shader* shader, const InstanceMesh* mesh, const InstanceBuffer* instances);
+
+extern void freeInstanceBuffer(InstanceBuffer* instances);
+
+/**
+ * Set instance matrix as glTranslatef(), glRotatef() then glScalef() would
+ *
+ * \param instance Instance to set matrix of
+ * \param x X position
+ * \param y Y position
+ * \param z Z position
+ * \param angle Rotation in degrees about axis
+ * \param ax Rotation axis X
+ * \param ay Rotation axis Y
+ * \param az Rotation axis Z
+ * \param scale Uniform scale
+ */
+extern void setInstanceTransform(InstanceAttributes* instance, float x, float y, float z, float angle, float ax, float ay, float az, float scale);
+
+#ifdef __cplusplus
+}
+#endif
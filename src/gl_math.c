@@ -0,0 +1,364 @@
+#include "gl_math.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "sdl_gl.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define GL_MATH_X86
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define GL_MATH_TARGET_AVX __attribute__((target("avx")))
+#else
+#define GL_MATH_TARGET_AVX
+#endif
+#endif
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define GL_MATH_SSE
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define GL_MATH_NEON
+#include <arm_neon.h>
+#endif
+
+#define GL_MATH_DEG_TO_RAD 0.017453292519943295
+
+/*
+ * Matrix multiply kernels
+ */
+#if defined(GL_MATH_SSE)
+static void mat4MultiplySSE(float* out, const __m128* a, const float* b) {
+	__m128 r0, r1, r2, r3;
+
+	// Column j of result is a's columns weighted by column j of b
+	r0 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], _mm_set1_ps(b[0])), _mm_mul_ps(a[1], _mm_set1_ps(b[1]))),
+		_mm_add_ps(_mm_mul_ps(a[2], _mm_set1_ps(b[2])), _mm_mul_ps(a[3], _mm_set1_ps(b[3]))));
+	r1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], _mm_set1_ps(b[4])), _mm_mul_ps(a[1], _mm_set1_ps(b[5]))),
+		_mm_add_ps(_mm_mul_ps(a[2], _mm_set1_ps(b[6])), _mm_mul_ps(a[3], _mm_set1_ps(b[7]))));
+	r2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], _mm_set1_ps(b[8])), _mm_mul_ps(a[1], _mm_set1_ps(b[9]))),
+		_mm_add_ps(_mm_mul_ps(a[2], _mm_set1_ps(b[10])), _mm_mul_ps(a[3], _mm_set1_ps(b[11]))));
+	r3 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], _mm_set1_ps(b[12])), _mm_mul_ps(a[1], _mm_set1_ps(b[13]))),
+		_mm_add_ps(_mm_mul_ps(a[2], _mm_set1_ps(b[14])), _mm_mul_ps(a[3], _mm_set1_ps(b[15]))));
+
+	// Store only after b is fully read so out may alias b
+	_mm_storeu_ps(out + 0, r0);
+	_mm_storeu_ps(out + 4, r1);
+	_mm_storeu_ps(out + 8, r2);
+	_mm_storeu_ps(out + 12, r3);
+}
+#elif defined(GL_MATH_NEON)
+static void mat4MultiplyNEON(float* out, const float32x4_t* a, const float* b) {
+	float32x4_t r[4];
+	int j;
+
+	for (j = 0; j < 4; j++) {
+		r[j] = vmulq_n_f32(a[0], b[j * 4 + 0]);
+		r[j] = vmlaq_n_f32(r[j], a[1], b[j * 4 + 1]);
+		r[j] = vmlaq_n_f32(r[j], a[2], b[j * 4 + 2]);
+		r[j] = vmlaq_n_f32(r[j], a[3], b[j * 4 + 3]);
+	}
+	for (j = 0; j < 4; j++) vst1q_f32(out + j * 4, r[j]);
+}
+#else
+static void mat4MultiplyScalar(float* out, const float* a, const float* b) {
+	float r[16];
+	int i, j;
+
+	for (j = 0; j < 4; j++) {
+		for (i = 0; i < 4; i++) {
+			r[j * 4 + i] = a[i] * b[j * 4] + a[4 + i] * b[j * 4 + 1] + a[8 + i] * b[j * 4 + 2] + a[12 + i] * b[j * 4 + 3];
+		}
+	}
+	memcpy(out, r, sizeof(r));
+}
+#endif
+
+#ifdef GL_MATH_X86
+// Two result columns per 256-bit op: a's columns duplicated in both lanes
+GL_MATH_TARGET_AVX static void mat4MultiplyBatchAVX(float* out, const float* a, const float* b, int count) {
+	__m256 a0, a1, a2, a3, b01, b23, r01, r23;
+	int i;
+
+	a0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(a + 0)), _mm_loadu_ps(a + 0), 1);
+	a1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(a + 4)), _mm_loadu_ps(a + 4), 1);
+	a2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(a + 8)), _mm_loadu_ps(a + 8), 1);
+	a3 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(a + 12)), _mm_loadu_ps(a + 12), 1);
+
+	for (i = 0; i < count; i++, b += 16, out += 16) {
+		b01 = _mm256_loadu_ps(b);
+		b23 = _mm256_loadu_ps(b + 8);
+		r01 = _mm256_add_ps(
+			_mm256_add_ps(_mm256_mul_ps(a0, _mm256_permute_ps(b01, 0x00)), _mm256_mul_ps(a1, _mm256_permute_ps(b01, 0x55))),
+			_mm256_add_ps(_mm256_mul_ps(a2, _mm256_permute_ps(b01, 0xAA)), _mm256_mul_ps(a3, _mm256_permute_ps(b01, 0xFF))));
+		r23 = _mm256_add_ps(
+			_mm256_add_ps(_mm256_mul_ps(a0, _mm256_permute_ps(b23, 0x00)), _mm256_mul_ps(a1, _mm256_permute_ps(b23, 0x55))),
+			_mm256_add_ps(_mm256_mul_ps(a2, _mm256_permute_ps(b23, 0xAA)), _mm256_mul_ps(a3, _mm256_permute_ps(b23, 0xFF))));
+		_mm256_storeu_ps(out, r01);
+		_mm256_storeu_ps(out + 8, r23);
+	}
+}
+#endif
+
+/*
+ * Matrices
+ */
+void mat4Identity(float* out) {
+	memset(out, 0, sizeof(float) * 16);
+	out[0] = out[5] = out[10] = out[15] = 1.0f;
+}
+
+void mat4Multiply(float* out, const float* a, const float* b) {
+	mat4MultiplyBatch(out, a, b, 1);
+}
+
+void mat4MultiplyBatch(float* out, const float* a, const float* b, int count) {
+	static int cpu_level = -1;
+	int i;
+#if defined(GL_MATH_SSE)
+	__m128 columns[4];
+#elif defined(GL_MATH_NEON)
+	float32x4_t columns[4];
+#else
+	float copy[16];
+#endif
+
+#ifdef GL_MATH_X86
+	if (cpu_level < 0) cpu_level = SDL_HasAVX() ? 1 : 0;
+	if (cpu_level > 0 && count > 1) {
+		mat4MultiplyBatchAVX(out, a, b, count);
+		return;
+	}
+#else
+	(void)cpu_level;
+#endif
+
+#if defined(GL_MATH_SSE)
+	for (i = 0; i < 4; i++) columns[i] = _mm_loadu_ps(a + i * 4);
+	for (i = 0; i < count; i++) mat4MultiplySSE(out + i * 16, columns, b + i * 16);
+#elif defined(GL_MATH_NEON)
+	for (i = 0; i < 4; i++) columns[i] = vld1q_f32(a + i * 4);
+	for (i = 0; i < count; i++) mat4MultiplyNEON(out + i * 16, columns, b + i * 16);
+#else
+	memcpy(copy, a, sizeof(copy));
+	for (i = 0; i < count; i++) mat4MultiplyScalar(out + i * 16, copy, b + i * 16);
+#endif
+}
+
+void mat4TransformVec4(float* out, const float* m, const float* v) {
+	mat4TransformVec4Batch(out, m, v, 1);
+}
+
+void mat4TransformVec4Batch(float* out, const float* m, const float* v, int count) {
+	int i;
+#if defined(GL_MATH_SSE)
+	__m128 m0, m1, m2, m3, x;
+
+	m0 = _mm_loadu_ps(m + 0);
+	m1 = _mm_loadu_ps(m + 4);
+	m2 = _mm_loadu_ps(m + 8);
+	m3 = _mm_loadu_ps(m + 12);
+	for (i = 0; i < count; i++, v += 4, out += 4) {
+		x = _mm_loadu_ps(v);
+		x = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(m0, _mm_shuffle_ps(x, x, 0x00)), _mm_mul_ps(m1, _mm_shuffle_ps(x, x, 0x55))),
+			_mm_add_ps(_mm_mul_ps(m2, _mm_shuffle_ps(x, x, 0xAA)), _mm_mul_ps(m3, _mm_shuffle_ps(x, x, 0xFF))));
+		_mm_storeu_ps(out, x);
+	}
+#elif defined(GL_MATH_NEON)
+	float32x4_t m0, m1, m2, m3, x, r;
+
+	m0 = vld1q_f32(m + 0);
+	m1 = vld1q_f32(m + 4);
+	m2 = vld1q_f32(m + 8);
+	m3 = vld1q_f32(m + 12);
+	for (i = 0; i < count; i++, v += 4, out += 4) {
+		x = vld1q_f32(v);
+		r = vmulq_n_f32(m0, vgetq_lane_f32(x, 0));
+		r = vmlaq_n_f32(r, m1, vgetq_lane_f32(x, 1));
+		r = vmlaq_n_f32(r, m2, vgetq_lane_f32(x, 2));
+		r = vmlaq_n_f32(r, m3, vgetq_lane_f32(x, 3));
+		vst1q_f32(out, r);
+	}
+#else
+	float r[4];
+	int j;
+
+	for (i = 0; i < count; i++, v += 4, out += 4) {
+		for (j = 0; j < 4; j++) r[j] = m[j] * v[0] + m[4 + j] * v[1] + m[8 + j] * v[2] + m[12 + j] * v[3];
+		memcpy(out, r, sizeof(r));
+	}
+#endif
+}
+
+void mat4Translate(float* m, float x, float y, float z) {
+	int i;
+
+	for (i = 0; i < 4; i++) m[12 + i] += m[i] * x + m[4 + i] * y + m[8 + i] * z;
+}
+
+void mat4Rotate(float* m, float angle, float x, float y, float z) {
+	float q[4];
+	float r[16];
+
+	quatFromAxisAngle(q, angle, x, y, z);
+	mat4FromQuat(r, q);
+	mat4Multiply(m, m, r);
+}
+
+void mat4Scale(float* m, float x, float y, float z) {
+	int i;
+
+	for (i = 0; i < 4; i++) {
+		m[i] *= x;
+		m[4 + i] *= y;
+		m[8 + i] *= z;
+	}
+}
+
+void mat4Frustum(float* out, double left, double right, double bottom, double top, double clip_near, double clip_far) {
+	memset(out, 0, sizeof(float) * 16);
+	out[0] = (float)(2.0 * clip_near / (right - left));
+	out[5] = (float)(2.0 * clip_near / (top - bottom));
+	out[8] = (float)((right + left) / (right - left));
+	out[9] = (float)((top + bottom) / (top - bottom));
+	out[10] = (float)(-(clip_far + clip_near) / (clip_far - clip_near));
+	out[11] = -1.0f;
+	out[14] = (float)(-2.0 * clip_far * clip_near / (clip_far - clip_near));
+}
+
+void mat4Ortho(float* out, double left, double right, double bottom, double top, double clip_near, double clip_far) {
+	memset(out, 0, sizeof(float) * 16);
+	out[0] = (float)(2.0 / (right - left));
+	out[5] = (float)(2.0 / (top - bottom));
+	out[10] = (float)(-2.0 / (clip_far - clip_near));
+	out[12] = (float)(-(right + left) / (right - left));
+	out[13] = (float)(-(top + bottom) / (top - bottom));
+	out[14] = (float)(-(clip_far + clip_near) / (clip_far - clip_near));
+	out[15] = 1.0f;
+}
+
+void mat4Perspective(float* out, double view_width, double view_height, double fov, double clip_near, double clip_far) {
+	double width, height;
+
+	getFrustrumValues(view_width, view_height, fov, clip_near, &width, &height);
+	mat4Frustum(out, -width, width, -height, height, clip_near, clip_far);
+}
+
+bool mat4Inverse(float* out, const float* m) {
+	float inv[16];
+	float det;
+	int i;
+
+	// Cofactor expansion (adjugate / determinant)
+	inv[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+	inv[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+	inv[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+	inv[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+	inv[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+	inv[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+	inv[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+	inv[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+	inv[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+	inv[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+	inv[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+	inv[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+	inv[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+	inv[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+	inv[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+	inv[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+	det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+	if (det == 0.0f) {
+		mat4Identity(out);
+		return false;
+	}
+
+	det = 1.0f / det;
+	for (i = 0; i < 16; i++) out[i] = inv[i] * det;
+	return true;
+}
+
+void mat4FromQuat(float* out, const float* q) {
+	float x = q[0], y = q[1], z = q[2], w = q[3];
+
+	out[0] = 1.0f - 2.0f * (y * y + z * z);
+	out[1] = 2.0f * (x * y + w * z);
+	out[2] = 2.0f * (x * z - w * y);
+	out[3] = 0.0f;
+	out[4] = 2.0f * (x * y - w * z);
+	out[5] = 1.0f - 2.0f * (x * x + z * z);
+	out[6] = 2.0f * (y * z + w * x);
+	out[7] = 0.0f;
+	out[8] = 2.0f * (x * z + w * y);
+	out[9] = 2.0f * (y * z - w * x);
+	out[10] = 1.0f - 2.0f * (x * x + y * y);
+	out[11] = 0.0f;
+	out[12] = 0.0f;
+	out[13] = 0.0f;
+	out[14] = 0.0f;
+	out[15] = 1.0f;
+}
+
+void mat4FromTransform(float* out, const float* position, const float* rotation, const float* scale) {
+	int i;
+
+	mat4FromQuat(out, rotation);
+	for (i = 0; i < 3; i++) {
+		out[i] *= scale[0];
+		out[4 + i] *= scale[1];
+		out[8 + i] *= scale[2];
+	}
+	out[12] = position[0];
+	out[13] = position[1];
+	out[14] = position[2];
+}
+
+/*
+ * Quaternions
+ */
+void quatIdentity(float* out) {
+	out[0] = out[1] = out[2] = 0.0f;
+	out[3] = 1.0f;
+}
+
+void quatFromAxisAngle(float* out, float angle, float x, float y, float z) {
+	float length, s;
+
+	length = sqrtf(x * x + y * y + z * z);
+	if (length == 0.0f) {
+		quatIdentity(out);
+		return;
+	}
+
+	s = (float)sin(angle * GL_MATH_DEG_TO_RAD * 0.5) / length;
+	out[0] = x * s;
+	out[1] = y * s;
+	out[2] = z * s;
+	out[3] = (float)cos(angle * GL_MATH_DEG_TO_RAD * 0.5);
+}
+
+void quatMultiply(float* out, const float* a, const float* b) {
+	float r[4];
+
+	r[0] = a[3] * b[0] + a[0] * b[3] + a[1] * b[2] - a[2] * b[1];
+	r[1] = a[3] * b[1] - a[0] * b[2] + a[1] * b[3] + a[2] * b[0];
+	r[2] = a[3] * b[2] + a[0] * b[1] - a[1] * b[0] + a[2] * b[3];
+	r[3] = a[3] * b[3] - a[0] * b[0] - a[1] * b[1] - a[2] * b[2];
+	memcpy(out, r, sizeof(r));
+}
+
+void quatNormalize(float* q) {
+	float length;
+
+	length = sqrtf(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+	if (length == 0.0f) {
+		quatIdentity(q);
+		return;
+	}
+	length = 1.0f / length;
+	q[0] *= length;
+	q[1] *= length;
+	q[2] *= length;
+	q[3] *= length;
+}
@@ -0,0 +1,99 @@
+#pragma once
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include <stdbool.h>
+
+#include <SDL.h>
+
+/*
+ * Matrices are float[16] in OpenGL column-major order (as glLoadMatrixf);
+ * vectors are float[4] and quaternions float[4] as x, y, z, w.
+ * Output may alias any input unless noted.
+ */
+
+extern void mat4Identity(float* out);
+
+/**
+ * Multiply matrices (out = a * b, b applied first)
+ */
+extern void mat4Multiply(float* out, const float* a, const float* b);
+
+/**
+ * Multiply one matrix by an array of matrices (out[i] = a * b[i])
+ *
+ * Uses AVX (two columns at a time) where available, else SSE or NEON.
+ *
+ * \param out Destination array of count matrices (may alias b)
+ * \param a Matrix applied last (eg: view-projection)
+ * \param b Array of count matrices (eg: model matrices)
+ * \param count Number of matrices
+ */
+extern void mat4MultiplyBatch(float* out, const float* a, const float* b, int count);
+
+/**
+ * Transform vector (out = m * v)
+ */
+extern void mat4TransformVec4(float* out, const float* m, const float* v);
+
+/**
+ * Transform array of vectors by one matrix (out[i] = m * v[i])
+ */
+extern void mat4TransformVec4Batch(float* out, const float* m, const float* v, int count);
+
+/**
+ * Post-multiply transforms, matching glTranslatef(), glRotatef() and glScalef()
+ *
+ * \param m Matrix to modify in place
+ */
+extern void mat4Translate(float* m, float x, float y, float z);
+extern void mat4Rotate(float* m, float angle, float x, float y, float z);
+extern void mat4Scale(float* m, float x, float y, float z);
+
+/**
+ * Projection matrices, matching glFrustum() and glOrtho()
+ */
+extern void mat4Frustum(float* out, double left, double right, double bottom, double top, double clip_near, double clip_far);
+extern void mat4Ortho(float* out, double left, double right, double bottom, double top, double clip_near, double clip_far);
+
+/**
+ * Perspective projection from horizontal field of view (see getFrustrumValues())
+ */
+extern void mat4Perspective(float* out, double view_width, double view_height, double fov, double clip_near, double clip_far);
+
+/**
+ * Invert matrix
+ *
+ * \returns false (and identity in out) if m is singular
+ */
+extern bool mat4Inverse(float* out, const float* m);
+
+/**
+ * Build translate * rotate * scale matrix
+ *
+ * \param position x, y, z
+ * \param rotation Unit quaternion
+ * \param scale x, y, z
+ */
+extern void mat4FromTransform(float* out, const float* position, const float* rotation, const float* scale);
+
+extern void mat4FromQuat(float* out, const float* q);
+
+extern void quatIdentity(float* out);
+
+/**
+ * Quaternion rotating angle degrees about axis (axis need not be normalized)
+ */
+extern void quatFromAxisAngle(float* out, float angle, float x, float y, float z);
+
+/**
+ * Combine rotations (out = a * b, b applied first)
+ */
+extern void quatMultiply(float* out, const float* a, const float* b);
+
+extern void quatNormalize(float* q);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,396 @@
+#include "gl_profiler.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "glsl_ext.h"
+
+#define PROFILE_NAME_LENGTH 48
+
+typedef struct {
+	float samples[PROFILE_HISTORY]; // Milliseconds, ring
+	int next;
+	Uint32 count;
+	Uint64 calls;
+} ProfileHistory;
+
+typedef struct {
+	char name[PROFILE_NAME_LENGTH];
+	const char* key; // Pointer last passed to profileBegin(), checked before comparing names
+	ProfileHistory cpu;
+	ProfileHistory gpu;
+} ProfileScope;
+
+// Open scope
+typedef struct {
+	int scope;
+	Uint32 flags;
+	Uint64 cpu_start;
+	int gpu_scope; // Index into current frame's GPU scopes or -1
+} ProfileMarker;
+
+// GPU scope awaiting results, queries[index * 2] and queries[index * 2 + 1]
+typedef struct {
+	int scope;
+	int depth;
+} ProfileGPUScope;
+
+typedef struct {
+	GLuint queries[PROFILE_MAX_GPU_SCOPES * 2];
+	ProfileGPUScope scopes[PROFILE_MAX_GPU_SCOPES];
+	int count;
+	int last_query;   // Index of last query issued (outer frame scope ends after nested ones)
+	Uint64 cpu_start; // Used to align GPU clock when glGetInteger64v() is missing
+} ProfileFrame;
+
+// Completed scope for trace export
+typedef struct {
+	Uint16 scope;
+	Uint8 gpu;
+	Uint8 depth;
+	double start_us; // Since initProfiler()
+	double duration_us;
+} ProfileEvent;
+
+bool PROFILER_ENABLED = false;
+bool PROFILER_GPU_SUPPORTED = false;
+
+ProfileScope PROFILE_SCOPES[PROFILE_MAX_SCOPES];
+int PROFILE_SCOPE_COUNT = 0;
+ProfileMarker PROFILE_STACK[PROFILE_MAX_DEPTH];
+int PROFILE_DEPTH = 0;
+ProfileFrame PROFILE_FRAMES[PROFILE_QUERY_FRAMES];
+int PROFILE_FRAME = 0;
+ProfileEvent* PROFILE_TRACE = NULL;
+int PROFILE_TRACE_NEXT = 0;
+int PROFILE_TRACE_COUNT = 0;
+Uint64 PROFILE_GPU_DROPPED = 0;
+
+Uint64 PROFILE_CPU_BASE;      // Performance counter at initProfiler()
+double PROFILE_CPU_PERIOD_US; // Microseconds per performance counter tick
+Uint64 PROFILE_GPU_BASE;      // GPU timestamp (ns) matching PROFILE_GPU_CPU_BASE_US
+double PROFILE_GPU_CPU_BASE_US;
+bool PROFILE_GPU_ALIGNED = false;
+
+/*
+ * Scopes
+ */
+static int findProfileScope(const char* name, bool create) {
+	int i;
+
+	// Pointer match still compares names in case caller reused a buffer with new contents
+	for (i = 0; i < PROFILE_SCOPE_COUNT; i++) {
+		if (PROFILE_SCOPES[i].key == name && strncmp(PROFILE_SCOPES[i].name, name, PROFILE_NAME_LENGTH - 1) == 0) return i;
+	}
+	for (i = 0; i < PROFILE_SCOPE_COUNT; i++) {
+		if (strncmp(PROFILE_SCOPES[i].name, name, PROFILE_NAME_LENGTH - 1) == 0) {
+			PROFILE_SCOPES[i].key = name;
+			return i;
+		}
+	}
+	if (!create || PROFILE_SCOPE_COUNT == PROFILE_MAX_SCOPES) return -1;
+
+	i = PROFILE_SCOPE_COUNT++;
+	memset(&PROFILE_SCOPES[i], 0, sizeof(ProfileScope));
+	strncpy(PROFILE_SCOPES[i].name, name, PROFILE_NAME_LENGTH - 1);
+	PROFILE_SCOPES[i].key = name;
+	return i;
+}
+
+static void addProfileSample(ProfileHistory* history, double ms) {
+	history->samples[history->next] = (float)ms;
+	history->next = (history->next + 1) % PROFILE_HISTORY;
+	if (history->count < PROFILE_HISTORY) history->count++;
+	history->calls++;
+}
+
+static void addProfileEvent(int scope, bool gpu, int depth, double start_us, double duration_us) {
+	ProfileEvent* event = &PROFILE_TRACE[PROFILE_TRACE_NEXT];
+
+	event->scope = (Uint16)scope;
+	event->gpu = gpu;
+	event->depth = (Uint8)depth;
+	event->start_us = start_us;
+	event->duration_us = duration_us;
+	PROFILE_TRACE_NEXT = (PROFILE_TRACE_NEXT + 1) % PROFILE_TRACE_EVENTS;
+	if (PROFILE_TRACE_COUNT < PROFILE_TRACE_EVENTS) PROFILE_TRACE_COUNT++;
+}
+
+/*
+ * GPU results
+ */
+static double gpuTimeToMicroseconds(GLuint64 timestamp) {
+	return PROFILE_GPU_CPU_BASE_US + ((double)timestamp - (double)PROFILE_GPU_BASE) * 0.001;
+}
+
+static void resolveProfileFrame(ProfileFrame* frame) {
+	ProfileGPUScope* gpu_scope;
+	GLuint64 start, end;
+	GLint available = 0;
+	int i;
+
+	if (frame->count == 0) return;
+
+	// Queries complete in issue order; if the last issued is ready the rest can be read without stalling
+	glGetQueryObjectiv(frame->queries[frame->last_query], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available) {
+		PROFILE_GPU_DROPPED += frame->count;
+		frame->count = 0;
+		return;
+	}
+
+	for (i = 0; i < frame->count; i++) {
+		gpu_scope = &frame->scopes[i];
+		glGetQueryObjectui64v(frame->queries[i * 2], GL_QUERY_RESULT, &start);
+		glGetQueryObjectui64v(frame->queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+
+		// Without glGetInteger64v() the first frame's start is taken as its CPU start
+		if (!PROFILE_GPU_ALIGNED) {
+			PROFILE_GPU_BASE = start;
+			PROFILE_GPU_CPU_BASE_US = (double)(frame->cpu_start - PROFILE_CPU_BASE) * PROFILE_CPU_PERIOD_US;
+			PROFILE_GPU_ALIGNED = true;
+		}
+
+		addProfileSample(&PROFILE_SCOPES[gpu_scope->scope].gpu, (double)(end - start) * 0.000001);
+		addProfileEvent(gpu_scope->scope, true, gpu_scope->depth, gpuTimeToMicroseconds(start), (double)(end - start) * 0.001);
+	}
+	frame->count = 0;
+}
+
+/*
+ * Statistics
+ */
+static int compareProfileSamples(const void* a, const void* b) {
+	float fa = *(const float*)a;
+	float fb = *(const float*)b;
+	return (fa > fb) - (fa < fb);
+}
+
+// Nearest-rank percentile of sorted samples
+static double profilePercentile(const float* sorted, Uint32 count, double percentile) {
+	int rank = (int)ceil(percentile * count) - 1;
+	if (rank < 0) rank = 0;
+	return sorted[rank];
+}
+
+static bool getProfileHistoryStats(const ProfileScope* scope, const ProfileHistory* history, ProfileStats* stats) {
+	float sorted[PROFILE_HISTORY];
+	double sum = 0.0;
+	Uint32 i;
+
+	if (history->count == 0) return false;
+
+	memcpy(sorted, history->samples, sizeof(float) * history->count);
+	qsort(sorted, history->count, sizeof(float), compareProfileSamples);
+	for (i = 0; i < history->count; i++) sum += sorted[i];
+
+	stats->name = scope->name;
+	stats->calls = history->calls;
+	stats->samples = history->count;
+	stats->last_ms = history->samples[(history->next + PROFILE_HISTORY - 1) % PROFILE_HISTORY];
+	stats->mean_ms = sum / history->count;
+	stats->p50_ms = profilePercentile(sorted, history->count, 0.50);
+	stats->p95_ms = profilePercentile(sorted, history->count, 0.95);
+	stats->p99_ms = profilePercentile(sorted, history->count, 0.99);
+	stats->max_ms = sorted[history->count - 1];
+	return true;
+}
+
+// Scope names are caller supplied; keep JSON valid
+static void writeProfileString(FILE* file, const char* string) {
+	fputc('"', file);
+	for (; *string; string++) {
+		if (*string == '"' || *string == '\\') fputc('\\', file);
+		if ((unsigned char)*string >= 0x20) fputc(*string, file);
+	}
+	fputc('"', file);
+}
+
+/*
+ * Public API
+ */
+bool initProfiler() {
+	GLint64 gpu_now;
+	int i;
+
+	// Restart with fresh scopes if already running
+	quitProfiler();
+
+	PROFILE_TRACE = (ProfileEvent*)malloc(sizeof(ProfileEvent) * PROFILE_TRACE_EVENTS);
+	if (PROFILE_TRACE == NULL) {
+		SDL_SetError("Failed to allocate profiler trace buffer");
+		return false;
+	}
+	PROFILE_FRAME = 0;
+	PROFILE_GPU_DROPPED = 0;
+
+	PROFILE_CPU_BASE = SDL_GetPerformanceCounter();
+	PROFILE_CPU_PERIOD_US = 1000000.0 / (double)SDL_GetPerformanceFrequency();
+	PROFILE_GPU_ALIGNED = false;
+
+	if (!PROFILER_GPU_SUPPORTED) PROFILER_GPU_SUPPORTED = createTimerQueryFunctions();
+	if (PROFILER_GPU_SUPPORTED) {
+		for (i = 0; i < PROFILE_QUERY_FRAMES; i++) {
+			glGenQueries(PROFILE_MAX_GPU_SCOPES * 2, PROFILE_FRAMES[i].queries);
+			PROFILE_FRAMES[i].count = 0;
+		}
+
+		// One synchronous read at startup to put both clocks on one timeline
+		if (glGetInteger64v != NULL) {
+			glGetInteger64v(GL_TIMESTAMP, &gpu_now);
+			PROFILE_GPU_BASE = (GLuint64)gpu_now;
+			PROFILE_GPU_CPU_BASE_US = (double)(SDL_GetPerformanceCounter() - PROFILE_CPU_BASE) * PROFILE_CPU_PERIOD_US;
+			PROFILE_GPU_ALIGNED = true;
+		}
+	} else {
+		printf("[WARN] GL_ARB_timer_query unsupported, profiling CPU only\n");
+	}
+
+	PROFILER_ENABLED = true;
+	return true;
+}
+
+void profileBeginFrame() {
+	if (!PROFILER_ENABLED) return;
+
+	PROFILE_FRAMES[PROFILE_FRAME].cpu_start = SDL_GetPerformanceCounter();
+	profileBegin(PROFILE_SCOPE_FRAME, PROFILE_CPU | PROFILE_GPU);
+}
+
+void profileEndFrame() {
+	if (!PROFILER_ENABLED) return;
+
+	if (PROFILE_DEPTH > 1) printf("[WARN] %d profile scopes left open at end of frame\n", PROFILE_DEPTH - 1);
+	while (PROFILE_DEPTH > 0) profileEnd();
+
+	// Oldest frame is about to be reused, collect what the GPU has finished
+	if (PROFILER_GPU_SUPPORTED) {
+		PROFILE_FRAME = (PROFILE_FRAME + 1) % PROFILE_QUERY_FRAMES;
+		resolveProfileFrame(&PROFILE_FRAMES[PROFILE_FRAME]);
+	}
+}
+
+void profileBegin(const char* name, Uint32 flags) {
+	ProfileFrame* frame = &PROFILE_FRAMES[PROFILE_FRAME];
+	ProfileMarker* marker;
+	int scope;
+
+	if (!PROFILER_ENABLED) return;
+	if (PROFILE_DEPTH == PROFILE_MAX_DEPTH) {
+		printf("[WARN] Profile scope '%s' exceeds maximum depth %d\n", name, PROFILE_MAX_DEPTH);
+		return;
+	}
+	scope = findProfileScope(name, true);
+	if (scope < 0) {
+		printf("[WARN] Profile scope '%s' exceeds maximum scopes %d\n", name, PROFILE_MAX_SCOPES);
+		return;
+	}
+
+	marker = &PROFILE_STACK[PROFILE_DEPTH++];
+	marker->scope = scope;
+	marker->flags = flags;
+	marker->gpu_scope = -1;
+	if ((flags & PROFILE_GPU) && PROFILER_GPU_SUPPORTED && frame->count < PROFILE_MAX_GPU_SCOPES) {
+		marker->gpu_scope = frame->count++;
+		frame->scopes[marker->gpu_scope].scope = scope;
+		frame->scopes[marker->gpu_scope].depth = PROFILE_DEPTH - 1;
+		glQueryCounter(frame->queries[marker->gpu_scope * 2], GL_TIMESTAMP);
+		frame->last_query = marker->gpu_scope * 2;
+	}
+	marker->cpu_start = SDL_GetPerformanceCounter();
+}
+
+void profileEnd() {
+	ProfileMarker* marker;
+	Uint64 cpu_end = SDL_GetPerformanceCounter();
+	double start_us, duration_us;
+
+	if (!PROFILER_ENABLED || PROFILE_DEPTH == 0) return;
+
+	marker = &PROFILE_STACK[--PROFILE_DEPTH];
+	if (marker->gpu_scope >= 0) {
+		glQueryCounter(PROFILE_FRAMES[PROFILE_FRAME].queries[marker->gpu_scope * 2 + 1], GL_TIMESTAMP);
+		PROFILE_FRAMES[PROFILE_FRAME].last_query = marker->gpu_scope * 2 + 1;
+	}
+	if (marker->flags & PROFILE_CPU) {
+		start_us = (double)(marker->cpu_start - PROFILE_CPU_BASE) * PROFILE_CPU_PERIOD_US;
+		duration_us = (double)(cpu_end - marker->cpu_start) * PROFILE_CPU_PERIOD_US;
+		addProfileSample(&PROFILE_SCOPES[marker->scope].cpu, duration_us * 0.001);
+		addProfileEvent(marker->scope, false, PROFILE_DEPTH, start_us, duration_us);
+	}
+}
+
+bool getProfileStats(const char* name, Uint32 flags, ProfileStats* stats) {
+	int scope = findProfileScope(name, false);
+
+	if (scope < 0) return false;
+	if (flags & PROFILE_GPU) return getProfileHistoryStats(&PROFILE_SCOPES[scope], &PROFILE_SCOPES[scope].gpu, stats);
+	return getProfileHistoryStats(&PROFILE_SCOPES[scope], &PROFILE_SCOPES[scope].cpu, stats);
+}
+
+void printProfileReport() {
+	ProfileStats stats;
+	int i;
+
+	printf("Profile (ms over last %d samples)\n", PROFILE_HISTORY);
+	printf("  %-24s %-4s %9s %9s %9s %9s %9s\n", "scope", "", "mean", "p50", "p95", "p99", "max");
+	for (i = 0; i < PROFILE_SCOPE_COUNT; i++) {
+		if (getProfileHistoryStats(&PROFILE_SCOPES[i], &PROFILE_SCOPES[i].cpu, &stats)) {
+			printf("  %-24s %-4s %9.3f %9.3f %9.3f %9.3f %9.3f\n", stats.name, "cpu", stats.mean_ms, stats.p50_ms, stats.p95_ms, stats.p99_ms, stats.max_ms);
+		}
+		if (getProfileHistoryStats(&PROFILE_SCOPES[i], &PROFILE_SCOPES[i].gpu, &stats)) {
+			printf("  %-24s %-4s %9.3f %9.3f %9.3f %9.3f %9.3f\n", stats.name, "gpu", stats.mean_ms, stats.p50_ms, stats.p95_ms, stats.p99_ms, stats.max_ms);
+		}
+	}
+	if (PROFILE_GPU_DROPPED) printf("  %llu GPU scopes dropped (results not ready after %d frames)\n", (unsigned long long)PROFILE_GPU_DROPPED, PROFILE_QUERY_FRAMES - 1);
+}
+
+bool saveProfileTrace(const char* filename) {
+	const ProfileEvent* event;
+	FILE* file;
+	int i;
+
+	file = fopen(filename, "w");
+	if (file == NULL) {
+		SDL_SetError("Failed to open profile trace file: %s", filename);
+		return false;
+	}
+
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"CPU\"}},\n");
+	fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":1,\"args\":{\"name\":\"GPU\"}}");
+
+	// Oldest first
+	for (i = 0; i < PROFILE_TRACE_COUNT; i++) {
+		event = &PROFILE_TRACE[(PROFILE_TRACE_NEXT + PROFILE_TRACE_EVENTS - PROFILE_TRACE_COUNT + i) % PROFILE_TRACE_EVENTS];
+		fprintf(file, ",\n{\"name\":");
+		writeProfileString(file, PROFILE_SCOPES[event->scope].name);
+		fprintf(file, ",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"depth\":%d}}",
+			event->gpu ? "gpu" : "cpu", event->gpu ? 1 : 0, event->start_us, event->duration_us, event->depth);
+	}
+	fprintf(file, "\n]}\n");
+
+	if (fclose(file) != 0) {
+		SDL_SetError("Failed to write profile trace file: %s", filename);
+		return false;
+	}
+	return true;
+}
+
+void quitProfiler() {
+	int i;
+
+	if (PROFILE_TRACE == NULL) return;
+
+	if (PROFILER_GPU_SUPPORTED) {
+		for (i = 0; i < PROFILE_QUERY_FRAMES; i++) glDeleteQueries(PROFILE_MAX_GPU_SCOPES * 2, PROFILE_FRAMES[i].queries);
+	}
+	free(PROFILE_TRACE);
+	PROFILE_TRACE = NULL;
+	PROFILE_TRACE_NEXT = PROFILE_TRACE_COUNT = 0;
+	PROFILE_SCOPE_COUNT = 0;
+	PROFILE_DEPTH = 0;
+	PROFILER_ENABLED = false;
+}
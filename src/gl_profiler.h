@@ -0,0 +1,115 @@
+#pragma once
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include <stdbool.h>
+
+#include <SDL.h>
+
+// Scope flags for profileBegin()
+#define PROFILE_CPU 0x1 // Time on CPU with SDL_GetPerformanceCounter()
+#define PROFILE_GPU 0x2 // Time on GPU with timestamp queries (ignored if unsupported)
+
+#define PROFILE_MAX_SCOPES     64    // Distinct scope names
+#define PROFILE_MAX_DEPTH      16    // Nested scopes open at once
+#define PROFILE_MAX_GPU_SCOPES 64    // GPU scopes per frame
+#define PROFILE_QUERY_FRAMES   4     // GPU results are read this many frames late
+#define PROFILE_HISTORY        256   // Samples per scope for percentiles
+#define PROFILE_TRACE_EVENTS   16384 // Most recent events kept for saveProfileTrace()
+
+// Scopes opened by drawGLBegin() / drawGLEnd()
+#define PROFILE_SCOPE_FRAME  "frame"
+#define PROFILE_SCOPE_SWAP   "swap"
+#define PROFILE_SCOPE_PACING "pacing" // Frame limiter wait (see setFramePacing())
+
+extern bool PROFILER_ENABLED;       // Set by initProfiler(), clear between frames to pause profiling
+extern bool PROFILER_GPU_SUPPORTED; // Timer queries available
+
+typedef struct {
+	const char* name;
+	Uint64 calls;    // Total samples since initProfiler()
+	Uint32 samples;  // Samples in rolling window (up to PROFILE_HISTORY)
+	double last_ms;
+	double mean_ms;
+	double p50_ms;
+	double p95_ms;
+	double p99_ms;
+	double max_ms;
+} ProfileStats;
+
+/**
+ * Start profiling frames
+ *
+ * Once initialized drawGLBegin() and drawGLEnd() time each frame as
+ * PROFILE_SCOPE_FRAME (CPU and GPU), the buffer swap as PROFILE_SCOPE_SWAP
+ * and any frame limiter wait as PROFILE_SCOPE_PACING.
+ * Requires current OpenGL context for GPU timing.
+ *
+ * \returns true on success or false on failure; call SDL_GetError() for more information.
+ *
+ * \sa quitProfiler
+ */
+extern bool initProfiler();
+
+/**
+ * Begin and end frame (called by drawGLBegin() and drawGLEnd())
+ *
+ * Ending a frame closes any scopes left open and collects GPU results of the
+ * frame PROFILE_QUERY_FRAMES - 1 frames earlier, dropping results not yet
+ * available rather than waiting on the GPU.
+ */
+extern void profileBeginFrame();
+extern void profileEndFrame();
+
+/**
+ * Open a named scope, closed by profileEnd()
+ *
+ * Scopes may nest (up to PROFILE_MAX_DEPTH) and must be used from the
+ * thread owning the OpenGL context.
+ *
+ * \param name Scope name, matched by contents (string literals skip the comparison's slow path)
+ * \param flags PROFILE_CPU and/or PROFILE_GPU
+ *
+ * \sa profileEnd
+ */
+extern void profileBegin(const char* name, Uint32 flags);
+
+/**
+ * Close most recently opened scope
+ */
+extern void profileEnd();
+
+/**
+ * Get rolling statistics of scope
+ *
+ * \param name Scope name
+ * \param flags PROFILE_CPU or PROFILE_GPU, selects timing to report
+ * \param stats Filled with statistics over last PROFILE_HISTORY samples
+ * \returns true on success or false if scope has no samples
+ */
+extern bool getProfileStats(const char* name, Uint32 flags, ProfileStats* stats);
+
+/**
+ * Print p50/p95/p99 of every scope to stdout
+ */
+extern void printProfileReport();
+
+/**
+ * Write recent scopes as Chrome trace-event JSON (chrome://tracing, Perfetto)
+ *
+ * CPU scopes appear on thread 0 and GPU scopes on thread 1, aligned to CPU time.
+ *
+ * \param filename File path to write
+ * \returns true on success or false on failure; call SDL_GetError() for more information.
+ */
+extern bool saveProfileTrace(const char* filename);
+
+/**
+ * Release query objects and stop profiling
+ */
+extern void quitProfiler();
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,133 @@
+#include "gl_state.h"
+
+#include <string.h>
+
+#include "glsl_ext.h"
+
+#define GL_STATE_UNKNOWN (-1)
+#define GL_STATE_NUM_CAPS 4
+
+// Shadow of GL state; GL_STATE_UNKNOWN forces next call to be issued
+typedef struct {
+	GLint program;
+	GLint active_unit;
+	GLint textures[GL_STATE_MAX_TEXTURE_UNITS];
+	GLint texture_2d[GL_STATE_MAX_TEXTURE_UNITS];
+	GLint tex_env_mode[GL_STATE_MAX_TEXTURE_UNITS];
+	GLint caps[GL_STATE_NUM_CAPS];
+	GLint blend_src;
+	GLint blend_dst;
+	GLint depth_func;
+	GLint depth_mask;
+} GLState;
+
+const GLenum GL_STATE_CAPS[GL_STATE_NUM_CAPS] = {
+	GL_BLEND,
+	GL_DEPTH_TEST,
+	GL_CULL_FACE,
+	GL_SCISSOR_TEST
+};
+
+GLState GL_STATE;
+GLStateStats GL_STATE_STATS;
+bool GL_STATE_MULTITEXTURE = false;
+
+// Returns true (and updates shadow) if call must be issued
+bool glStateChanged(GLint* shadow, GLint value) {
+	if (*shadow == value) {
+		GL_STATE_STATS.elided++;
+		return false;
+	}
+	*shadow = value;
+	GL_STATE_STATS.issued++;
+	return true;
+}
+
+void glStateReset() {
+	memset(&GL_STATE, 0xFF, sizeof(GLState));
+
+	// Units beyond 0 need glActiveTexture (missing from some GL 1.1 exports)
+	GL_STATE_MULTITEXTURE = createMultitextureFunctions();
+}
+
+void glStateUseProgram(GLhandleARB program) {
+	if (glStateChanged(&GL_STATE.program, (GLint)program)) glUseProgramObject(program);
+}
+
+GLhandleARB glStateGetProgram() {
+	return GL_STATE.program == GL_STATE_UNKNOWN ? 0 : (GLhandleARB)GL_STATE.program;
+}
+
+void glStateActiveTexture(GLenum unit) {
+	if (!GL_STATE_MULTITEXTURE || unit < GL_TEXTURE0 || unit >= GL_TEXTURE0 + GL_STATE_MAX_TEXTURE_UNITS) return;
+	if (glStateChanged(&GL_STATE.active_unit, unit - GL_TEXTURE0)) glActiveTextureUnit(unit);
+}
+
+int glStateUnit() {
+	// Unit 0 assumed until first glStateActiveTexture()
+	return GL_STATE.active_unit == GL_STATE_UNKNOWN ? 0 : GL_STATE.active_unit;
+}
+
+void glStateBindTexture(GLuint texture) {
+	if (glStateChanged(&GL_STATE.textures[glStateUnit()], texture)) glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+void glStateForgetTexture(GLuint texture) {
+	int i;
+
+	// Deleting a bound texture reverts unit binding to 0
+	for (i = 0; i < GL_STATE_MAX_TEXTURE_UNITS; i++) {
+		if (GL_STATE.textures[i] == (GLint)texture) GL_STATE.textures[i] = GL_STATE_UNKNOWN;
+	}
+}
+
+void glStateEnable(GLenum cap, bool enable) {
+	int i;
+	GLint* shadow = NULL;
+
+	if (cap == GL_TEXTURE_2D) shadow = &GL_STATE.texture_2d[glStateUnit()];
+	for (i = 0; shadow == NULL && i < GL_STATE_NUM_CAPS; i++) {
+		if (GL_STATE_CAPS[i] == cap) shadow = &GL_STATE.caps[i];
+	}
+
+	// Untracked capabilities always issued
+	if (shadow == NULL) {
+		GL_STATE_STATS.issued++;
+	} else if (!glStateChanged(shadow, enable)) {
+		return;
+	}
+
+	if (enable) glEnable(cap);
+	else glDisable(cap);
+}
+
+void glStateBlendFunc(GLenum src, GLenum dst) {
+	if (GL_STATE.blend_src == (GLint)src && GL_STATE.blend_dst == (GLint)dst) {
+		GL_STATE_STATS.elided++;
+		return;
+	}
+	GL_STATE.blend_src = src;
+	GL_STATE.blend_dst = dst;
+	GL_STATE_STATS.issued++;
+	glBlendFunc(src, dst);
+}
+
+void glStateDepthFunc(GLenum func) {
+	if (glStateChanged(&GL_STATE.depth_func, func)) glDepthFunc(func);
+}
+
+void glStateDepthMask(GLboolean mask) {
+	if (glStateChanged(&GL_STATE.depth_mask, mask)) glDepthMask(mask);
+}
+
+void glStateTexEnvMode(GLenum mode) {
+	if (glStateChanged(&GL_STATE.tex_env_mode[glStateUnit()], mode)) glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, mode);
+}
+
+GLStateStats glStateGetStats() {
+	return GL_STATE_STATS;
+}
+
+void glStateResetStats() {
+	memset(&GL_STATE_STATS, 0, sizeof(GLStateStats));
+}
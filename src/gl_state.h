@@ -0,0 +1,92 @@
+#pragma once
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include <stdbool.h>
+
+#include <SDL.h>
+#include <SDL_opengl.h>
+
+#define GL_STATE_MAX_TEXTURE_UNITS 16
+
+typedef struct {
+	Uint64 issued;
+	Uint64 elided;
+} GLStateStats;
+
+/**
+ * Forget all shadowed GL state so the next call of each kind is issued
+ *
+ * Called on context creation; call again after any GL state is changed
+ * outside of glState* functions (eg: third-party rendering code).
+ */
+extern void glStateReset();
+
+/**
+ * Use shader program if not already in use
+ *
+ * \param program Program handle or 0 for fixed-function
+ */
+extern void glStateUseProgram(GLhandleARB program);
+
+/**
+ * Get program last set by glStateUseProgram()
+ */
+extern GLhandleARB glStateGetProgram();
+
+/**
+ * Select active texture unit if not already active
+ *
+ * \param unit GL_TEXTURE0 + n (n < GL_STATE_MAX_TEXTURE_UNITS)
+ */
+extern void glStateActiveTexture(GLenum unit);
+
+/**
+ * Bind 2D texture to active unit if not already bound
+ *
+ * \param texture Texture name or 0
+ */
+extern void glStateBindTexture(GLuint texture);
+
+/**
+ * Drop texture from shadowed bindings (call before glDeleteTextures)
+ *
+ * \param texture Texture name about to be deleted
+ */
+extern void glStateForgetTexture(GLuint texture);
+
+/**
+ * Enable or disable capability if changed
+ *
+ * Shadowed: GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE, GL_SCISSOR_TEST and
+ * GL_TEXTURE_2D (per texture unit); other capabilities are always issued.
+ *
+ * \param cap GL capability
+ * \param enable true to glEnable, false to glDisable
+ */
+extern void glStateEnable(GLenum cap, bool enable);
+
+extern void glStateBlendFunc(GLenum src, GLenum dst);
+extern void glStateDepthFunc(GLenum func);
+extern void glStateDepthMask(GLboolean mask);
+
+/**
+ * Set GL_TEXTURE_ENV_MODE of active texture unit if changed
+ *
+ * \param mode eg: GL_MODULATE, GL_REPLACE
+ */
+extern void glStateTexEnvMode(GLenum mode);
+
+/**
+ * Get counts of state calls issued to GL and elided as redundant
+ *
+ * \sa glStateResetStats
+ */
+extern GLStateStats glStateGetStats();
+
+extern void glStateResetStats();
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,6 +1,9 @@
 #include "glsl_ext.h"
 
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
 
 #include <SDL.h>
 
@@ -13,6 +16,7 @@ PFNGLDELETEOBJECTARBPROC glDeleteObject;
 PFNGLGETINFOLOGARBPROC glGetShaderInfoLog;
 PFNGLGETOBJECTPARAMETERIVARBPROC glGetObjectParameteriv;
 PFNGLGETUNIFORMLOCATIONARBPROC glGetUniformLocation;
+PFNGLGETACTIVEUNIFORMARBPROC glGetActiveUniform;
 PFNGLLINKPROGRAMARBPROC glLinkProgram;
 PFNGLSHADERSOURCEARBPROC glShaderSource;
 PFNGLUSEPROGRAMOBJECTARBPROC glUseProgramObject;
@@ -32,9 +36,193 @@ PFNGLUNIFORM1DPROC      glUniform1d;
 PFNGLUNIFORM2DPROC      glUniform2d;
 PFNGLUNIFORM3DPROC      glUniform3d;
 PFNGLUNIFORM4DPROC      glUniform4d;
+PFNGLUNIFORMMATRIX4FVARBPROC glUniformMatrix4fv;
+PFNGLGETPROGRAMIVPROC        glGetProgramiv;
+PFNGLGETPROGRAMBINARYPROC    glGetProgramBinary;
+PFNGLPROGRAMBINARYPROC       glProgramBinary;
+PFNGLPROGRAMPARAMETERIPROC   glProgramParameteri;
+PFNGLMAXSHADERCOMPILERTHREADSKHRPROC glMaxShaderCompilerThreads;
+PFNGLGENBUFFERSPROC          glGenBuffers;
+PFNGLDELETEBUFFERSPROC       glDeleteBuffers;
+PFNGLBINDBUFFERPROC          glBindBuffer;
+PFNGLBINDBUFFERRANGEPROC     glBindBufferRange;
+PFNGLBUFFERSTORAGEPROC       glBufferStorage;
+PFNGLMAPBUFFERRANGEPROC      glMapBufferRange;
+PFNGLUNMAPBUFFERPROC         glUnmapBuffer;
+PFNGLFENCESYNCPROC           glFenceSync;
+PFNGLCLIENTWAITSYNCPROC      glClientWaitSync;
+PFNGLDELETESYNCPROC          glDeleteSync;
+PFNGLGETUNIFORMBLOCKINDEXPROC glGetUniformBlockIndex;
+PFNGLUNIFORMBLOCKBINDINGPROC glUniformBlockBinding;
+PFNGLACTIVETEXTUREPROC       glActiveTextureUnit;
+PFNGLBUFFERDATAPROC          glBufferData;
+PFNGLMAPBUFFERPROC           glMapBuffer;
+PFNGLBUFFERSUBDATAPROC       glBufferSubData;
+PFNGLGETATTRIBLOCATIONARBPROC glGetAttribLocation;
+PFNGLVERTEXATTRIBPOINTERARBPROC glVertexAttribPointer;
+PFNGLENABLEVERTEXATTRIBARRAYARBPROC glEnableVertexAttribArray;
+PFNGLDISABLEVERTEXATTRIBARRAYARBPROC glDisableVertexAttribArray;
+PFNGLVERTEXATTRIB4FVARBPROC  glVertexAttrib4fv;
+PFNGLVERTEXATTRIBDIVISORARBPROC glVertexAttribDivisor;
+PFNGLDRAWARRAYSINSTANCEDARBPROC glDrawArraysInstanced;
+PFNGLDRAWELEMENTSINSTANCEDARBPROC glDrawElementsInstanced;
+PFNGLCOMPRESSEDTEXIMAGE2DPROC glCompressedTexImage;
+PFNGLGENQUERIESPROC          glGenQueries;
+PFNGLDELETEQUERIESPROC       glDeleteQueries;
+PFNGLQUERYCOUNTERPROC        glQueryCounter;
+PFNGLGETQUERYOBJECTIVPROC    glGetQueryObjectiv;
+PFNGLGETQUERYOBJECTUI64VPROC glGetQueryObjectui64v;
+PFNGLGETINTEGER64VPROC       glGetInteger64v;
+PFNGLGENFRAMEBUFFERSPROC     glGenFramebuffers;
+PFNGLDELETEFRAMEBUFFERSPROC  glDeleteFramebuffers;
+PFNGLBINDFRAMEBUFFERPROC     glBindFramebuffer;
+PFNGLFRAMEBUFFERTEXTURE2DPROC glFramebufferTexture2D;
+PFNGLCHECKFRAMEBUFFERSTATUSPROC glCheckFramebufferStatus;
+PFNGLGENRENDERBUFFERSPROC    glGenRenderbuffers;
+PFNGLDELETERENDERBUFFERSPROC glDeleteRenderbuffers;
+PFNGLBINDRENDERBUFFERPROC    glBindRenderbuffer;
+PFNGLRENDERBUFFERSTORAGEPROC glRenderbufferStorage;
+PFNGLFRAMEBUFFERRENDERBUFFERPROC glFramebufferRenderbuffer;
+PFNGLGENVERTEXARRAYSPROC     glGenVertexArrays;
+PFNGLDELETEVERTEXARRAYSPROC  glDeleteVertexArrays;
+PFNGLBINDVERTEXARRAYPROC     glBindVertexArray;
+PFNGLCREATEBUFFERSPROC       glCreateBuffers;
+PFNGLNAMEDBUFFERSTORAGEPROC  glNamedBufferStorage;
+PFNGLNAMEDBUFFERSUBDATAPROC  glNamedBufferSubData;
+PFNGLMAPNAMEDBUFFERRANGEPROC glMapNamedBufferRange;
+PFNGLUNMAPNAMEDBUFFERPROC    glUnmapNamedBuffer;
+PFNGLCREATEVERTEXARRAYSPROC  glCreateVertexArrays;
+PFNGLCREATETEXTURESPROC      glCreateTextures;
+PFNGLTEXTURESTORAGE2DPROC    glTextureStorage2D;
+PFNGLTEXTURESUBIMAGE2DPROC   glTextureSubImage2D;
+PFNGLBINDTEXTUREUNITPROC     glBindTextureUnit;
+PFNGLMULTIDRAWARRAYSINDIRECTPROC glMultiDrawArraysIndirect;
+PFNGLMULTIDRAWELEMENTSINDIRECTPROC glMultiDrawElementsIndirect;
+
+GLCapabilities GL_CAPABILITIES;
+
+// GL 2.0 entry points behind the handle-based shader functions (core tier)
+PFNGLISPROGRAMPROC GL_CORE_IS_PROGRAM = NULL;
+PFNGLDELETESHADERPROC GL_CORE_DELETE_SHADER = NULL;
+PFNGLDELETEPROGRAMPROC GL_CORE_DELETE_PROGRAM = NULL;
+PFNGLGETSHADERIVPROC GL_CORE_GET_SHADER_IV = NULL;
+PFNGLGETPROGRAMIVPROC GL_CORE_GET_PROGRAM_IV = NULL;
+PFNGLGETSHADERINFOLOGPROC GL_CORE_GET_SHADER_INFO_LOG = NULL;
+PFNGLGETPROGRAMINFOLOGPROC GL_CORE_GET_PROGRAM_INFO_LOG = NULL;
+
+// Look up name with extension suffix appended (eg: "EXT"), or as is for ""
+static void* getSuffixedProcAddress(const char* name, const char* suffix) {
+	char full_name[64];
+
+	snprintf(full_name, sizeof(full_name), "%s%s", name, suffix);
+	return SDL_GL_GetProcAddress(full_name);
+}
+
+static void getGLVersion(int* major, int* minor) {
+	const char* version = (const char*)glGetString(GL_VERSION);
+
+	*major = 0;
+	*minor = 0;
+	if (version == NULL || sscanf(version, "%d.%d", major, minor) != 2) {
+		*major = 0;
+		*minor = 0;
+	}
+}
+
+// Check context is at least given version; promoted extensions are not always listed (eg: core profiles)
+static bool isGLVersion(int major, int minor) {
+	int context_major, context_minor;
+
+	getGLVersion(&context_major, &context_minor);
+	return context_major > major || (context_major == major && context_minor >= minor);
+}
+
+// GL 2.0 splits shader/program queries; names share one namespace so glIsProgram picks the right call
+static void APIENTRY deleteCoreObject(GLhandleARB object) {
+	if (GL_CORE_IS_PROGRAM((GLuint)(uintptr_t)object)) GL_CORE_DELETE_PROGRAM((GLuint)(uintptr_t)object);
+	else GL_CORE_DELETE_SHADER((GLuint)(uintptr_t)object);
+}
+
+static void APIENTRY getCoreObjectParameteriv(GLhandleARB object, GLenum pname, GLint* params) {
+	if (GL_CORE_IS_PROGRAM((GLuint)(uintptr_t)object)) GL_CORE_GET_PROGRAM_IV((GLuint)(uintptr_t)object, pname, params);
+	else GL_CORE_GET_SHADER_IV((GLuint)(uintptr_t)object, pname, params);
+}
+
+static void APIENTRY getCoreInfoLog(GLhandleARB object, GLsizei max_length, GLsizei* length, GLcharARB* info_log) {
+	if (GL_CORE_IS_PROGRAM((GLuint)(uintptr_t)object)) GL_CORE_GET_PROGRAM_INFO_LOG((GLuint)(uintptr_t)object, max_length, length, info_log);
+	else GL_CORE_GET_SHADER_INFO_LOG((GLuint)(uintptr_t)object, max_length, length, info_log);
+}
 
 bool createMissingGlShaderFunctions() {
-	// Build missing GL shader functions (add new ones here) and check if supported
+	// Prefer GL 2.0 core (the only shader functions on core profiles), else GL_ARB_shader_objects
+	return createCoreShaderFunctions() || createShaderObjectFunctions();
+}
+
+bool createCoreShaderFunctions() {
+	// Build shader functions from GL 2.0 core; GLhandleARB must be a GLuint (not on Apple)
+	if (!isGLVersion(2, 0) || sizeof(GLhandleARB) != sizeof(GLuint)) return false;
+
+	GL_CORE_IS_PROGRAM = (PFNGLISPROGRAMPROC)SDL_GL_GetProcAddress("glIsProgram");
+	GL_CORE_DELETE_SHADER = (PFNGLDELETESHADERPROC)SDL_GL_GetProcAddress("glDeleteShader");
+	GL_CORE_DELETE_PROGRAM = (PFNGLDELETEPROGRAMPROC)SDL_GL_GetProcAddress("glDeleteProgram");
+	GL_CORE_GET_SHADER_IV = (PFNGLGETSHADERIVPROC)SDL_GL_GetProcAddress("glGetShaderiv");
+	GL_CORE_GET_PROGRAM_IV = (PFNGLGETPROGRAMIVPROC)SDL_GL_GetProcAddress("glGetProgramiv");
+	GL_CORE_GET_SHADER_INFO_LOG = (PFNGLGETSHADERINFOLOGPROC)SDL_GL_GetProcAddress("glGetShaderInfoLog");
+	GL_CORE_GET_PROGRAM_INFO_LOG = (PFNGLGETPROGRAMINFOLOGPROC)SDL_GL_GetProcAddress("glGetProgramInfoLog");
+	if (!GL_CORE_IS_PROGRAM ||
+		!GL_CORE_DELETE_SHADER ||
+		!GL_CORE_DELETE_PROGRAM ||
+		!GL_CORE_GET_SHADER_IV ||
+		!GL_CORE_GET_PROGRAM_IV ||
+		!GL_CORE_GET_SHADER_INFO_LOG ||
+		!GL_CORE_GET_PROGRAM_INFO_LOG) {
+		return false;
+	}
+
+	glAttachObject = (PFNGLATTACHOBJECTARBPROC)SDL_GL_GetProcAddress("glAttachShader");
+	glCompileShader = (PFNGLCOMPILESHADERARBPROC)SDL_GL_GetProcAddress("glCompileShader");
+	glCreateProgramObject = (PFNGLCREATEPROGRAMOBJECTARBPROC)SDL_GL_GetProcAddress("glCreateProgram");
+	glCreateShaderObject = (PFNGLCREATESHADEROBJECTARBPROC)SDL_GL_GetProcAddress("glCreateShader");
+	glDeleteObject = deleteCoreObject;
+	glGetShaderInfoLog = getCoreInfoLog;
+	glGetObjectParameteriv = getCoreObjectParameteriv;
+	glGetUniformLocation = (PFNGLGETUNIFORMLOCATIONARBPROC)SDL_GL_GetProcAddress("glGetUniformLocation");
+	glGetActiveUniform = (PFNGLGETACTIVEUNIFORMARBPROC)SDL_GL_GetProcAddress("glGetActiveUniform");
+	glLinkProgram = (PFNGLLINKPROGRAMARBPROC)SDL_GL_GetProcAddress("glLinkProgram");
+	glShaderSource = (PFNGLSHADERSOURCEARBPROC)SDL_GL_GetProcAddress("glShaderSource");
+	glUseProgramObject = (PFNGLUSEPROGRAMOBJECTARBPROC)SDL_GL_GetProcAddress("glUseProgram");
+	glUniform1i   = (PFNGLUNIFORM1IARBPROC)SDL_GL_GetProcAddress("glUniform1i");
+	glUniform2i   = (PFNGLUNIFORM2IARBPROC)SDL_GL_GetProcAddress("glUniform2i");
+	glUniform3i   = (PFNGLUNIFORM3IARBPROC)SDL_GL_GetProcAddress("glUniform3i");
+	glUniform4i   = (PFNGLUNIFORM4IARBPROC)SDL_GL_GetProcAddress("glUniform4i");
+	glUniform1f   = (PFNGLUNIFORM1FARBPROC)SDL_GL_GetProcAddress("glUniform1f");
+	glUniform2f   = (PFNGLUNIFORM2FARBPROC)SDL_GL_GetProcAddress("glUniform2f");
+	glUniform3f   = (PFNGLUNIFORM3FARBPROC)SDL_GL_GetProcAddress("glUniform3f");
+	glUniform4f   = (PFNGLUNIFORM4FARBPROC)SDL_GL_GetProcAddress("glUniform4f");
+	glUniformMatrix4fv = (PFNGLUNIFORMMATRIX4FVARBPROC)SDL_GL_GetProcAddress("glUniformMatrix4fv");
+
+	return glAttachObject &&
+		glCompileShader &&
+		glCreateProgramObject &&
+		glCreateShaderObject &&
+		glGetUniformLocation &&
+		glGetActiveUniform &&
+		glLinkProgram &&
+		glShaderSource &&
+		glUseProgramObject &&
+		glUniform1i &&
+		glUniform2i &&
+		glUniform3i &&
+		glUniform4i &&
+		glUniform1f &&
+		glUniform2f &&
+		glUniform3f &&
+		glUniform4f &&
+		glUniformMatrix4fv;
+}
+
+bool createShaderObjectFunctions() {
+	// Build shader functions from GL_ARB_shader_objects (handle-based, GL 1.x era)
 	if (SDL_GL_ExtensionSupported("GL_ARB_shader_objects") &&
 		SDL_GL_ExtensionSupported("GL_ARB_shading_language_100") &&
 		SDL_GL_ExtensionSupported("GL_ARB_vertex_shader") &&
@@ -47,6 +235,7 @@ bool createMissingGlShaderFunctions() {
 		glGetShaderInfoLog = (PFNGLGETINFOLOGARBPROC)SDL_GL_GetProcAddress("glGetInfoLogARB");
 		glGetObjectParameteriv = (PFNGLGETOBJECTPARAMETERIVARBPROC)SDL_GL_GetProcAddress("glGetObjectParameterivARB");
 		glGetUniformLocation = (PFNGLGETUNIFORMLOCATIONARBPROC)SDL_GL_GetProcAddress("glGetUniformLocationARB");
+		glGetActiveUniform = (PFNGLGETACTIVEUNIFORMARBPROC)SDL_GL_GetProcAddress("glGetActiveUniformARB");
 		glLinkProgram = (PFNGLLINKPROGRAMARBPROC)SDL_GL_GetProcAddress("glLinkProgramARB");
 		glShaderSource = (PFNGLSHADERSOURCEARBPROC)SDL_GL_GetProcAddress("glShaderSourceARB");
 		glUseProgramObject = (PFNGLUSEPROGRAMOBJECTARBPROC)SDL_GL_GetProcAddress("glUseProgramObjectARB");
@@ -54,18 +243,11 @@ bool createMissingGlShaderFunctions() {
 		glUniform2i   = (PFNGLUNIFORM2IARBPROC)SDL_GL_GetProcAddress("glUniform2iARB");
 		glUniform3i   = (PFNGLUNIFORM3IARBPROC)SDL_GL_GetProcAddress("glUniform3iARB");
 		glUniform4i   = (PFNGLUNIFORM4IARBPROC)SDL_GL_GetProcAddress("glUniform4iARB");
-		glUniform1i64 = (PFNGLUNIFORM1I64ARBPROC)SDL_GL_GetProcAddress("glUniform1i64ARB");
-		glUniform2i64 = (PFNGLUNIFORM2I64ARBPROC)SDL_GL_GetProcAddress("glUniform2i64ARB");
-		glUniform3i64 = (PFNGLUNIFORM3I64ARBPROC)SDL_GL_GetProcAddress("glUniform3i64ARB");
-		glUniform4i64 = (PFNGLUNIFORM4I64ARBPROC)SDL_GL_GetProcAddress("glUniform4i64ARB");
 		glUniform1f   = (PFNGLUNIFORM1FARBPROC)SDL_GL_GetProcAddress("glUniform1fARB");
 		glUniform2f   = (PFNGLUNIFORM2FARBPROC)SDL_GL_GetProcAddress("glUniform2fARB");
 		glUniform3f   = (PFNGLUNIFORM3FARBPROC)SDL_GL_GetProcAddress("glUniform3fARB");
 		glUniform4f   = (PFNGLUNIFORM4FARBPROC)SDL_GL_GetProcAddress("glUniform4fARB");
-		glUniform1d  = (PFNGLUNIFORM1DPROC)SDL_GL_GetProcAddress("glUniform1d");
-		glUniform2d  = (PFNGLUNIFORM2DPROC)SDL_GL_GetProcAddress("glUniform2d");
-		glUniform3d  = (PFNGLUNIFORM3DPROC)SDL_GL_GetProcAddress("glUniform3d");
-		glUniform4d  = (PFNGLUNIFORM4DPROC)SDL_GL_GetProcAddress("glUniform4d");
+		glUniformMatrix4fv = (PFNGLUNIFORMMATRIX4FVARBPROC)SDL_GL_GetProcAddress("glUniformMatrix4fvARB");
 		if (glAttachObject &&
 			glCompileShader &&
 			glCreateProgramObject &&
@@ -74,6 +256,7 @@ bool createMissingGlShaderFunctions() {
 			glGetShaderInfoLog &&
 			glGetObjectParameteriv &&
 			glGetUniformLocation &&
+			glGetActiveUniform &&
 			glLinkProgram &&
 			glShaderSource &&
 			glUseProgramObject &&
@@ -81,21 +264,355 @@ bool createMissingGlShaderFunctions() {
 			glUniform2i &&
 			glUniform3i &&
 			glUniform4i &&
-			glUniform1i64 &&
-			glUniform2i64 &&
-			glUniform3i64 &&
-			glUniform4i64 &&
 			glUniform1f &&
 			glUniform2f &&
 			glUniform3f &&
 			glUniform4f &&
-			glUniform1d &&
-			glUniform2d &&
-			glUniform3d &&
-			glUniform4d) {
+			glUniformMatrix4fv) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool createUniformInt64Functions() {
+	// Build 64-bit integer uniforms (optional; GL_ARB_gpu_shader_int64, missing on most drivers)
+	if (!SDL_GL_ExtensionSupported("GL_ARB_gpu_shader_int64")) return false;
+
+	glUniform1i64 = (PFNGLUNIFORM1I64ARBPROC)SDL_GL_GetProcAddress("glUniform1i64ARB");
+	glUniform2i64 = (PFNGLUNIFORM2I64ARBPROC)SDL_GL_GetProcAddress("glUniform2i64ARB");
+	glUniform3i64 = (PFNGLUNIFORM3I64ARBPROC)SDL_GL_GetProcAddress("glUniform3i64ARB");
+	glUniform4i64 = (PFNGLUNIFORM4I64ARBPROC)SDL_GL_GetProcAddress("glUniform4i64ARB");
+
+	return glUniform1i64 &&
+		glUniform2i64 &&
+		glUniform3i64 &&
+		glUniform4i64;
+}
+
+bool createUniformDoubleFunctions() {
+	// Build double precision uniforms (optional; GL 4.0 core or GL_ARB_gpu_shader_fp64)
+	if (!isGLVersion(4, 0) && !SDL_GL_ExtensionSupported("GL_ARB_gpu_shader_fp64")) return false;
+
+	glUniform1d = (PFNGLUNIFORM1DPROC)SDL_GL_GetProcAddress("glUniform1d");
+	glUniform2d = (PFNGLUNIFORM2DPROC)SDL_GL_GetProcAddress("glUniform2d");
+	glUniform3d = (PFNGLUNIFORM3DPROC)SDL_GL_GetProcAddress("glUniform3d");
+	glUniform4d = (PFNGLUNIFORM4DPROC)SDL_GL_GetProcAddress("glUniform4d");
+
+	return glUniform1d &&
+		glUniform2d &&
+		glUniform3d &&
+		glUniform4d;
+}
+
+bool createProgramBinaryFunctions() {
+	// Build program binary functions (optional; GL 4.1 core or GL_ARB_get_program_binary, used by shader binary cache)
+	if (isGLVersion(4, 1) || SDL_GL_ExtensionSupported("GL_ARB_get_program_binary")) {
+		glGetProgramiv = (PFNGLGETPROGRAMIVPROC)SDL_GL_GetProcAddress("glGetProgramiv");
+		glGetProgramBinary = (PFNGLGETPROGRAMBINARYPROC)SDL_GL_GetProcAddress("glGetProgramBinary");
+		glProgramBinary = (PFNGLPROGRAMBINARYPROC)SDL_GL_GetProcAddress("glProgramBinary");
+		glProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC)SDL_GL_GetProcAddress("glProgramParameteri");
+		if (glGetProgramiv &&
+			glGetProgramBinary &&
+			glProgramBinary &&
+			glProgramParameteri) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool createParallelShaderCompileFunctions() {
+	// Build parallel shader compile functions (optional; KHR preferred over ARB, completion polled with GL 2.0 glGetProgramiv)
+	glMaxShaderCompilerThreads = NULL;
+	if (!isGLVersion(2, 0)) return false;
+	if (!SDL_GL_ExtensionSupported("GL_KHR_parallel_shader_compile") && !SDL_GL_ExtensionSupported("GL_ARB_parallel_shader_compile")) return false;
+
+	glGetProgramiv = (PFNGLGETPROGRAMIVPROC)SDL_GL_GetProcAddress("glGetProgramiv");
+	if (SDL_GL_ExtensionSupported("GL_KHR_parallel_shader_compile")) {
+		glMaxShaderCompilerThreads = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)SDL_GL_GetProcAddress("glMaxShaderCompilerThreadsKHR");
+	} else if (SDL_GL_ExtensionSupported("GL_ARB_parallel_shader_compile")) {
+		glMaxShaderCompilerThreads = (PFNGLMAXSHADERCOMPILERTHREADSARBPROC)SDL_GL_GetProcAddress("glMaxShaderCompilerThreadsARB");
+	}
+
+	return glGetProgramiv && glMaxShaderCompilerThreads;
+}
+
+bool createUniformBufferFunctions() {
+	// Build uniform buffer functions (optional; GL 3.1 core or GL_ARB_uniform_buffer_object, persistent mapping needs buffer storage and sync)
+	if (!isGLVersion(3, 1) && !SDL_GL_ExtensionSupported("GL_ARB_uniform_buffer_object")) return false;
+	if (!createBufferStorageFunctions() || !createSyncFunctions()) return false;
+
+	glBindBufferRange = (PFNGLBINDBUFFERRANGEPROC)SDL_GL_GetProcAddress("glBindBufferRange");
+	glGetUniformBlockIndex = (PFNGLGETUNIFORMBLOCKINDEXPROC)SDL_GL_GetProcAddress("glGetUniformBlockIndex");
+	glUniformBlockBinding = (PFNGLUNIFORMBLOCKBINDINGPROC)SDL_GL_GetProcAddress("glUniformBlockBinding");
+
+	return glBindBufferRange &&
+		glGetUniformBlockIndex &&
+		glUniformBlockBinding;
+}
+
+bool createMultitextureFunctions() {
+	// Build texture unit selection (GL 1.3 core or GL_ARB_multitexture; not exported on all platforms)
+	glActiveTextureUnit = (PFNGLACTIVETEXTUREPROC)SDL_GL_GetProcAddress("glActiveTexture");
+	if (glActiveTextureUnit == NULL && SDL_GL_ExtensionSupported("GL_ARB_multitexture")) {
+		glActiveTextureUnit = (PFNGLACTIVETEXTUREPROC)SDL_GL_GetProcAddress("glActiveTextureARB");
+	}
+
+	return glActiveTextureUnit != NULL;
+}
+
+bool createPixelBufferFunctions() {
+	// Build pixel buffer object functions (optional; GL 2.1 core or GL_ARB_pixel_buffer_object, used for streaming texture uploads)
+	if (isGLVersion(2, 1) || SDL_GL_ExtensionSupported("GL_ARB_pixel_buffer_object")) {
+		glGenBuffers = (PFNGLGENBUFFERSPROC)SDL_GL_GetProcAddress("glGenBuffers");
+		glDeleteBuffers = (PFNGLDELETEBUFFERSPROC)SDL_GL_GetProcAddress("glDeleteBuffers");
+		glBindBuffer = (PFNGLBINDBUFFERPROC)SDL_GL_GetProcAddress("glBindBuffer");
+		glBufferData = (PFNGLBUFFERDATAPROC)SDL_GL_GetProcAddress("glBufferData");
+		glMapBuffer = (PFNGLMAPBUFFERPROC)SDL_GL_GetProcAddress("glMapBuffer");
+		glUnmapBuffer = (PFNGLUNMAPBUFFERPROC)SDL_GL_GetProcAddress("glUnmapBuffer");
+		if (glGenBuffers &&
+			glDeleteBuffers &&
+			glBindBuffer &&
+			glBufferData &&
+			glMapBuffer &&
+			glUnmapBuffer) {
 			return true;
 		}
 	}
 
 	return false;
-}
\ No newline at end of file
+}
+
+bool createCompressedTextureFunctions() {
+	// Build compressed texture upload (GL 1.3 core or GL_ARB_texture_compression; S3TC formats are an extension everywhere)
+	if (!SDL_GL_ExtensionSupported("GL_EXT_texture_compression_s3tc")) return false;
+
+	glCompressedTexImage = (PFNGLCOMPRESSEDTEXIMAGE2DPROC)SDL_GL_GetProcAddress("glCompressedTexImage2D");
+	if (glCompressedTexImage == NULL && SDL_GL_ExtensionSupported("GL_ARB_texture_compression")) {
+		glCompressedTexImage = (PFNGLCOMPRESSEDTEXIMAGE2DPROC)SDL_GL_GetProcAddress("glCompressedTexImage2DARB");
+	}
+
+	return glCompressedTexImage != NULL;
+}
+
+bool createVertexBufferFunctions() {
+	// Build vertex buffer object functions (GL 1.5 core or GL_ARB_vertex_buffer_object)
+	if (!isGLVersion(1, 5) && !SDL_GL_ExtensionSupported("GL_ARB_vertex_buffer_object")) return false;
+
+	glGenBuffers = (PFNGLGENBUFFERSPROC)SDL_GL_GetProcAddress("glGenBuffers");
+	glDeleteBuffers = (PFNGLDELETEBUFFERSPROC)SDL_GL_GetProcAddress("glDeleteBuffers");
+	glBindBuffer = (PFNGLBINDBUFFERPROC)SDL_GL_GetProcAddress("glBindBuffer");
+	glBufferData = (PFNGLBUFFERDATAPROC)SDL_GL_GetProcAddress("glBufferData");
+	glBufferSubData = (PFNGLBUFFERSUBDATAPROC)SDL_GL_GetProcAddress("glBufferSubData");
+
+	// Optional unsynchronized range mapping for streaming
+	if (isGLVersion(3, 0) || SDL_GL_ExtensionSupported("GL_ARB_map_buffer_range")) {
+		glMapBufferRange = (PFNGLMAPBUFFERRANGEPROC)SDL_GL_GetProcAddress("glMapBufferRange");
+		glUnmapBuffer = (PFNGLUNMAPBUFFERPROC)SDL_GL_GetProcAddress("glUnmapBuffer");
+	}
+
+	return glGenBuffers &&
+		glDeleteBuffers &&
+		glBindBuffer &&
+		glBufferData &&
+		glBufferSubData;
+}
+
+bool createVertexAttribFunctions() {
+	// Build generic vertex attribute functions (GL 2.0 core or GL_ARB_vertex_shader; used for per-instance data)
+	const char* suffix;
+
+	if (isGLVersion(2, 0)) suffix = "";
+	else if (SDL_GL_ExtensionSupported("GL_ARB_vertex_shader")) suffix = "ARB";
+	else return false;
+
+	glGetAttribLocation = (PFNGLGETATTRIBLOCATIONARBPROC)getSuffixedProcAddress("glGetAttribLocation", suffix);
+	glVertexAttribPointer = (PFNGLVERTEXATTRIBPOINTERARBPROC)getSuffixedProcAddress("glVertexAttribPointer", suffix);
+	glEnableVertexAttribArray = (PFNGLENABLEVERTEXATTRIBARRAYARBPROC)getSuffixedProcAddress("glEnableVertexAttribArray", suffix);
+	glDisableVertexAttribArray = (PFNGLDISABLEVERTEXATTRIBARRAYARBPROC)getSuffixedProcAddress("glDisableVertexAttribArray", suffix);
+	glVertexAttrib4fv = (PFNGLVERTEXATTRIB4FVARBPROC)getSuffixedProcAddress("glVertexAttrib4fv", suffix);
+
+	return glGetAttribLocation &&
+		glVertexAttribPointer &&
+		glEnableVertexAttribArray &&
+		glDisableVertexAttribArray &&
+		glVertexAttrib4fv;
+}
+
+bool createInstancedArrayFunctions() {
+	// Build instanced drawing (GL 3.3 core or GL_ARB_instanced_arrays + GL_ARB_draw_instanced)
+	if (!isGLVersion(3, 3) &&
+		(!SDL_GL_ExtensionSupported("GL_ARB_instanced_arrays") || !SDL_GL_ExtensionSupported("GL_ARB_draw_instanced"))) {
+		return false;
+	}
+
+	glVertexAttribDivisor = (PFNGLVERTEXATTRIBDIVISORARBPROC)SDL_GL_GetProcAddress("glVertexAttribDivisor");
+	if (glVertexAttribDivisor == NULL) glVertexAttribDivisor = (PFNGLVERTEXATTRIBDIVISORARBPROC)SDL_GL_GetProcAddress("glVertexAttribDivisorARB");
+	glDrawArraysInstanced = (PFNGLDRAWARRAYSINSTANCEDARBPROC)SDL_GL_GetProcAddress("glDrawArraysInstanced");
+	if (glDrawArraysInstanced == NULL) glDrawArraysInstanced = (PFNGLDRAWARRAYSINSTANCEDARBPROC)SDL_GL_GetProcAddress("glDrawArraysInstancedARB");
+	glDrawElementsInstanced = (PFNGLDRAWELEMENTSINSTANCEDARBPROC)SDL_GL_GetProcAddress("glDrawElementsInstanced");
+	if (glDrawElementsInstanced == NULL) glDrawElementsInstanced = (PFNGLDRAWELEMENTSINSTANCEDARBPROC)SDL_GL_GetProcAddress("glDrawElementsInstancedARB");
+
+	return glVertexAttribDivisor &&
+		glDrawArraysInstanced &&
+		glDrawElementsInstanced;
+}
+
+bool createTimerQueryFunctions() {
+	// Build GPU timestamp queries (GL 3.3 core or GL_ARB_timer_query)
+	if (!isGLVersion(3, 3) && !SDL_GL_ExtensionSupported("GL_ARB_timer_query")) return false;
+
+	glGenQueries = (PFNGLGENQUERIESPROC)SDL_GL_GetProcAddress("glGenQueries");
+	if (glGenQueries == NULL) glGenQueries = (PFNGLGENQUERIESPROC)SDL_GL_GetProcAddress("glGenQueriesARB");
+	glDeleteQueries = (PFNGLDELETEQUERIESPROC)SDL_GL_GetProcAddress("glDeleteQueries");
+	if (glDeleteQueries == NULL) glDeleteQueries = (PFNGLDELETEQUERIESPROC)SDL_GL_GetProcAddress("glDeleteQueriesARB");
+	glGetQueryObjectiv = (PFNGLGETQUERYOBJECTIVPROC)SDL_GL_GetProcAddress("glGetQueryObjectiv");
+	if (glGetQueryObjectiv == NULL) glGetQueryObjectiv = (PFNGLGETQUERYOBJECTIVPROC)SDL_GL_GetProcAddress("glGetQueryObjectivARB");
+	glQueryCounter = (PFNGLQUERYCOUNTERPROC)SDL_GL_GetProcAddress("glQueryCounter");
+	glGetQueryObjectui64v = (PFNGLGETQUERYOBJECTUI64VPROC)SDL_GL_GetProcAddress("glGetQueryObjectui64v");
+
+	// Optional; only used to align GPU and CPU clocks
+	glGetInteger64v = (PFNGLGETINTEGER64VPROC)SDL_GL_GetProcAddress("glGetInteger64v");
+
+	return glGenQueries &&
+		glDeleteQueries &&
+		glGetQueryObjectiv &&
+		glQueryCounter &&
+		glGetQueryObjectui64v;
+}
+
+bool createFramebufferFunctions() {
+	// Build framebuffer objects (GL 3.0 core or GL_ARB_framebuffer_object, else GL_EXT_framebuffer_object; same enums)
+	const char* suffix;
+
+	if (isGLVersion(3, 0) || SDL_GL_ExtensionSupported("GL_ARB_framebuffer_object")) suffix = "";
+	else if (SDL_GL_ExtensionSupported("GL_EXT_framebuffer_object")) suffix = "EXT";
+	else return false;
+
+	glGenFramebuffers = (PFNGLGENFRAMEBUFFERSPROC)getSuffixedProcAddress("glGenFramebuffers", suffix);
+	glDeleteFramebuffers = (PFNGLDELETEFRAMEBUFFERSPROC)getSuffixedProcAddress("glDeleteFramebuffers", suffix);
+	glBindFramebuffer = (PFNGLBINDFRAMEBUFFERPROC)getSuffixedProcAddress("glBindFramebuffer", suffix);
+	glFramebufferTexture2D = (PFNGLFRAMEBUFFERTEXTURE2DPROC)getSuffixedProcAddress("glFramebufferTexture2D", suffix);
+	glCheckFramebufferStatus = (PFNGLCHECKFRAMEBUFFERSTATUSPROC)getSuffixedProcAddress("glCheckFramebufferStatus", suffix);
+	glGenRenderbuffers = (PFNGLGENRENDERBUFFERSPROC)getSuffixedProcAddress("glGenRenderbuffers", suffix);
+	glDeleteRenderbuffers = (PFNGLDELETERENDERBUFFERSPROC)getSuffixedProcAddress("glDeleteRenderbuffers", suffix);
+	glBindRenderbuffer = (PFNGLBINDRENDERBUFFERPROC)getSuffixedProcAddress("glBindRenderbuffer", suffix);
+	glRenderbufferStorage = (PFNGLRENDERBUFFERSTORAGEPROC)getSuffixedProcAddress("glRenderbufferStorage", suffix);
+	glFramebufferRenderbuffer = (PFNGLFRAMEBUFFERRENDERBUFFERPROC)getSuffixedProcAddress("glFramebufferRenderbuffer", suffix);
+
+	return glGenFramebuffers &&
+		glDeleteFramebuffers &&
+		glBindFramebuffer &&
+		glFramebufferTexture2D &&
+		glCheckFramebufferStatus &&
+		glGenRenderbuffers &&
+		glDeleteRenderbuffers &&
+		glBindRenderbuffer &&
+		glRenderbufferStorage &&
+		glFramebufferRenderbuffer;
+}
+
+bool createSyncFunctions() {
+	// Build fence functions (GL 3.2 core or GL_ARB_sync)
+	if (!isGLVersion(3, 2) && !SDL_GL_ExtensionSupported("GL_ARB_sync")) return false;
+
+	glFenceSync = (PFNGLFENCESYNCPROC)SDL_GL_GetProcAddress("glFenceSync");
+	glClientWaitSync = (PFNGLCLIENTWAITSYNCPROC)SDL_GL_GetProcAddress("glClientWaitSync");
+	glDeleteSync = (PFNGLDELETESYNCPROC)SDL_GL_GetProcAddress("glDeleteSync");
+
+	return glFenceSync &&
+		glClientWaitSync &&
+		glDeleteSync;
+}
+
+bool createVertexArrayFunctions() {
+	// Build vertex array objects (GL 3.0 core or GL_ARB_vertex_array_object; required to draw on core profiles)
+	if (!isGLVersion(3, 0) && !SDL_GL_ExtensionSupported("GL_ARB_vertex_array_object")) return false;
+
+	glGenVertexArrays = (PFNGLGENVERTEXARRAYSPROC)SDL_GL_GetProcAddress("glGenVertexArrays");
+	glDeleteVertexArrays = (PFNGLDELETEVERTEXARRAYSPROC)SDL_GL_GetProcAddress("glDeleteVertexArrays");
+	glBindVertexArray = (PFNGLBINDVERTEXARRAYPROC)SDL_GL_GetProcAddress("glBindVertexArray");
+
+	return glGenVertexArrays &&
+		glDeleteVertexArrays &&
+		glBindVertexArray;
+}
+
+bool createDirectStateAccessFunctions() {
+	// Build direct state access (GL 4.5 core or GL_ARB_direct_state_access; edits objects without binding them)
+	if (!isGLVersion(4, 5) && !SDL_GL_ExtensionSupported("GL_ARB_direct_state_access")) return false;
+
+	glCreateBuffers = (PFNGLCREATEBUFFERSPROC)SDL_GL_GetProcAddress("glCreateBuffers");
+	glNamedBufferStorage = (PFNGLNAMEDBUFFERSTORAGEPROC)SDL_GL_GetProcAddress("glNamedBufferStorage");
+	glNamedBufferSubData = (PFNGLNAMEDBUFFERSUBDATAPROC)SDL_GL_GetProcAddress("glNamedBufferSubData");
+	glMapNamedBufferRange = (PFNGLMAPNAMEDBUFFERRANGEPROC)SDL_GL_GetProcAddress("glMapNamedBufferRange");
+	glUnmapNamedBuffer = (PFNGLUNMAPNAMEDBUFFERPROC)SDL_GL_GetProcAddress("glUnmapNamedBuffer");
+	glCreateVertexArrays = (PFNGLCREATEVERTEXARRAYSPROC)SDL_GL_GetProcAddress("glCreateVertexArrays");
+	glCreateTextures = (PFNGLCREATETEXTURESPROC)SDL_GL_GetProcAddress("glCreateTextures");
+	glTextureStorage2D = (PFNGLTEXTURESTORAGE2DPROC)SDL_GL_GetProcAddress("glTextureStorage2D");
+	glTextureSubImage2D = (PFNGLTEXTURESUBIMAGE2DPROC)SDL_GL_GetProcAddress("glTextureSubImage2D");
+	glBindTextureUnit = (PFNGLBINDTEXTUREUNITPROC)SDL_GL_GetProcAddress("glBindTextureUnit");
+
+	return glCreateBuffers &&
+		glNamedBufferStorage &&
+		glNamedBufferSubData &&
+		glMapNamedBufferRange &&
+		glUnmapNamedBuffer &&
+		glCreateVertexArrays &&
+		glCreateTextures &&
+		glTextureStorage2D &&
+		glTextureSubImage2D &&
+		glBindTextureUnit;
+}
+
+bool createBufferStorageFunctions() {
+	// Build immutable buffer storage (GL 4.4 core or GL_ARB_buffer_storage; persistent and coherent mapping)
+	if (!isGLVersion(4, 4) && !SDL_GL_ExtensionSupported("GL_ARB_buffer_storage")) return false;
+
+	glGenBuffers = (PFNGLGENBUFFERSPROC)SDL_GL_GetProcAddress("glGenBuffers");
+	glDeleteBuffers = (PFNGLDELETEBUFFERSPROC)SDL_GL_GetProcAddress("glDeleteBuffers");
+	glBindBuffer = (PFNGLBINDBUFFERPROC)SDL_GL_GetProcAddress("glBindBuffer");
+	glBufferStorage = (PFNGLBUFFERSTORAGEPROC)SDL_GL_GetProcAddress("glBufferStorage");
+	glMapBufferRange = (PFNGLMAPBUFFERRANGEPROC)SDL_GL_GetProcAddress("glMapBufferRange");
+	glUnmapBuffer = (PFNGLUNMAPBUFFERPROC)SDL_GL_GetProcAddress("glUnmapBuffer");
+
+	return glGenBuffers &&
+		glDeleteBuffers &&
+		glBindBuffer &&
+		glBufferStorage &&
+		glMapBufferRange &&
+		glUnmapBuffer;
+}
+
+bool createMultiDrawIndirectFunctions() {
+	// Build multi-draw indirect (GL 4.3 core or GL_ARB_multi_draw_indirect; draw commands read from GL_DRAW_INDIRECT_BUFFER)
+	if (!isGLVersion(4, 3) && !SDL_GL_ExtensionSupported("GL_ARB_multi_draw_indirect")) return false;
+
+	glMultiDrawArraysIndirect = (PFNGLMULTIDRAWARRAYSINDIRECTPROC)SDL_GL_GetProcAddress("glMultiDrawArraysIndirect");
+	glMultiDrawElementsIndirect = (PFNGLMULTIDRAWELEMENTSINDIRECTPROC)SDL_GL_GetProcAddress("glMultiDrawElementsIndirect");
+
+	return glMultiDrawArraysIndirect &&
+		glMultiDrawElementsIndirect;
+}
+
+GLCapabilities createGLFunctions() {
+	memset(&GL_CAPABILITIES, 0, sizeof(GLCapabilities));
+	getGLVersion(&GL_CAPABILITIES.major, &GL_CAPABILITIES.minor);
+
+	// Shader tiers share function pointers, so the ARB table only loads without GL 2.0
+	GL_CAPABILITIES.core_20 = createCoreShaderFunctions();
+	if (!GL_CAPABILITIES.core_20) GL_CAPABILITIES.shader_objects = createShaderObjectFunctions();
+
+	// Every other tier stands alone
+	GL_CAPABILITIES.core_33 = isGLVersion(3, 3) && createVertexArrayFunctions();
+	GL_CAPABILITIES.dsa = createDirectStateAccessFunctions();
+	GL_CAPABILITIES.buffer_storage = createBufferStorageFunctions();
+	GL_CAPABILITIES.multi_draw_indirect = createMultiDrawIndirectFunctions();
+	GL_CAPABILITIES.uniform_int64 = (GL_CAPABILITIES.core_20 || GL_CAPABILITIES.shader_objects) && createUniformInt64Functions();
+	GL_CAPABILITIES.uniform_double = (GL_CAPABILITIES.core_20 || GL_CAPABILITIES.shader_objects) && createUniformDoubleFunctions();
+
+	return GL_CAPABILITIES;
+}
@@ -15,6 +15,7 @@ extern PFNGLDELETEOBJECTARBPROC glDeleteObject;
 extern PFNGLGETINFOLOGARBPROC glGetShaderInfoLog;
 extern PFNGLGETOBJECTPARAMETERIVARBPROC glGetObjectParameteriv;
 extern PFNGLGETUNIFORMLOCATIONARBPROC glGetUniformLocation;
+extern PFNGLGETACTIVEUNIFORMARBPROC glGetActiveUniform;
 extern PFNGLLINKPROGRAMARBPROC glLinkProgram;
 extern PFNGLSHADERSOURCEARBPROC glShaderSource;
 extern PFNGLUSEPROGRAMOBJECTARBPROC glUseProgramObject;
@@ -34,8 +35,117 @@ extern PFNGLUNIFORM1DPROC      glUniform1d;
 extern PFNGLUNIFORM2DPROC      glUniform2d;
 extern PFNGLUNIFORM3DPROC      glUniform3d;
 extern PFNGLUNIFORM4DPROC      glUniform4d;
+extern PFNGLUNIFORMMATRIX4FVARBPROC glUniformMatrix4fv;
+extern PFNGLGETPROGRAMIVPROC        glGetProgramiv;
+extern PFNGLGETPROGRAMBINARYPROC    glGetProgramBinary;
+extern PFNGLPROGRAMBINARYPROC       glProgramBinary;
+extern PFNGLPROGRAMPARAMETERIPROC   glProgramParameteri;
+extern PFNGLMAXSHADERCOMPILERTHREADSKHRPROC glMaxShaderCompilerThreads;
+extern PFNGLGENBUFFERSPROC          glGenBuffers;
+extern PFNGLDELETEBUFFERSPROC       glDeleteBuffers;
+extern PFNGLBINDBUFFERPROC          glBindBuffer;
+extern PFNGLBINDBUFFERRANGEPROC     glBindBufferRange;
+extern PFNGLBUFFERSTORAGEPROC       glBufferStorage;
+extern PFNGLMAPBUFFERRANGEPROC      glMapBufferRange;
+extern PFNGLUNMAPBUFFERPROC         glUnmapBuffer;
+extern PFNGLFENCESYNCPROC           glFenceSync;
+extern PFNGLCLIENTWAITSYNCPROC      glClientWaitSync;
+extern PFNGLDELETESYNCPROC          glDeleteSync;
+extern PFNGLGETUNIFORMBLOCKINDEXPROC glGetUniformBlockIndex;
+extern PFNGLUNIFORMBLOCKBINDINGPROC glUniformBlockBinding;
+extern PFNGLACTIVETEXTUREPROC       glActiveTextureUnit;
+extern PFNGLBUFFERDATAPROC          glBufferData;
+extern PFNGLMAPBUFFERPROC           glMapBuffer;
+extern PFNGLBUFFERSUBDATAPROC       glBufferSubData;
+extern PFNGLGETATTRIBLOCATIONARBPROC glGetAttribLocation;
+extern PFNGLVERTEXATTRIBPOINTERARBPROC glVertexAttribPointer;
+extern PFNGLENABLEVERTEXATTRIBARRAYARBPROC glEnableVertexAttribArray;
+extern PFNGLDISABLEVERTEXATTRIBARRAYARBPROC glDisableVertexAttribArray;
+extern PFNGLVERTEXATTRIB4FVARBPROC  glVertexAttrib4fv;
+extern PFNGLVERTEXATTRIBDIVISORARBPROC glVertexAttribDivisor;
+extern PFNGLDRAWARRAYSINSTANCEDARBPROC glDrawArraysInstanced;
+extern PFNGLDRAWELEMENTSINSTANCEDARBPROC glDrawElementsInstanced;
+extern PFNGLCOMPRESSEDTEXIMAGE2DPROC glCompressedTexImage;
+extern PFNGLGENQUERIESPROC          glGenQueries;
+extern PFNGLDELETEQUERIESPROC       glDeleteQueries;
+extern PFNGLQUERYCOUNTERPROC        glQueryCounter;
+extern PFNGLGETQUERYOBJECTIVPROC    glGetQueryObjectiv;
+extern PFNGLGETQUERYOBJECTUI64VPROC glGetQueryObjectui64v;
+extern PFNGLGETINTEGER64VPROC       glGetInteger64v;
+extern PFNGLGENFRAMEBUFFERSPROC     glGenFramebuffers;
+extern PFNGLDELETEFRAMEBUFFERSPROC  glDeleteFramebuffers;
+extern PFNGLBINDFRAMEBUFFERPROC     glBindFramebuffer;
+extern PFNGLFRAMEBUFFERTEXTURE2DPROC glFramebufferTexture2D;
+extern PFNGLCHECKFRAMEBUFFERSTATUSPROC glCheckFramebufferStatus;
+extern PFNGLGENRENDERBUFFERSPROC    glGenRenderbuffers;
+extern PFNGLDELETERENDERBUFFERSPROC glDeleteRenderbuffers;
+extern PFNGLBINDRENDERBUFFERPROC    glBindRenderbuffer;
+extern PFNGLRENDERBUFFERSTORAGEPROC glRenderbufferStorage;
+extern PFNGLFRAMEBUFFERRENDERBUFFERPROC glFramebufferRenderbuffer;
+extern PFNGLGENVERTEXARRAYSPROC     glGenVertexArrays;
+extern PFNGLDELETEVERTEXARRAYSPROC  glDeleteVertexArrays;
+extern PFNGLBINDVERTEXARRAYPROC     glBindVertexArray;
+extern PFNGLCREATEBUFFERSPROC       glCreateBuffers;
+extern PFNGLNAMEDBUFFERSTORAGEPROC  glNamedBufferStorage;
+extern PFNGLNAMEDBUFFERSUBDATAPROC  glNamedBufferSubData;
+extern PFNGLMAPNAMEDBUFFERRANGEPROC glMapNamedBufferRange;
+extern PFNGLUNMAPNAMEDBUFFERPROC    glUnmapNamedBuffer;
+extern PFNGLCREATEVERTEXARRAYSPROC  glCreateVertexArrays;
+extern PFNGLCREATETEXTURESPROC      glCreateTextures;
+extern PFNGLTEXTURESTORAGE2DPROC    glTextureStorage2D;
+extern PFNGLTEXTURESUBIMAGE2DPROC   glTextureSubImage2D;
+extern PFNGLBINDTEXTUREUNITPROC     glBindTextureUnit;
+extern PFNGLMULTIDRAWARRAYSINDIRECTPROC glMultiDrawArraysIndirect;
+extern PFNGLMULTIDRAWELEMENTSINDIRECTPROC glMultiDrawElementsIndirect;
+
+// Capability tiers found by createGLFunctions(); each tier's functions load independently
+typedef struct {
+	int major;                // Context version (eg: 4.5 -> 4, 5)
+	int minor;
+	bool shader_objects;      // Shaders through GL_ARB_shader_objects (fallback without GL 2.0)
+	bool core_20;             // Shaders through GL 2.0 core (only shader path on core profiles)
+	bool core_33;             // GL 3.3 core with vertex array objects
+	bool dsa;                 // GL 4.5 or GL_ARB_direct_state_access (buffers, vertex arrays, textures)
+	bool buffer_storage;      // GL 4.4 or GL_ARB_buffer_storage (persistent mapping)
+	bool multi_draw_indirect; // GL 4.3 or GL_ARB_multi_draw_indirect
+	bool uniform_int64;       // GL_ARB_gpu_shader_int64 (glUniform*i64)
+	bool uniform_double;      // GL 4.0 or GL_ARB_gpu_shader_fp64 (glUniform*d)
+} GLCapabilities;
+
+extern GLCapabilities GL_CAPABILITIES;
+
+/**
+ * Probe every capability tier of current context and load its functions
+ *
+ * Tiers are independent: a missing tier (eg: 64-bit uniforms) only clears
+ * its own flag. Shaders load from GL 2.0 core when available, else from
+ * GL_ARB_shader_objects. Called by initShaders().
+ *
+ * \returns Capabilities found (also kept in GL_CAPABILITIES)
+ */
+extern GLCapabilities createGLFunctions();
 
 extern bool createMissingGlShaderFunctions();
+extern bool createCoreShaderFunctions();
+extern bool createShaderObjectFunctions();
+extern bool createUniformInt64Functions();
+extern bool createUniformDoubleFunctions();
+extern bool createProgramBinaryFunctions();
+extern bool createParallelShaderCompileFunctions();
+extern bool createUniformBufferFunctions();
+extern bool createMultitextureFunctions();
+extern bool createPixelBufferFunctions();
+extern bool createCompressedTextureFunctions();
+extern bool createVertexBufferFunctions();
+extern bool createVertexAttribFunctions();
+extern bool createInstancedArrayFunctions();
+extern bool createTimerQueryFunctions();
+extern bool createFramebufferFunctions();
+extern bool createSyncFunctions();
+extern bool createVertexArrayFunctions();
+extern bool createDirectStateAccessFunctions();
+extern bool createBufferStorageFunctions();
+extern bool createMultiDrawIndirectFunctions();
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,455 @@
+#include "glsl_reload.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+#define RELOAD_PATH_SIZE 1000
+#define RELOAD_EVENT_BUFFER_SIZE 4096
+
+typedef struct {
+	Shader* shader;
+	char* vert_filename;
+	char* frag_filename;
+	char* defines[SHADER_RELOAD_MAX_DEFINES];
+	int num_defines;
+	Uint64 vert_hash;   // Sources last handed over (saves without changes are skipped)
+	Uint64 frag_hash;
+	bool loaded;        // Sources below wait for render thread
+	char* vert_source;
+	char* frag_source;
+	int vert_source_len;
+	int frag_source_len;
+	bool compiling;     // Render thread only
+	Shader replacement; // Render thread only
+} ReloadShader;
+
+typedef struct {
+	int watch;
+	char prefix[RELOAD_PATH_SIZE]; // Directory as written in filenames, with trailing separator ("" for working dir)
+} ReloadDirectory;
+
+SDL_mutex* RELOAD_LOCK = NULL;
+SDL_Thread* RELOAD_THREAD = NULL;
+bool RELOAD_QUIT = false;
+int RELOAD_FD = -1;
+
+// Entries below count are never moved; only render thread appends
+ReloadShader RELOAD_SHADERS[SHADER_RELOAD_MAX_SHADERS];
+int RELOAD_SHADER_COUNT = 0;
+ReloadDirectory RELOAD_DIRECTORIES[SHADER_RELOAD_MAX_DIRECTORIES];
+int RELOAD_DIRECTORY_COUNT = 0;
+ShaderReloadStats RELOAD_STATS;
+
+static char* copyReloadString(const char* string) {
+	size_t length = strlen(string) + 1;
+	char* copy = (char*)malloc(length);
+
+	if (copy != NULL) memcpy(copy, string, length);
+	return copy;
+}
+
+static bool addReloadDirectory(const char* filename) {
+	char prefix[RELOAD_PATH_SIZE];
+	int i;
+	int length = 0;
+	bool added = true;
+	const char* c;
+	ReloadDirectory* directory;
+
+	for (c = filename; *c != '\0'; c++) {
+		if (*c == '/' || *c == '\\') length = c - filename + 1;
+	}
+	if (length >= RELOAD_PATH_SIZE) {
+		SDL_SetError("Shader directory path too long: \"%s\"", filename);
+		return false;
+	}
+	memcpy(prefix, filename, length);
+	prefix[length] = '\0';
+
+	SDL_LockMutex(RELOAD_LOCK);
+	for (i = 0; i < RELOAD_DIRECTORY_COUNT; i++) {
+		if (strcmp(RELOAD_DIRECTORIES[i].prefix, prefix) == 0) break;
+	}
+	if (i == RELOAD_DIRECTORY_COUNT) {
+		directory = &RELOAD_DIRECTORIES[RELOAD_DIRECTORY_COUNT];
+		if (RELOAD_DIRECTORY_COUNT == SHADER_RELOAD_MAX_DIRECTORIES) {
+			SDL_SetError("Too many shader directories to watch (max %d)", SHADER_RELOAD_MAX_DIRECTORIES);
+			added = false;
+		} else {
+#ifdef __linux__
+			// Watch directory rather than file, editors often save by replacing the file
+			directory->watch = inotify_add_watch(RELOAD_FD, length ? prefix : ".", IN_CLOSE_WRITE | IN_MOVED_TO);
+			if (directory->watch < 0) {
+				SDL_SetError("Unable to watch \"%s\": %s", length ? prefix : ".", strerror(errno));
+				added = false;
+			}
+#endif
+			if (added) {
+				memcpy(directory->prefix, prefix, length + 1);
+				RELOAD_DIRECTORY_COUNT++;
+			}
+		}
+	}
+	SDL_UnlockMutex(RELOAD_LOCK);
+
+	return added;
+}
+
+static void watchReloadInclude(const char* filename, void* data) {
+	(void)data;
+	if (!addReloadDirectory(filename)) printf("[WARN] Shader include not watched: %s\n", SDL_GetError());
+}
+
+#ifdef __linux__
+static bool readReloadEvents() {
+	union {
+		struct inotify_event event;
+		char bytes[RELOAD_EVENT_BUFFER_SIZE];
+	} buffer;
+	char path[RELOAD_PATH_SIZE];
+	char* next;
+	const struct inotify_event* event;
+	ssize_t length;
+	int i, count;
+	bool changed = false;
+
+	SDL_LockMutex(RELOAD_LOCK);
+	count = RELOAD_DIRECTORY_COUNT;
+	SDL_UnlockMutex(RELOAD_LOCK);
+
+	while ((length = read(RELOAD_FD, buffer.bytes, sizeof(buffer))) > 0) {
+		for (next = buffer.bytes; next < buffer.bytes + length; next += sizeof(struct inotify_event) + event->len) {
+			event = (const struct inotify_event*)next;
+			if (event->len == 0) continue;
+
+			// Same directory may be watched under several prefixes (eg: "a/" and "./a/")
+			for (i = 0; i < count; i++) {
+				if (RELOAD_DIRECTORIES[i].watch != event->wd) continue;
+				snprintf(path, RELOAD_PATH_SIZE, "%s%s", RELOAD_DIRECTORIES[i].prefix, event->name);
+				invalidateGLSLFile(path);
+				changed = true;
+			}
+		}
+	}
+
+	return changed;
+}
+
+static void reloadWatchedShaders() {
+	int i, count;
+	bool loaded;
+	Uint64 vert_hash, frag_hash;
+	Shader next;
+	ReloadShader* watched;
+
+	SDL_LockMutex(RELOAD_LOCK);
+	count = RELOAD_SHADER_COUNT;
+	SDL_UnlockMutex(RELOAD_LOCK);
+
+	for (i = 0; i < count; i++) {
+		watched = &RELOAD_SHADERS[i];
+
+		// Only invalidated files are re-read, the rest come from the preprocessor's memo
+		memset(&next, 0, sizeof(Shader));
+		loaded = preprocessGLSLFile(&next, GLSL_VERT, watched->vert_filename, (const char**)watched->defines, watched->num_defines) == GLSL_SUCCESS;
+		free(next.name);
+		next.name = NULL;
+		loaded = loaded && preprocessGLSLFile(&next, GLSL_FRAG, watched->frag_filename, (const char**)watched->defines, watched->num_defines) == GLSL_SUCCESS;
+		free(next.name);
+		if (!loaded) {
+			printf("[WARN] Unable to reload shader: %s\n", SDL_GetError());
+			free(next.vert_source);
+			free(next.frag_source);
+			SDL_LockMutex(RELOAD_LOCK);
+			RELOAD_STATS.failures++;
+			SDL_UnlockMutex(RELOAD_LOCK);
+			continue;
+		}
+		vert_hash = hashSource(FNV_OFFSET_BASIS, next.vert_source, next.vert_source_len);
+		frag_hash = hashSource(FNV_OFFSET_BASIS, next.frag_source, next.frag_source_len);
+
+		SDL_LockMutex(RELOAD_LOCK);
+		if (vert_hash != watched->vert_hash || frag_hash != watched->frag_hash) {
+			// Newer sources replace any the render thread has not taken yet
+			free(watched->vert_source);
+			free(watched->frag_source);
+			watched->vert_source = next.vert_source;
+			watched->frag_source = next.frag_source;
+			watched->vert_source_len = next.vert_source_len;
+			watched->frag_source_len = next.frag_source_len;
+			watched->vert_hash = vert_hash;
+			watched->frag_hash = frag_hash;
+			if (!watched->loaded) RELOAD_STATS.pending++;
+			watched->loaded = true;
+			next.vert_source = NULL;
+			next.frag_source = NULL;
+		}
+		SDL_UnlockMutex(RELOAD_LOCK);
+		free(next.vert_source);
+		free(next.frag_source);
+
+		// Pick up directories of newly added includes
+		forEachGLSLInclude(watched->vert_filename, watchReloadInclude, NULL);
+		forEachGLSLInclude(watched->frag_filename, watchReloadInclude, NULL);
+	}
+}
+
+int shaderReloadWorker(void* data) {
+	struct pollfd poll_fd;
+	bool quit;
+	bool changed = false;
+	Uint32 last_change = 0;
+	(void)data;
+
+	poll_fd.fd = RELOAD_FD;
+	poll_fd.events = POLLIN;
+
+	while (true) {
+		SDL_LockMutex(RELOAD_LOCK);
+		quit = RELOAD_QUIT;
+		SDL_UnlockMutex(RELOAD_LOCK);
+		if (quit) return 0;
+
+		// Wait for changes, then for writes to settle before reloading
+		if (poll(&poll_fd, 1, changed ? SHADER_RELOAD_SETTLE_MS : SHADER_RELOAD_POLL_MS) > 0 && readReloadEvents()) {
+			changed = true;
+			last_change = SDL_GetTicks();
+			continue;
+		}
+		if (changed && SDL_GetTicks() - last_change >= SHADER_RELOAD_SETTLE_MS) {
+			changed = false;
+			reloadWatchedShaders();
+		}
+	}
+}
+#endif
+
+bool initShaderReload() {
+	if (RELOAD_THREAD != NULL) {
+		SDL_SetError("Shader hot reload already started");
+		return false;
+	}
+	if (!SDL_GLSL_SUPPORTED) {
+		SDL_SetError("Shader hot reload unsupported: shaders not initialized or unsupported");
+		return false;
+	}
+
+#ifdef __linux__
+	RELOAD_FD = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (RELOAD_FD < 0) {
+		SDL_SetError("Unable to watch shader files: %s", strerror(errno));
+		return false;
+	}
+
+	RELOAD_LOCK = SDL_CreateMutex();
+	if (RELOAD_LOCK == NULL) {
+		close(RELOAD_FD);
+		RELOAD_FD = -1;
+		return false;
+	}
+
+	RELOAD_QUIT = false;
+	RELOAD_SHADER_COUNT = 0;
+	RELOAD_DIRECTORY_COUNT = 0;
+	memset(&RELOAD_STATS, 0, sizeof(ShaderReloadStats));
+
+	RELOAD_THREAD = SDL_CreateThread(shaderReloadWorker, "ShaderReload", NULL);
+	if (RELOAD_THREAD == NULL) {
+		SDL_DestroyMutex(RELOAD_LOCK);
+		RELOAD_LOCK = NULL;
+		close(RELOAD_FD);
+		RELOAD_FD = -1;
+		return false;
+	}
+
+	return true;
+#else
+	SDL_SetError("Shader hot reload unsupported: requires inotify (Linux)");
+	return false;
+#endif
+}
+
+bool watchShader(Shader* shader, const char* vert_filename, const char* frag_filename, const char** defines, int num_defines) {
+	int i;
+	bool copied;
+	ReloadShader* watched;
+
+	if (RELOAD_THREAD == NULL) {
+		SDL_SetError("Shader hot reload not started");
+		return false;
+	}
+	if (shader->permutation != NULL) {
+		SDL_SetError("Shader hot reload does not support permutation shaders: \"%s\"", shader->name);
+		return false;
+	}
+	if (num_defines > SHADER_RELOAD_MAX_DEFINES) {
+		SDL_SetError("Too many defines to reload shader: %d (max %d)", num_defines, SHADER_RELOAD_MAX_DEFINES);
+		return false;
+	}
+	if (RELOAD_SHADER_COUNT == SHADER_RELOAD_MAX_SHADERS) {
+		SDL_SetError("Too many shaders to reload (max %d)", SHADER_RELOAD_MAX_SHADERS);
+		return false;
+	}
+	if (!addReloadDirectory(vert_filename) || !addReloadDirectory(frag_filename)) return false;
+
+	// Fill entry before it becomes visible to watcher
+	watched = &RELOAD_SHADERS[RELOAD_SHADER_COUNT];
+	memset(watched, 0, sizeof(ReloadShader));
+	watched->shader = shader;
+	watched->vert_filename = copyReloadString(vert_filename);
+	watched->frag_filename = copyReloadString(frag_filename);
+	copied = watched->vert_filename != NULL && watched->frag_filename != NULL;
+	for (i = 0; i < num_defines; i++) {
+		watched->defines[i] = copyReloadString(defines[i]);
+		if (watched->defines[i] == NULL) copied = false;
+	}
+	watched->num_defines = num_defines;
+	if (!copied) {
+		free(watched->vert_filename);
+		free(watched->frag_filename);
+		for (i = 0; i < num_defines; i++) free(watched->defines[i]);
+		SDL_SetError("Failed to allocate watched shader \"%s\"", frag_filename);
+		return false;
+	}
+
+	// Current sources count as already loaded
+	watched->vert_hash = hashSource(FNV_OFFSET_BASIS, shader->vert_source, shader->vert_source_len);
+	watched->frag_hash = hashSource(FNV_OFFSET_BASIS, shader->frag_source, shader->frag_source_len);
+
+	SDL_LockMutex(RELOAD_LOCK);
+	RELOAD_SHADER_COUNT++;
+	SDL_UnlockMutex(RELOAD_LOCK);
+
+	// Includes outside the shader's own directories
+	forEachGLSLInclude(vert_filename, watchReloadInclude, NULL);
+	forEachGLSLInclude(frag_filename, watchReloadInclude, NULL);
+
+	return true;
+}
+
+int updateShaderReload() {
+	int i;
+	int swapped = 0;
+	int submitted = 0;
+	bool taken;
+	bool linked;
+	double update_ms;
+	Uint64 start;
+	ReloadShader* watched;
+
+	if (RELOAD_THREAD == NULL) return 0;
+	start = SDL_GetPerformanceCounter();
+
+	for (i = 0; i < RELOAD_SHADER_COUNT; i++) {
+		watched = &RELOAD_SHADERS[i];
+
+		// Swap at frame boundary once driver finishes (polled without waiting)
+		if (watched->compiling) {
+			if (updateShaders(&watched->replacement, 1) > 0) continue;
+			watched->compiling = false;
+
+			linked = swapShaderProgram(watched->shader, &watched->replacement);
+			if (linked) {
+				printf("Reloaded shader: \"%s\" + \"%s\"\n", watched->vert_filename, watched->frag_filename);
+				swapped++;
+			} else {
+				printf("[WARN] Reloaded shader failed, keeping previous program: \"%s\" + \"%s\"\n", watched->vert_filename, watched->frag_filename);
+			}
+
+			SDL_LockMutex(RELOAD_LOCK);
+			if (linked) RELOAD_STATS.reloads++;
+			else RELOAD_STATS.failures++;
+			RELOAD_STATS.pending--;
+			SDL_UnlockMutex(RELOAD_LOCK);
+		}
+
+		// Driver may compile inside submit without parallel compile, so keep to one per frame
+		if (!PARALLEL_COMPILE_SUPPORTED && submitted > 0) continue;
+
+		SDL_LockMutex(RELOAD_LOCK);
+		taken = watched->loaded;
+		if (taken) {
+			watched->replacement.vert_source = watched->vert_source;
+			watched->replacement.frag_source = watched->frag_source;
+			watched->replacement.vert_source_len = watched->vert_source_len;
+			watched->replacement.frag_source_len = watched->frag_source_len;
+			watched->replacement.name = copyReloadString(watched->frag_filename);
+			watched->vert_source = NULL;
+			watched->frag_source = NULL;
+			watched->loaded = false;
+		}
+		SDL_UnlockMutex(RELOAD_LOCK);
+
+		// Failed submits are rejected on next update (replacement never becomes ready)
+		if (taken) {
+			compileShaderAsync(&watched->replacement);
+			watched->compiling = true;
+			submitted++;
+		}
+	}
+
+	update_ms = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+	SDL_LockMutex(RELOAD_LOCK);
+	if (update_ms > RELOAD_STATS.max_update_ms) RELOAD_STATS.max_update_ms = update_ms;
+	SDL_UnlockMutex(RELOAD_LOCK);
+
+	return swapped;
+}
+
+ShaderReloadStats getShaderReloadStats() {
+	ShaderReloadStats stats;
+
+	if (RELOAD_LOCK == NULL) return RELOAD_STATS;
+
+	SDL_LockMutex(RELOAD_LOCK);
+	stats = RELOAD_STATS;
+	SDL_UnlockMutex(RELOAD_LOCK);
+
+	return stats;
+}
+
+void quitShaderReload() {
+	int i, j;
+	ReloadShader* watched;
+
+	if (RELOAD_THREAD == NULL) return;
+
+	SDL_LockMutex(RELOAD_LOCK);
+	RELOAD_QUIT = true;
+	SDL_UnlockMutex(RELOAD_LOCK);
+	SDL_WaitThread(RELOAD_THREAD, NULL);
+	RELOAD_THREAD = NULL;
+
+	for (i = 0; i < RELOAD_SHADER_COUNT; i++) {
+		watched = &RELOAD_SHADERS[i];
+
+		// Discard replacement still compiling (never swapped in)
+		if (watched->compiling) {
+			watched->replacement.ready = false;
+			swapShaderProgram(watched->shader, &watched->replacement);
+		}
+		free(watched->vert_filename);
+		free(watched->frag_filename);
+		for (j = 0; j < watched->num_defines; j++) free(watched->defines[j]);
+		free(watched->vert_source);
+		free(watched->frag_source);
+	}
+	RELOAD_SHADER_COUNT = 0;
+	RELOAD_DIRECTORY_COUNT = 0;
+
+#ifdef __linux__
+	// Closing removes every watch
+	close(RELOAD_FD);
+#endif
+	RELOAD_FD = -1;
+	SDL_DestroyMutex(RELOAD_LOCK);
+	RELOAD_LOCK = NULL;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include <stdbool.h>
+
+#include <SDL.h>
+
+#include "glsl_shader.h"
+
+#define SHADER_RELOAD_MAX_SHADERS     256
+#define SHADER_RELOAD_MAX_DIRECTORIES 64
+#define SHADER_RELOAD_MAX_DEFINES     16
+#define SHADER_RELOAD_POLL_MS         100 // Watcher checks for quit at least this often
+#define SHADER_RELOAD_SETTLE_MS       50  // Quiet time after last change before reloading (editors write in bursts)
+
+typedef struct {
+	int reloads;          // Programs swapped in
+	int failures;         // Reloads rejected (load, compile or link failed; previous program kept)
+	int pending;          // Reloads loaded or compiling
+	double max_update_ms; // Longest updateShaderReload() call
+} ShaderReloadStats;
+
+/**
+ * Start watching shader files for changes (Linux inotify)
+ *
+ * A background thread waits on file changes, then re-reads and preprocesses
+ * changed shaders (and anything including a changed file) off the render
+ * thread. updateShaderReload() submits new sources to the driver's parallel
+ * compiler and swaps each program in only once it links.
+ * Requires initShaders().
+ *
+ * \returns true on success or false on failure; call SDL_GetError() for more information.
+ *
+ * \sa watchShader
+ * \sa updateShaderReload
+ * \sa quitShaderReload
+ */
+extern bool initShaderReload();
+
+/**
+ * Reload shader whenever its files (or their includes) change
+ *
+ * \param shader Shader loaded from the given files; must stay valid until quitShaderReload()
+ * \param vert_filename Vertex shader file
+ * \param frag_filename Fragment shader file
+ * \param defines Defines given to preprocessGLSLFile() (may be NULL, copied)
+ * \param num_defines Number of defines (up to SHADER_RELOAD_MAX_DEFINES)
+ * \returns true on success or false on failure; call SDL_GetError() for more information.
+ */
+extern bool watchShader(Shader* shader, const char* vert_filename, const char* frag_filename, const char** defines, int num_defines);
+
+/**
+ * Submit reloaded sources and swap in finished programs (call once per frame, before drawing)
+ *
+ * Never waits on the driver when parallel shader compile is supported;
+ * shaders that fail keep drawing with their previous program.
+ *
+ * \returns Number of shaders swapped (fetch their uniform handles again)
+ *
+ * \warning Without parallel shader compile support one reload is submitted
+ *          per frame, and the driver may compile it during that call.
+ */
+extern int updateShaderReload();
+
+extern ShaderReloadStats getShaderReloadStats();
+
+/**
+ * Stop watcher and discard reloads in progress (call before freeShaders())
+ */
+extern void quitShaderReload();
+
+#ifdef __cplusplus
+}
+#endif
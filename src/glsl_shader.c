@@ -4,15 +4,22 @@
 #include <stdio.h>
 #include <malloc.h>
 #include <string.h>
+#include <limits.h>
 
 #include <SDL.h>
 #include <SDL_opengl_glext.h>
 
-#include "glsl_ext.h" // Uncomment if gl<shader> functions missing from SDL_opengl* (also check initShaders() below)
+#include "gl_math.h"
+#include "gl_state.h"
+#include "sdl_gl.h"
+#include "glsl_ext.h"
 
-#define MAX_LINE_SIZE (500)
-#define MAX_SOURCE_SIZE (100000)
 #define MAX_REASON_SIZE (10000)
+#define MAX_PATH_SIZE (1000)
+#define SHADER_CACHE_PATH_SIZE (MAX_PATH_SIZE + 1 + 16 + 6 + 1) // Directory + '/' + key + ".glbin" + NUL
+
+#define SHADER_CACHE_MAGIC (0x42534c47)
+#define SHADER_CACHE_VERSION (1)
 
 // Externs
 bool SDL_GLSL_SUPPORTED = false;
@@ -21,6 +28,229 @@ char SDL_GLSL_VERSION[10];
 
 int SHADER_COUNT;
 
+// Shader binary cache file header (followed by binary of header.length bytes)
+typedef struct {
+	Uint32 magic;
+	Uint32 version;
+	Uint64 key;
+	Uint32 format;
+	Uint32 length;
+	Uint32 compile_us;
+} ShaderCacheHeader;
+
+bool SHADER_CACHE_SUPPORTED = false;
+bool SHADER_CACHE_ENABLED = false;
+char SHADER_CACHE_DIR[MAX_PATH_SIZE];
+Uint64 SHADER_CACHE_CONTEXT_HASH;
+ShaderCacheStats SHADER_CACHE_STATS;
+
+bool PARALLEL_COMPILE_SUPPORTED = false;
+bool UNIFORM_BUFFER_SUPPORTED = false;
+
+// Compiled vertex/fragment stage shared by every program with identical source
+typedef struct {
+	Uint64 key;
+	GLhandleARB handle;
+	int refs;
+} ShaderStage;
+
+ShaderStage* SHADER_STAGES = NULL;
+int SHADER_STAGE_COUNT = 0;
+int SHADER_STAGE_CAPACITY = 0;
+
+// Preprocessed source buffer shared by several Shaders (eg: one stage of a loadGLSLMatrix() row/column)
+typedef struct {
+	char* source;
+	int refs;
+} SharedSource;
+
+SharedSource* SHARED_SOURCES = NULL;
+int SHARED_SOURCE_COUNT = 0;
+int SHARED_SOURCE_CAPACITY = 0;
+
+// Preprocessed GLSL file memoized per session (comments/blank space stripped; #include lines pasted per build)
+typedef struct {
+	char* filename;
+	char* source;
+	int length;
+	int* includes;      // Resolved file of each #include line, in order
+	int num_includes;
+	Uint32 included;    // Build that last pasted this file (include-once)
+	bool stale;
+	bool expanding;
+} GLSLFile;
+
+typedef struct {
+	char* data;
+	int length;
+	int capacity;
+} SourceBuffer;
+
+// Program compiled for one feature mask of a permutation shader
+typedef struct {
+	Uint32 features;
+	Shader shader;
+} ShaderVariant;
+
+// Source files, feature names and lazily filled variant table behind a permutation Shader
+typedef struct ShaderPermutation ShaderPermutation;
+struct ShaderPermutation {
+	char* vert_filename;
+	char* frag_filename;
+	char* features[GLSL_MAX_FEATURES];
+	int num_features;
+	ShaderVariant** variants; // Allocated individually so returned Shader pointers survive table growth
+	int num_variants;
+	int capacity;
+	ShaderVariant* last;      // Most recent lookup (consecutive draws usually repeat a variant)
+};
+
+GLSLFile* GLSL_FILES = NULL;
+int GLSL_FILE_COUNT = 0;
+int GLSL_FILE_CAPACITY = 0;
+Uint32 GLSL_BUILD_STAMP = 0;
+SDL_mutex* GLSL_FILES_LOCK = NULL; // Held by every public preprocessor call (eg: shader hot reload thread)
+SDL_SpinLock GLSL_FILES_LOCK_INIT = 0;
+
+void lockGLSLFiles() {
+	// Created on first use (files may load before initShaders()); waiters sleep through disk reads instead of spinning
+	SDL_AtomicLock(&GLSL_FILES_LOCK_INIT);
+	if (GLSL_FILES_LOCK == NULL) GLSL_FILES_LOCK = SDL_CreateMutex();
+	SDL_AtomicUnlock(&GLSL_FILES_LOCK_INIT);
+	SDL_LockMutex(GLSL_FILES_LOCK);
+}
+
+Uint64 hashBytes(Uint64 hash, const void* data, size_t size) {
+	const unsigned char* bytes = (const unsigned char*)data;
+	size_t i;
+
+	// FNV-1a
+	for (i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= FNV_PRIME;
+	}
+
+	return hash;
+}
+
+Uint64 hashString(Uint64 hash, const char* str) {
+	if (str == NULL) str = "";
+	// Include terminator so ("ab", "c") and ("a", "bc") differ
+	return hashBytes(hash, str, strlen(str) + 1);
+}
+
+Uint64 hashSource(Uint64 hash, const char* source, int length) {
+	// Include length so ("ab", "c") and ("a", "bc") differ
+	hash = hashBytes(hash, &length, sizeof(int));
+	return hashBytes(hash, source, length);
+}
+
+double elapsedMilliseconds(Uint64 start) {
+	return (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+Uint64 getShaderCacheKey(Shader* shader) {
+	Uint64 key = SHADER_CACHE_CONTEXT_HASH;
+	key = hashSource(key, shader->vert_source, shader->vert_source_len);
+	key = hashSource(key, shader->frag_source, shader->frag_source_len);
+	return key;
+}
+
+void getShaderCachePath(Uint64 key, char* path) {
+	snprintf(path, SHADER_CACHE_PATH_SIZE, "%s/%016llx.glbin", SHADER_CACHE_DIR, (unsigned long long)key);
+}
+
+bool loadCachedShaderProgram(Shader* shader, Uint64 key) {
+	int status;
+	double load_ms;
+	char path[SHADER_CACHE_PATH_SIZE];
+	void* binary;
+	FILE* file;
+	ShaderCacheHeader header;
+	Uint64 start = SDL_GetPerformanceCounter();
+
+	getShaderCachePath(key, path);
+	file = fopen(path, "rb");
+	if (file == NULL) return false;
+
+	// Read and validate header then binary
+	if (fread(&header, sizeof(ShaderCacheHeader), 1, file) != 1 ||
+		header.magic != SHADER_CACHE_MAGIC ||
+		header.version != SHADER_CACHE_VERSION ||
+		header.key != key ||
+		header.length == 0) {
+		fclose(file);
+		return false;
+	}
+	binary = malloc(header.length);
+	if (binary == NULL || fread(binary, header.length, 1, file) != 1) {
+		free(binary);
+		fclose(file);
+		return false;
+	}
+	fclose(file);
+
+	// Load binary into new program; driver rejects stale binaries (eg: driver update)
+	shader->program = glCreateProgramObject();
+	glProgramBinary(shader->program, header.format, binary, header.length);
+	free(binary);
+
+	glGetProgramiv(shader->program, GL_LINK_STATUS, &status);
+	if (status == 0) {
+		glDeleteObject(shader->program);
+		shader->program = 0;
+		SHADER_CACHE_STATS.rejected++;
+		// Clear any error from rejected binary; full compile follows
+		glGetError();
+		return false;
+	}
+
+	load_ms = elapsedMilliseconds(start);
+	SHADER_CACHE_STATS.hits++;
+	SHADER_CACHE_STATS.load_ms += load_ms;
+	SHADER_CACHE_STATS.saved_ms += header.compile_us * 0.001 - load_ms;
+
+	return true;
+}
+
+bool saveCachedShaderProgram(Shader* shader, Uint64 key, double compile_ms) {
+	int length = 0;
+	GLenum format;
+	char path[SHADER_CACHE_PATH_SIZE];
+	void* binary;
+	FILE* file;
+	ShaderCacheHeader header;
+
+	glGetProgramiv(shader->program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0) return false;
+
+	binary = malloc(length);
+	if (binary == NULL) return false;
+	glGetProgramBinary(shader->program, length, &length, &format, binary);
+
+	// Zero struct padding so no uninitialized bytes reach the file
+	memset(&header, 0, sizeof(ShaderCacheHeader));
+	header.magic = SHADER_CACHE_MAGIC;
+	header.version = SHADER_CACHE_VERSION;
+	header.key = key;
+	header.format = format;
+	header.length = length;
+	header.compile_us = (Uint32)(compile_ms * 1000.0);
+
+	getShaderCachePath(key, path);
+	file = fopen(path, "wb");
+	if (file == NULL) {
+		free(binary);
+		return false;
+	}
+	fwrite(&header, sizeof(ShaderCacheHeader), 1, file);
+	fwrite(binary, length, 1, file);
+	fclose(file);
+	free(binary);
+
+	return true;
+}
+
 bool checkGLSuccessStatus(GLhandleARB handle, GLenum status_key, char* reason, const size_t buffer_count) {
 	int status;
 
@@ -34,70 +264,543 @@ bool checkGLSuccessStatus(GLhandleARB handle, GLenum status_key, char* reason, c
 	return true;
 }
 
-bool linkCompiledShadersWithProgram(Shader* shader) {
-	char reason[MAX_REASON_SIZE];
-
-	// Attach and link compiled shaders with GL program
+void linkCompiledShadersWithProgram(Shader* shader) {
+	// Attach and link compiled shaders with GL program (status checked later)
 	glAttachObject(shader->program, shader->vert_shader);
 	glAttachObject(shader->program, shader->frag_shader);
 	glLinkProgram(shader->program);
+}
+
+void compileShader(GLhandleARB compiled, const GLcharARB* source, int length) {
+	// Compile from source with known length (status checked later)
+	glShaderSource(compiled, 1, &source, &length);
+	glCompileShader(compiled);
+}
+
+GLhandleARB acquireShaderStage(GLenum type, const char* source, int length) {
+	int i;
+	Uint64 key;
+	void* realloc_ptr;
+	ShaderStage* stage;
+
+	key = hashBytes(FNV_OFFSET_BASIS, &type, sizeof(GLenum));
+	key = hashSource(key, source, length);
+
+	// Reuse already compiled stage with identical source
+	for (i = 0; i < SHADER_STAGE_COUNT; i++) {
+		if (SHADER_STAGES[i].key == key) {
+			SHADER_STAGES[i].refs++;
+			return SHADER_STAGES[i].handle;
+		}
+	}
+
+	// Grow stage cache as needed
+	if (SHADER_STAGE_COUNT == SHADER_STAGE_CAPACITY) {
+		SHADER_STAGE_CAPACITY = SHADER_STAGE_CAPACITY ? SHADER_STAGE_CAPACITY * 2 : 16;
+		realloc_ptr = realloc(SHADER_STAGES, sizeof(ShaderStage) * SHADER_STAGE_CAPACITY);
+		if (realloc_ptr == NULL) {
+			SHADER_STAGE_CAPACITY = SHADER_STAGE_COUNT;
+			return 0;
+		}
+		SHADER_STAGES = (ShaderStage*)realloc_ptr;
+	}
+
+	// Create and compile new stage
+	stage = &SHADER_STAGES[SHADER_STAGE_COUNT++];
+	stage->key = key;
+	stage->refs = 1;
+	stage->handle = glCreateShaderObject(type);
+	compileShader(stage->handle, source, length);
+
+	return stage->handle;
+}
+
+void releaseShaderStage(GLhandleARB handle) {
+	int i;
+
+	for (i = 0; i < SHADER_STAGE_COUNT; i++) {
+		if (SHADER_STAGES[i].handle != handle) continue;
+
+		// Delete once last program using stage is destroyed
+		if (--SHADER_STAGES[i].refs == 0) {
+			glDeleteObject(handle);
+			SHADER_STAGES[i] = SHADER_STAGES[--SHADER_STAGE_COUNT];
+		}
+		return;
+	}
+}
+
+bool shareShaderSource(char* source, int refs) {
+	void* realloc_ptr;
+	SharedSource* shared;
+
+	// Grow shared source table as needed
+	if (SHARED_SOURCE_COUNT == SHARED_SOURCE_CAPACITY) {
+		SHARED_SOURCE_CAPACITY = SHARED_SOURCE_CAPACITY ? SHARED_SOURCE_CAPACITY * 2 : 16;
+		realloc_ptr = realloc(SHARED_SOURCES, sizeof(SharedSource) * SHARED_SOURCE_CAPACITY);
+		if (realloc_ptr == NULL) {
+			SHARED_SOURCE_CAPACITY = SHARED_SOURCE_COUNT;
+			SDL_SetError("Failed to allocate shared shader source");
+			return false;
+		}
+		SHARED_SOURCES = (SharedSource*)realloc_ptr;
+	}
+
+	shared = &SHARED_SOURCES[SHARED_SOURCE_COUNT++];
+	shared->source = source;
+	shared->refs = refs;
+
+	return true;
+}
+
+void releaseShaderSource(char* source) {
+	int i;
+
+	if (source == NULL) return;
+	for (i = 0; i < SHARED_SOURCE_COUNT; i++) {
+		if (SHARED_SOURCES[i].source != source) continue;
+
+		// Free once last Shader using source is freed or swapped
+		if (--SHARED_SOURCES[i].refs == 0) {
+			free(source);
+			SHARED_SOURCES[i] = SHARED_SOURCES[--SHARED_SOURCE_COUNT];
+		}
+		return;
+	}
+
+	// Source owned by a single Shader
+	free(source);
+}
+
+bool checkShaderCompiled(GLhandleARB compiled, const GLcharARB* source) {
+	char reason[MAX_REASON_SIZE];
+
+	// Check compiled success or failure
+	if (!checkGLSuccessStatus(compiled, GL_OBJECT_COMPILE_STATUS_ARB, reason, MAX_REASON_SIZE)) {
+		printf("Failed to compile shader:\n%s\n%s\n", source, reason);
+		return false;
+	}
+
+	return true;
+}
+
+bool checkShaderLinked(Shader* shader) {
+	char reason[MAX_REASON_SIZE];
 
 	// Check link success or failure
 	if (!checkGLSuccessStatus(shader->program, GL_OBJECT_LINK_STATUS_ARB, reason, MAX_REASON_SIZE)) {
 		printf("Failed to link program:\n%s", reason);
 		return false;
 	}
-	
+
 	return true;
 }
 
-bool compileShader(GLhandleARB compiled, const GLcharARB* source) {
-	char reason[MAX_REASON_SIZE];
+void freeShaderUniforms(Shader* shader) {
+	int i;
 
-	// Compile from source
-	glShaderSource(compiled, 1, &source, NULL);
-	glCompileShader(compiled);
+	for (i = 0; i < shader->num_uniforms; i++) free(shader->uniforms[i].name);
+	free(shader->uniforms);
+	shader->uniforms = NULL;
+	shader->num_uniforms = 0;
+}
 
-	// Check compiled success or failure
-	if (!checkGLSuccessStatus(compiled, GL_OBJECT_COMPILE_STATUS_ARB, reason, MAX_REASON_SIZE)) {
-		printf("Failed to compile shader:\n%s\n%s\n", source, reason);
+bool buildShaderUniforms(Shader* shader) {
+	int i;
+	int count = 0;
+	int max_length = 0;
+	char* bracket;
+	ShaderUniform* uniform;
+
+	freeShaderUniforms(shader);
+
+	// Enumerate active uniforms once after link
+	glGetObjectParameteriv(shader->program, GL_OBJECT_ACTIVE_UNIFORMS_ARB, &count);
+	glGetObjectParameteriv(shader->program, GL_OBJECT_ACTIVE_UNIFORM_MAX_LENGTH_ARB, &max_length);
+	if (count <= 0) return true;
+
+	shader->uniforms = (ShaderUniform*)calloc(count, sizeof(ShaderUniform));
+	if (shader->uniforms == NULL) return false;
+
+	for (i = 0; i < count; i++) {
+		uniform = &shader->uniforms[shader->num_uniforms];
+		uniform->name = (char*)malloc(sizeof(char) * (max_length + 1));
+		if (uniform->name == NULL) return false;
+		glGetActiveUniform(shader->program, i, max_length + 1, NULL, &uniform->size, &uniform->type, uniform->name);
+
+		// Arrays are reported as "name[0]"; look up by base name
+		bracket = strchr(uniform->name, '[');
+		if (bracket != NULL) *bracket = '\0';
+
+		// Skip built-ins (gl_*) which have no location
+		uniform->location = glGetUniformLocation(shader->program, uniform->name);
+		if (uniform->location < 0) {
+			free(uniform->name);
+			continue;
+		}
+
+		uniform->hash = hashString(FNV_OFFSET_BASIS, uniform->name);
+		uniform->shadowed = false;
+		shader->num_uniforms++;
+	}
+
+	return true;
+}
+
+int getShaderUniform(Shader* shader, const char* name) {
+	int i;
+	Uint64 hash;
+
+	if (shader == NULL || !shader->ready) return -1;
+
+	hash = hashString(FNV_OFFSET_BASIS, name);
+	for (i = 0; i < shader->num_uniforms; i++) {
+		if (shader->uniforms[i].hash == hash && strcmp(shader->uniforms[i].name, name) == 0) return i;
+	}
+
+	return -1;
+}
+
+bool shaderUniformChanged(Shader* shader, int uniform, const void* value, size_t size) {
+	ShaderUniform* target;
+
+	if (shader == NULL || !shader->ready || uniform < 0 || uniform >= shader->num_uniforms) return false;
+
+	// Skip upload when value matches shadow copy
+	target = &shader->uniforms[uniform];
+	if (target->shadowed && memcmp(&target->value, value, size) == 0) return false;
+	memcpy(&target->value, value, size);
+	target->shadowed = true;
+
+	return true;
+}
+
+GLhandleARB beginShaderUniformUpdate(Shader* shader) {
+	GLhandleARB previous = glStateGetProgram();
+
+	// glUniform* targets program in use; bind only if needed
+	glStateUseProgram(shader->program);
+
+	return previous;
+}
+
+void endShaderUniformUpdate(GLhandleARB previous) {
+	glStateUseProgram(previous);
+}
+
+void setShaderUniform1f(Shader* shader, int uniform, float x) {
+	GLhandleARB previous;
+	GLfloat value[1];
+	value[0] = x;
+	if (!shaderUniformChanged(shader, uniform, value, sizeof(value))) return;
+	previous = beginShaderUniformUpdate(shader);
+	glUniform1f(shader->uniforms[uniform].location, x);
+	endShaderUniformUpdate(previous);
+}
+
+void setShaderUniform2f(Shader* shader, int uniform, float x, float y) {
+	GLhandleARB previous;
+	GLfloat value[2];
+	value[0] = x;
+	value[1] = y;
+	if (!shaderUniformChanged(shader, uniform, value, sizeof(value))) return;
+	previous = beginShaderUniformUpdate(shader);
+	glUniform2f(shader->uniforms[uniform].location, x, y);
+	endShaderUniformUpdate(previous);
+}
+
+void setShaderUniform3f(Shader* shader, int uniform, float x, float y, float z) {
+	GLhandleARB previous;
+	GLfloat value[3];
+	value[0] = x;
+	value[1] = y;
+	value[2] = z;
+	if (!shaderUniformChanged(shader, uniform, value, sizeof(value))) return;
+	previous = beginShaderUniformUpdate(shader);
+	glUniform3f(shader->uniforms[uniform].location, x, y, z);
+	endShaderUniformUpdate(previous);
+}
+
+void setShaderUniform4f(Shader* shader, int uniform, float x, float y, float z, float w) {
+	GLhandleARB previous;
+	GLfloat value[4];
+	value[0] = x;
+	value[1] = y;
+	value[2] = z;
+	value[3] = w;
+	if (!shaderUniformChanged(shader, uniform, value, sizeof(value))) return;
+	previous = beginShaderUniformUpdate(shader);
+	glUniform4f(shader->uniforms[uniform].location, x, y, z, w);
+	endShaderUniformUpdate(previous);
+}
+
+void setShaderUniform1i(Shader* shader, int uniform, int x) {
+	GLhandleARB previous;
+	GLint value[1];
+	value[0] = x;
+	if (!shaderUniformChanged(shader, uniform, value, sizeof(value))) return;
+	previous = beginShaderUniformUpdate(shader);
+	glUniform1i(shader->uniforms[uniform].location, x);
+	endShaderUniformUpdate(previous);
+}
+
+void setShaderUniform2i(Shader* shader, int uniform, int x, int y) {
+	GLhandleARB previous;
+	GLint value[2];
+	value[0] = x;
+	value[1] = y;
+	if (!shaderUniformChanged(shader, uniform, value, sizeof(value))) return;
+	previous = beginShaderUniformUpdate(shader);
+	glUniform2i(shader->uniforms[uniform].location, x, y);
+	endShaderUniformUpdate(previous);
+}
+
+void setShaderUniform3i(Shader* shader, int uniform, int x, int y, int z) {
+	GLhandleARB previous;
+	GLint value[3];
+	value[0] = x;
+	value[1] = y;
+	value[2] = z;
+	if (!shaderUniformChanged(shader, uniform, value, sizeof(value))) return;
+	previous = beginShaderUniformUpdate(shader);
+	glUniform3i(shader->uniforms[uniform].location, x, y, z);
+	endShaderUniformUpdate(previous);
+}
+
+void setShaderUniform4i(Shader* shader, int uniform, int x, int y, int z, int w) {
+	GLhandleARB previous;
+	GLint value[4];
+	value[0] = x;
+	value[1] = y;
+	value[2] = z;
+	value[3] = w;
+	if (!shaderUniformChanged(shader, uniform, value, sizeof(value))) return;
+	previous = beginShaderUniformUpdate(shader);
+	glUniform4i(shader->uniforms[uniform].location, x, y, z, w);
+	endShaderUniformUpdate(previous);
+}
+
+void setShaderUniformMatrix4f(Shader* shader, int uniform, const float* matrix) {
+	GLhandleARB previous;
+	if (!shaderUniformChanged(shader, uniform, matrix, sizeof(GLfloat) * 16)) return;
+	previous = beginShaderUniformUpdate(shader);
+	glUniformMatrix4fv(shader->uniforms[uniform].location, 1, GL_FALSE, matrix);
+	endShaderUniformUpdate(previous);
+}
+
+void setShaderMatrices(Shader* shader, const float* model) {
+	float identity[16];
+	float mvp[16];
+
+	if (shader == NULL || !shader->ready) return;
+	if (model == NULL) {
+		mat4Identity(identity);
+		model = identity;
+	}
+
+	setShaderUniformMatrix4f(shader, shader->matrix_uniforms[0], PROJECTION_MATRIX);
+	setShaderUniformMatrix4f(shader, shader->matrix_uniforms[1], CAMERA_MATRIX);
+	setShaderUniformMatrix4f(shader, shader->matrix_uniforms[2], model);
+
+	// Combined matrix only computed when used
+	if (shader->matrix_uniforms[3] >= 0) {
+		mat4Multiply(mvp, CAMERA_MATRIX, model);
+		mat4Multiply(mvp, PROJECTION_MATRIX, mvp);
+		setShaderUniformMatrix4f(shader, shader->matrix_uniforms[3], mvp);
+	}
+}
+
+bool bindShaderUniformBlock(Shader* shader, const char* block_name, GLuint binding) {
+	GLuint index;
+
+	if (!UNIFORM_BUFFER_SUPPORTED || shader == NULL || !shader->ready) return false;
+
+	index = glGetUniformBlockIndex((GLuint)shader->program, block_name);
+	if (index == GL_INVALID_INDEX) return false;
+	glUniformBlockBinding((GLuint)shader->program, index, binding);
+
+	return true;
+}
+
+UniformRing* createUniformRing(GLsizeiptr frame_size, int frames) {
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	UniformRing* ring;
+
+	if (!UNIFORM_BUFFER_SUPPORTED) {
+		SDL_SetError("Uniform ring unsupported: requires uniform buffer objects, buffer storage and sync");
+		return NULL;
+	}
+	if (frames < 2 || frames > GLSL_UNIFORM_RING_MAX_FRAMES || frame_size <= 0) {
+		SDL_SetError("Invalid uniform ring size: %d frames of %ld bytes", frames, (long)frame_size);
+		return NULL;
+	}
+
+	ring = (UniformRing*)calloc(1, sizeof(UniformRing));
+	if (ring == NULL) {
+		SDL_SetError("Failed to allocate uniform ring");
+		return NULL;
+	}
+
+	// Keep every segment start aligned for glBindBufferRange
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &ring->alignment);
+	if (ring->alignment <= 0) ring->alignment = 256;
+	ring->segment_size = (frame_size + ring->alignment - 1) / ring->alignment * ring->alignment;
+	ring->segments = frames;
+
+	// Immutable storage mapped once for the ring's lifetime
+	glGenBuffers(1, &ring->buffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, ring->buffer);
+	glBufferStorage(GL_UNIFORM_BUFFER, ring->segment_size * frames, NULL, flags);
+	ring->mapped = (Uint8*)glMapBufferRange(GL_UNIFORM_BUFFER, 0, ring->segment_size * frames, flags);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	if (ring->mapped == NULL) {
+		glDeleteBuffers(1, &ring->buffer);
+		free(ring);
+		SDL_SetError("Failed to map uniform ring buffer | GL error: 0x%x", glGetError());
+		return NULL;
+	}
+
+	return ring;
+}
+
+bool pushUniformRing(UniformRing* ring, GLuint binding, const void* data, GLsizeiptr size) {
+	GLintptr offset;
+
+	if (ring->offset + size > ring->segment_size) return false;
+
+	// Write straight into mapped memory then bind the written range
+	offset = ring->segment * ring->segment_size + ring->offset;
+	memcpy(ring->mapped + offset, data, size);
+	glBindBufferRange(GL_UNIFORM_BUFFER, binding, ring->buffer, offset, size);
+
+	ring->offset += (size + ring->alignment - 1) / ring->alignment * ring->alignment;
+
+	return true;
+}
+
+void advanceUniformRing(UniformRing* ring) {
+	GLsync fence;
+
+	// Fence frame just submitted, then move to oldest segment
+	ring->fences[ring->segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	ring->segment = (ring->segment + 1) % ring->segments;
+	ring->offset = 0;
+
+	// Normally already signaled; only waits if GPU is a full ring behind
+	fence = ring->fences[ring->segment];
+	if (fence != NULL) {
+		while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED);
+		glDeleteSync(fence);
+		ring->fences[ring->segment] = NULL;
+	}
+}
+
+void freeUniformRing(UniformRing* ring) {
+	int i;
+
+	if (ring == NULL) return;
+
+	for (i = 0; i < ring->segments; i++) {
+		if (ring->fences[i] != NULL) glDeleteSync(ring->fences[i]);
+	}
+	glBindBuffer(GL_UNIFORM_BUFFER, ring->buffer);
+	glUnmapBuffer(GL_UNIFORM_BUFFER);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glDeleteBuffers(1, &ring->buffer);
+	free(ring);
+}
+
+bool setupShaderUniforms(Shader* shader) {
+	int i;
+
+	// Build uniform table then set texture uniform if tex0 used in shader
+	for (i = 0; i < 4; i++) shader->matrix_uniforms[i] = -1;
+	if (!buildShaderUniforms(shader)) {
+		printf("Failed to allocate uniform table: \"%s\"\n", shader->name);
 		return false;
 	}
+	setShaderUniform1i(shader, getShaderUniform(shader, "tex0"), 0);
+
+	// Resolve transform handles once for setShaderMatrices()
+	shader->matrix_uniforms[0] = getShaderUniform(shader, GLSL_UNIFORM_PROJECTION);
+	shader->matrix_uniforms[1] = getShaderUniform(shader, GLSL_UNIFORM_VIEW);
+	shader->matrix_uniforms[2] = getShaderUniform(shader, GLSL_UNIFORM_MODEL);
+	shader->matrix_uniforms[3] = getShaderUniform(shader, GLSL_UNIFORM_MVP);
 
 	return true;
 }
 
-bool compileShaderProgram(Shader* shader) {
-	int location;
+bool submitShaderProgram(Shader* shader) {
+	// Permutation shaders compile each variant on first use instead
+	if (shader->permutation != NULL) return true;
+
 	shader->ready = false;
+	shader->pending = false;
+	shader->program = 0;
+	shader->vert_shader = 0;
+	shader->frag_shader = 0;
+	shader->uniforms = NULL;
+	shader->num_uniforms = 0;
+	shader->compile_start = SDL_GetPerformanceCounter();
 
 	if (shader->vert_source == NULL || shader->frag_source == NULL) return false;
 
-	// Clear GL last error to detect any new error prior to final return
-	glGetError();
+	// Use cached program binary when available
+	if (SHADER_CACHE_ENABLED) {
+		if (loadCachedShaderProgram(shader, getShaderCacheKey(shader))) {
+			shader->ready = true;
+			return setupShaderUniforms(shader);
+		}
+		SHADER_CACHE_STATS.misses++;
+	}
 
 	// Create GL program for shader
 	shader->program = glCreateProgramObject();
+	if (SHADER_CACHE_ENABLED) glProgramParameteri(shader->program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 
-	// Create and compile vertex shader
-	shader->vert_shader = glCreateShaderObject(GL_VERTEX_SHADER_ARB);
-	if (!compileShader(shader->vert_shader, shader->vert_source)) return false;
-
-	// Create and compile fragment shader
-	shader->frag_shader = glCreateShaderObject(GL_FRAGMENT_SHADER_ARB);
-	if (!compileShader(shader->frag_shader, shader->frag_source)) return false;
+	// Get vertex and fragment stages (compiled once per unique source)
+	shader->vert_shader = acquireShaderStage(GL_VERTEX_SHADER_ARB, shader->vert_source, shader->vert_source_len);
+	shader->frag_shader = acquireShaderStage(GL_FRAGMENT_SHADER_ARB, shader->frag_source, shader->frag_source_len);
+	if (!shader->vert_shader || !shader->frag_shader) return false;
 
 	// Link compiled shaders with GL program
-	if (!linkCompiledShadersWithProgram(shader)) return false;
+	linkCompiledShadersWithProgram(shader);
+
+	shader->pending = true;
+
+	return true;
+}
+
+bool finishShaderProgram(Shader* shader) {
+	double compile_ms;
+	shader->pending = false;
 
-	// Set texture uniform if tex0 used in shader
-	glUseProgramObject(shader->program);
-	location = glGetUniformLocation(shader->program, "tex0");
-	if (location >= 0) glUniform1i(location, 0);
-	glUseProgramObject(0);
+	// Check compile and link statuses (blocks until driver is done with program)
+	if (!checkShaderCompiled(shader->vert_shader, shader->vert_source)) return false;
+	if (!checkShaderCompiled(shader->frag_shader, shader->frag_source)) return false;
+	if (!checkShaderLinked(shader)) return false;
+
+	// Store linked binary for next run
+	if (SHADER_CACHE_ENABLED) {
+		compile_ms = elapsedMilliseconds(shader->compile_start);
+		SHADER_CACHE_STATS.compile_ms += compile_ms;
+		if (!saveCachedShaderProgram(shader, getShaderCacheKey(shader), compile_ms)) {
+			printf("Unable to cache shader binary: \"%s\"\n", shader->name);
+		}
+	}
 
 	shader->ready = true;
 
+	return setupShaderUniforms(shader);
+}
+
+bool compileShaderProgram(Shader* shader) {
+	// Clear GL last error to detect any new error prior to final return
+	glGetError();
+
+	if (!submitShaderProgram(shader)) return false;
+	if (shader->pending && !finishShaderProgram(shader)) return false;
+
 	return glGetError() == GL_NO_ERROR;
 }
 
@@ -105,9 +808,11 @@ void destroyShaderProgram(Shader* shader)
 {
 	// Free shaders and GL program if they exist
 	if (SDL_GLSL_SUPPORTED && SDL_GLSL_READY) {
-		glDeleteObject(shader->vert_shader);
-		glDeleteObject(shader->frag_shader);
-		glDeleteObject(shader->program);
+		if (shader->program && glStateGetProgram() == shader->program) glStateUseProgram(0);
+		if (shader->program) glDeleteObject(shader->program);
+		freeShaderUniforms(shader);
+		if (shader->vert_shader) releaseShaderStage(shader->vert_shader);
+		if (shader->frag_shader) releaseShaderStage(shader->frag_shader);
 	}
 }
 
@@ -121,12 +826,56 @@ bool initShaders() {
 	// Placeholder for init if ever needed
 	// Put code here...
 
-	// Uncomment if-block createMissingGlShaderFunctions if gl<shader> functions missing from SDL_opengl*
-	if (!createMissingGlShaderFunctions()) SDL_GLSL_SUPPORTED = false;
+	// Probe every capability tier; shaders load from GL 2.0 core when available, else GL_ARB_shader_objects
+	createGLFunctions();
+	if (!GL_CAPABILITIES.core_20 && !GL_CAPABILITIES.shader_objects) SDL_GLSL_SUPPORTED = false;
+
+	// Optional program binary support for shader cache
+	SHADER_CACHE_SUPPORTED = SDL_GLSL_SUPPORTED && createProgramBinaryFunctions();
+
+	// Optional driver-side parallel compile for compileShadersAsync()
+	PARALLEL_COMPILE_SUPPORTED = SDL_GLSL_SUPPORTED && createParallelShaderCompileFunctions();
+
+	// Optional uniform buffers for uniform blocks and UniformRing
+	UNIFORM_BUFFER_SUPPORTED = SDL_GLSL_SUPPORTED && createUniformBufferFunctions();
 
 	return SDL_GLSL_SUPPORTED;
 }
 
+bool enableShaderCache(const char* directory) {
+	SHADER_CACHE_ENABLED = false;
+
+	if (!SHADER_CACHE_SUPPORTED) {
+		SDL_SetError("Shader cache unsupported: GL_ARB_get_program_binary unavailable or shaders not initialized");
+		return false;
+	}
+
+	if (strlen(directory) + 30 > MAX_PATH_SIZE) {
+		SDL_SetError("Shader cache directory path too long: \"%s\"", directory);
+		return false;
+	}
+	snprintf(SHADER_CACHE_DIR, MAX_PATH_SIZE, "%s", directory);
+
+	// Binaries are only valid for the driver that created them
+	SHADER_CACHE_CONTEXT_HASH = FNV_OFFSET_BASIS;
+	SHADER_CACHE_CONTEXT_HASH = hashString(SHADER_CACHE_CONTEXT_HASH, (const char*)glGetString(GL_VENDOR));
+	SHADER_CACHE_CONTEXT_HASH = hashString(SHADER_CACHE_CONTEXT_HASH, (const char*)glGetString(GL_RENDERER));
+	SHADER_CACHE_CONTEXT_HASH = hashString(SHADER_CACHE_CONTEXT_HASH, (const char*)glGetString(GL_VERSION));
+
+	memset(&SHADER_CACHE_STATS, 0, sizeof(ShaderCacheStats));
+	SHADER_CACHE_ENABLED = true;
+
+	return true;
+}
+
+void disableShaderCache() {
+	SHADER_CACHE_ENABLED = false;
+}
+
+ShaderCacheStats getShaderCacheStats() {
+	return SHADER_CACHE_STATS;
+}
+
 bool compileShaders(Shader* shaders, int num_shaders) {
 	int i;
 	SHADER_COUNT = num_shaders;
@@ -147,80 +896,795 @@ bool compileShaders(Shader* shaders, int num_shaders) {
 	return SDL_GLSL_READY;
 }
 
+bool compileShadersAsync(Shader* shaders, int num_shaders, unsigned int threads) {
+	int i;
+	SHADER_COUNT = num_shaders;
+	SDL_GLSL_READY = false;
+
+	if (!SDL_GLSL_SUPPORTED) {
+		printf("Unable to compile shaders: shaders not supported");
+		return false;
+	}
+
+	if (PARALLEL_COMPILE_SUPPORTED) glMaxShaderCompilerThreads(threads);
+
+	// Issue every compile and link before checking any status
+	for (i = 0; i < SHADER_COUNT; i++) {
+		if (!submitShaderProgram(&shaders[i])) {
+			printf("Unable to compile shader: \"%s\"\n", shaders[i].name);
+		}
+	}
+
+	// Ready to draw; individual shaders become ready via updateShaders()
+	SDL_GLSL_READY = true;
+
+	return SDL_GLSL_READY;
+}
+
+int updateShaders(Shader* shaders, int num_shaders) {
+	int i;
+	int complete;
+	int pending = 0;
+
+	if (!SDL_GLSL_SUPPORTED || !SDL_GLSL_READY) return 0;
+
+	for (i = 0; i < num_shaders; i++) {
+		if (!shaders[i].pending) continue;
+
+		// Skip programs the driver is still working on (non-blocking query)
+		if (PARALLEL_COMPILE_SUPPORTED) {
+			glGetProgramiv(shaders[i].program, GL_COMPLETION_STATUS_KHR, &complete);
+			if (complete == GL_FALSE) {
+				pending++;
+				continue;
+			}
+		}
+
+		if (!finishShaderProgram(&shaders[i])) {
+			printf("Unable to compile shader: \"%s\"\n", shaders[i].name);
+		}
+	}
+
+	return pending;
+}
+
+bool compileShaderAsync(Shader* shader) {
+	if (!SDL_GLSL_SUPPORTED) return false;
+
+	return submitShaderProgram(shader);
+}
+
+bool swapShaderProgram(Shader* shader, Shader* replacement) {
+	bool swapped = replacement->ready;
+
+	if (swapped) {
+		// Previous program is only destroyed once its replacement linked
+		destroyShaderProgram(shader);
+		releaseShaderSource(shader->vert_source);
+		releaseShaderSource(shader->frag_source);
+		free(replacement->name);
+
+		shader->ready = true;
+		shader->pending = false;
+		shader->program = replacement->program;
+		shader->vert_shader = replacement->vert_shader;
+		shader->frag_shader = replacement->frag_shader;
+		shader->vert_source = replacement->vert_source;
+		shader->frag_source = replacement->frag_source;
+		shader->vert_source_len = replacement->vert_source_len;
+		shader->frag_source_len = replacement->frag_source_len;
+		shader->uniforms = replacement->uniforms;
+		shader->num_uniforms = replacement->num_uniforms;
+		memcpy(shader->matrix_uniforms, replacement->matrix_uniforms, sizeof(shader->matrix_uniforms));
+	} else {
+		destroyShaderProgram(replacement);
+		free(replacement->name);
+		free(replacement->vert_source);
+		free(replacement->frag_source);
+	}
+	memset(replacement, 0, sizeof(Shader));
+
+	return swapped;
+}
+
+void freeShaderPermutation(Shader* shader) {
+	int i;
+	ShaderPermutation* permutation = shader->permutation;
+
+	for (i = 0; i < permutation->num_variants; i++) {
+		free(permutation->variants[i]->shader.name);
+		free(permutation->variants[i]->shader.vert_source);
+		free(permutation->variants[i]->shader.frag_source);
+		destroyShaderProgram(&permutation->variants[i]->shader);
+		free(permutation->variants[i]);
+	}
+	for (i = 0; i < permutation->num_features; i++) free(permutation->features[i]);
+	free(permutation->variants);
+	free(permutation->vert_filename);
+	free(permutation->frag_filename);
+	free(permutation);
+	shader->permutation = NULL;
+}
+
 void freeShaders(Shader* shaders) {
 	int i;
 
 	for (i = 0; i < SHADER_COUNT; i++) {
 		// Free shader sources
 		free(shaders[i].name);
-		free(shaders[i].vert_source);
-		free(shaders[i].frag_source);
+		releaseShaderSource(shaders[i].vert_source);
+		releaseShaderSource(shaders[i].frag_source);
 
 		// Free shaders and GL program
 		destroyShaderProgram(&shaders[i]);
+
+		// Free permutation variants
+		if (shaders[i].permutation != NULL) freeShaderPermutation(&shaders[i]);
 	}
 }
 
 void glslShaderDraw(Shader* shader, bool enable) {
 	if (SDL_GLSL_SUPPORTED && SDL_GLSL_READY) {
-		if (enable && shader->ready) glUseProgramObject(shader->program);
-		else glUseProgramObject(0);
+		// Permutation shaders draw variant for current feature mask
+		if (enable) shader = getShaderVariant(shader, shader->features);
+		if (enable && shader != NULL && shader->ready) glStateUseProgram(shader->program);
+		else glStateUseProgram(0);
 	}
 }
 
-char* readSourceFromFile(FILE* file) {
-	int size;
-	char line[MAX_LINE_SIZE];
+char* readSourceFromFile(FILE* file, int* length) {
+	long size;
 	char* dest_str;
-	void* realloc_ptr;
 
-	// Init destination string
-	dest_str = (char*)malloc(sizeof(char) * MAX_SOURCE_SIZE);
-	dest_str[0] = '\0';
+	// Size file so source is read in a single pass
+	if (fseek(file, 0, SEEK_END) != 0) return NULL;
+	size = ftell(file);
+	if (size < 0 || size > INT_MAX - 1 || fseek(file, 0, SEEK_SET) != 0) return NULL;
 
-	// Get source lines
-	while (fgets(line, MAX_LINE_SIZE, file) != NULL) {
-		strncat(dest_str, line, MAX_SOURCE_SIZE);
+	// Read whole source; NULL dest_str should be handled by calling function
+	// (one spare byte so stripGLSLSource() can end an unterminated last line)
+	dest_str = (char*)malloc(sizeof(char) * (size + 2));
+	if (dest_str == NULL) return NULL;
+	if (fread(dest_str, sizeof(char), size, file) != (size_t)size) {
+		free(dest_str);
+		return NULL;
 	}
 
-	// Cleanup destination string; NULL dest_str should be handled by calling function
-	size = strlen(dest_str) + 1;
-	realloc_ptr = realloc(dest_str, sizeof(char) * size);
-	if (realloc_ptr == NULL) free(dest_str);
-	dest_str = (char*)realloc_ptr;
+	// Terminate for logging; length is given to glShaderSource
+	dest_str[size] = '\0';
+	*length = (int)size;
 
 	return dest_str;
 }
 
-int loadGLSLFile(Shader* target, int type, const char* filename) {
-	int filename_len;
+char* readSourceFromFilename(const char* filename, int* length) {
+	char* source;
 	FILE* file;
-	
-	file = fopen(filename, "r");
+
+	file = fopen(filename, "rb");
 	if (file == NULL) {
 		SDL_SetError("Failed to load file: \"%s\"\n", filename);
-		if (type == GLSL_VERT) target->vert_source = NULL;
-		else if (type == GLSL_FRAG) target->frag_source = NULL;
-		return 1;
+		return NULL;
+	}
+	source = readSourceFromFile(file, length);
+	fclose(file);
+	if (source == NULL) SDL_SetError("Failed to load source from file \"%s\"", filename);
+
+	return source;
+}
+
+char* copySource(const char* source, int length) {
+	char* copy = (char*)malloc(sizeof(char) * (length + 1));
+	if (copy != NULL) memcpy(copy, source, length + 1);
+	return copy;
+}
+
+int stripGLSLSource(char* source, int length) {
+	int read = 0;
+	int write = 0;
+	int line_start;
+	bool newline;
+
+	// Remove comments (block comments spanning lines keep a line break)
+	while (read < length) {
+		if (source[read] == '/' && read + 1 < length && source[read + 1] == '/') {
+			while (read < length && source[read] != '\n') read++;
+		} else if (source[read] == '/' && read + 1 < length && source[read + 1] == '*') {
+			newline = false;
+			read += 2;
+			while (read < length && !(source[read] == '*' && read + 1 < length && source[read + 1] == '/')) {
+				if (source[read] == '\n') newline = true;
+				read++;
+			}
+			read = read + 2 > length ? length : read + 2;
+			source[write++] = newline ? '\n' : ' ';
+		} else {
+			source[write++] = source[read++];
+		}
+	}
+	length = write;
+
+	// Trim each line and drop blank lines
+	read = 0;
+	write = 0;
+	while (read < length) {
+		while (read < length && (source[read] == ' ' || source[read] == '\t' || source[read] == '\r')) read++;
+		line_start = write;
+		while (read < length && source[read] != '\n') source[write++] = source[read++];
+		read++;
+		while (write > line_start && (source[write - 1] == ' ' || source[write - 1] == '\t' || source[write - 1] == '\r')) write--;
+		if (write > line_start) source[write++] = '\n';
+	}
+	source[write] = '\0';
+
+	return write;
+}
+
+bool appendSource(SourceBuffer* buffer, const char* text, int length) {
+	int capacity;
+	void* realloc_ptr;
+
+	// Grow by doubling; always keep room for terminator
+	capacity = buffer->capacity ? buffer->capacity : 1024;
+	while (buffer->length + length + 1 > capacity) capacity *= 2;
+	if (capacity != buffer->capacity) {
+		realloc_ptr = realloc(buffer->data, sizeof(char) * capacity);
+		if (realloc_ptr == NULL) return false;
+		buffer->data = (char*)realloc_ptr;
+		buffer->capacity = capacity;
+	}
+
+	memcpy(buffer->data + buffer->length, text, length);
+	buffer->length += length;
+	buffer->data[buffer->length] = '\0';
+
+	return true;
+}
+
+int findGLSLFile(const char* filename) {
+	int i;
+
+	for (i = 0; i < GLSL_FILE_COUNT; i++) {
+		if (strcmp(GLSL_FILES[i].filename, filename) == 0) return i;
+	}
+
+	return -1;
+}
+
+int addGLSLFile(const char* filename) {
+	void* realloc_ptr;
+	GLSLFile* file;
+
+	if (GLSL_FILE_COUNT == GLSL_FILE_CAPACITY) {
+		realloc_ptr = realloc(GLSL_FILES, sizeof(GLSLFile) * (GLSL_FILE_CAPACITY ? GLSL_FILE_CAPACITY * 2 : 16));
+		if (realloc_ptr == NULL) return -1;
+		GLSL_FILES = (GLSLFile*)realloc_ptr;
+		GLSL_FILE_CAPACITY = GLSL_FILE_CAPACITY ? GLSL_FILE_CAPACITY * 2 : 16;
+	}
+
+	file = &GLSL_FILES[GLSL_FILE_COUNT];
+	memset(file, 0, sizeof(GLSLFile));
+	file->filename = copySource(filename, strlen(filename));
+	file->stale = true;
+	if (file->filename == NULL) return -1;
+
+	return GLSL_FILE_COUNT++;
+}
+
+bool getIncludePath(const char* filename, const char* directive, const char* end, char* path) {
+	int dir_length = 0;
+	const char* name;
+	const char* name_end;
+	const char* slash;
+
+	// Accept #include "name" or #include <name>
+	name = directive;
+	while (name < end && (*name == ' ' || *name == '\t')) name++;
+	if (name >= end || (*name != '"' && *name != '<')) return false;
+	name_end = name + 1;
+	while (name_end < end && *name_end != '"' && *name_end != '>') name_end++;
+	if (name_end >= end) return false;
+	name++;
+
+	// Resolve relative to including file unless absolute
+	if (name[0] != '/' && name[0] != '\\' && !(name_end - name > 1 && name[1] == ':')) {
+		for (slash = filename; *slash != '\0'; slash++) {
+			if (*slash == '/' || *slash == '\\') dir_length = slash - filename + 1;
+		}
+	}
+	if (dir_length + (name_end - name) + 1 > MAX_PATH_SIZE) return false;
+
+	memcpy(path, filename, dir_length);
+	memcpy(path + dir_length, name, name_end - name);
+	path[dir_length + (name_end - name)] = '\0';
+
+	return true;
+}
+
+int expandGLSLFile(const char* filename) {
+	int index;
+	int child;
+	int length;
+	bool success = true;
+	char* raw;
+	char* line;
+	char* end;
+	char include_path[MAX_PATH_SIZE];
+	void* realloc_ptr;
+
+	// Use memoized file unless it (or one of its includes) changed
+	index = findGLSLFile(filename);
+	if (index >= 0) {
+		if (GLSL_FILES[index].expanding) {
+			SDL_SetError("Circular #include of \"%s\"", filename);
+			return -1;
+		}
+		if (!GLSL_FILES[index].stale) return index;
+	} else {
+		index = addGLSLFile(filename);
+		if (index < 0) {
+			SDL_SetError("Failed to allocate GLSL file \"%s\"", filename);
+			return -1;
+		}
+	}
+
+	raw = readSourceFromFilename(filename, &length);
+	if (raw == NULL) return -1;
+	length = stripGLSLSource(raw, length);
+
+	// Reset previous source and dependency edges
+	free(GLSL_FILES[index].source);
+	free(GLSL_FILES[index].includes);
+	GLSL_FILES[index].source = NULL;
+	GLSL_FILES[index].includes = NULL;
+	GLSL_FILES[index].num_includes = 0;
+	GLSL_FILES[index].expanding = true;
+
+	// Resolve and load includes line by line (stripped source always ends lines with '\n')
+	for (line = raw; line < raw + length; line = end + 1) {
+		end = strchr(line, '\n');
+		if (strncmp(line, "#include", 8) != 0) continue;
+
+		if (!getIncludePath(filename, line + 8, end, include_path)) {
+			SDL_SetError("Invalid #include in \"%s\": %.*s", filename, (int)(end - line), line);
+			success = false;
+			break;
+		}
+		child = expandGLSLFile(include_path);
+		if (child < 0) {
+			success = false;
+			break;
+		}
+
+		// Record dependency edge for pasting and invalidation
+		realloc_ptr = realloc(GLSL_FILES[index].includes, sizeof(int) * (GLSL_FILES[index].num_includes + 1));
+		if (realloc_ptr == NULL) {
+			SDL_SetError("Failed to allocate includes of \"%s\"", filename);
+			success = false;
+			break;
+		}
+		GLSL_FILES[index].includes = (int*)realloc_ptr;
+		GLSL_FILES[index].includes[GLSL_FILES[index].num_includes++] = child;
+	}
+
+	GLSL_FILES[index].expanding = false;
+	if (!success) {
+		free(raw);
+		GLSL_FILES[index].num_includes = 0;
+		return -1;
 	}
 
-	filename_len = strlen(filename);
-	target->name = (char*)malloc(sizeof(char) * (filename_len + 1));
-	strncpy(target->name, filename, filename_len + 1);
+	GLSL_FILES[index].source = raw;
+	GLSL_FILES[index].length = length;
+	GLSL_FILES[index].stale = false;
+
+	return index;
+}
+
+bool appendGLSLFile(SourceBuffer* buffer, int index, int offset) {
+	int include = 0;
+	int child;
+	const char* line;
+	const char* end;
+	const char* source = GLSL_FILES[index].source;
+
+	// Paste each #include at its first occurrence in this build only (eg: diamond includes)
+	for (line = source + offset; line < source + GLSL_FILES[index].length; line = end + 1) {
+		end = strchr(line, '\n');
+		if (strncmp(line, "#include", 8) != 0) {
+			if (!appendSource(buffer, line, end - line + 1)) return false;
+			continue;
+		}
+
+		child = GLSL_FILES[index].includes[include++];
+		if (GLSL_FILES[child].included == GLSL_BUILD_STAMP) continue;
+		GLSL_FILES[child].included = GLSL_BUILD_STAMP;
+		if (!appendGLSLFile(buffer, child, 0)) return false;
+	}
+
+	return true;
+}
+
+char* buildGLSLSource(const char* filename, const char** defines, int num_defines, int* length) {
+	int i;
+	int index;
+	int version_length = 0;
+	bool success;
+	const char* source;
+	SourceBuffer buffer = { NULL, 0, 0 };
+
+	index = expandGLSLFile(filename);
+	if (index < 0) return NULL;
+	source = GLSL_FILES[index].source;
+
+	// Keep #version as first line; defines follow it
+	if (strncmp(source, "#version", 8) == 0) version_length = strchr(source, '\n') - source + 1;
+	success = appendSource(&buffer, source, version_length);
+	for (i = 0; success && i < num_defines; i++) {
+		success = appendSource(&buffer, "#define ", 8) &&
+			appendSource(&buffer, defines[i], strlen(defines[i])) &&
+			appendSource(&buffer, "\n", 1);
+	}
+	GLSL_BUILD_STAMP++;
+	GLSL_FILES[index].included = GLSL_BUILD_STAMP;
+	if (success) success = appendGLSLFile(&buffer, index, version_length);
+
+	// Empty files still need a terminated source
+	if (success && buffer.data == NULL) success = appendSource(&buffer, "", 0);
+
+	if (!success) {
+		free(buffer.data);
+		SDL_SetError("Failed to allocate GLSL source for \"%s\"", filename);
+		return NULL;
+	}
+
+	*length = buffer.length;
+	return buffer.data;
+}
+
+int preprocessGLSLFile(Shader* target, int type, const char* filename, const char** defines, int num_defines) {
+	int length = 0;
+	char* source;
+
+	lockGLSLFiles();
+	source = buildGLSLSource(filename, defines, num_defines, &length);
+	SDL_UnlockMutex(GLSL_FILES_LOCK);
+
+	if (source != NULL) target->name = copySource(filename, strlen(filename));
+	target->features = 0;
+	target->permutation = NULL;
 
 	if (type == GLSL_VERT) {
-		target->vert_source = readSourceFromFile(file);
-		if (target->vert_source == NULL) {
-			SDL_SetError("Failed to load vertex source from file \"%s\"", filename);
-			return 1;
+		target->vert_source = source;
+		target->vert_source_len = length;
+		if (source == NULL) {
+			SDL_SetError("Failed to load vertex source from file \"%s\" | %s", filename, SDL_GetError());
+			return GLSL_FAILURE;
 		}
 	} else if (type == GLSL_FRAG) {
-		target->frag_source = readSourceFromFile(file);
-		if (target->frag_source == NULL) {
-			SDL_SetError("Failed to load fragment source from file \"%s\"", filename);
-			return 1;
+		target->frag_source = source;
+		target->frag_source_len = length;
+		if (source == NULL) {
+			SDL_SetError("Failed to load fragment source from file \"%s\" | %s", filename, SDL_GetError());
+			return GLSL_FAILURE;
+		}
+	}
+
+	return GLSL_SUCCESS;
+}
+
+void invalidateGLSLFile(const char* filename) {
+	int i, j;
+	int index;
+	bool changed = true;
+
+	lockGLSLFiles();
+	index = findGLSLFile(filename);
+	if (index < 0) {
+		SDL_UnlockMutex(GLSL_FILES_LOCK);
+		return;
+	}
+	GLSL_FILES[index].stale = true;
+
+	// Propagate to every file including a stale file (directly or indirectly)
+	while (changed) {
+		changed = false;
+		for (i = 0; i < GLSL_FILE_COUNT; i++) {
+			if (GLSL_FILES[i].stale) continue;
+			for (j = 0; j < GLSL_FILES[i].num_includes; j++) {
+				if (GLSL_FILES[GLSL_FILES[i].includes[j]].stale) {
+					GLSL_FILES[i].stale = true;
+					changed = true;
+					break;
+				}
+			}
+		}
+	}
+	SDL_UnlockMutex(GLSL_FILES_LOCK);
+}
+
+void freeGLSLFiles() {
+	int i;
+
+	lockGLSLFiles();
+	for (i = 0; i < GLSL_FILE_COUNT; i++) {
+		free(GLSL_FILES[i].filename);
+		free(GLSL_FILES[i].source);
+		free(GLSL_FILES[i].includes);
+	}
+	free(GLSL_FILES);
+	GLSL_FILES = NULL;
+	GLSL_FILE_COUNT = 0;
+	GLSL_FILE_CAPACITY = 0;
+	SDL_UnlockMutex(GLSL_FILES_LOCK);
+}
+
+void visitGLSLFile(int index, GLSLFileFunction function, void* data) {
+	int i;
+
+	// Expansion rejects circular includes, so recursion always ends
+	function(GLSL_FILES[index].filename, data);
+	for (i = 0; i < GLSL_FILES[index].num_includes; i++) visitGLSLFile(GLSL_FILES[index].includes[i], function, data);
+}
+
+void forEachGLSLInclude(const char* filename, GLSLFileFunction function, void* data) {
+	int index;
+
+	lockGLSLFiles();
+	index = findGLSLFile(filename);
+	if (index >= 0) visitGLSLFile(index, function, data);
+	SDL_UnlockMutex(GLSL_FILES_LOCK);
+}
+
+int loadGLSLFile(Shader* target, int type, const char* filename) {
+	return preprocessGLSLFile(target, type, filename, NULL, 0);
+}
+
+int loadGLSLFiles(Shader* targets, const char** vert_filenames, const char** frag_filenames, int num_shaders) {
+	int i;
+	int result = GLSL_SUCCESS;
+	Shader* target;
+
+	// Files repeated within the list are read once (memoized by preprocessor)
+	lockGLSLFiles();
+	for (i = 0; i < num_shaders; i++) {
+		target = &targets[i];
+		target->features = 0;
+		target->permutation = NULL;
+		target->name = copySource(frag_filenames[i], strlen(frag_filenames[i]));
+		target->vert_source = buildGLSLSource(vert_filenames[i], NULL, 0, &target->vert_source_len);
+		target->frag_source = buildGLSLSource(frag_filenames[i], NULL, 0, &target->frag_source_len);
+		if (target->vert_source == NULL || target->frag_source == NULL) result = GLSL_FAILURE;
+	}
+	SDL_UnlockMutex(GLSL_FILES_LOCK);
+
+	return result;
+}
+
+int loadGLSLMatrix(Shader* targets, const char** vert_filenames, int num_verts, const char** frag_filenames, int num_frags) {
+	int v, f;
+	int length;
+	int result = GLSL_SUCCESS;
+	char* source;
+	Shader* target;
+
+	// Fill every vertex x fragment pairing; each file is read once (memoized by preprocessor)
+	lockGLSLFiles();
+	for (v = 0; v < num_verts; v++) {
+		for (f = 0; f < num_frags; f++) {
+			target = &targets[v * num_frags + f];
+			target->features = 0;
+			target->permutation = NULL;
+			target->name = copySource(frag_filenames[f], strlen(frag_filenames[f]));
+			target->vert_source = NULL;
+			target->frag_source = NULL;
+			target->vert_source_len = 0;
+			target->frag_source_len = 0;
+		}
+	}
+
+	// Build each stage once and share it along its row/column; identical stages compile once via stage cache
+	for (v = 0; v < num_verts; v++) {
+		source = buildGLSLSource(vert_filenames[v], NULL, 0, &length);
+		if (source == NULL || (num_frags > 1 && !shareShaderSource(source, num_frags))) {
+			free(source);
+			result = GLSL_FAILURE;
+			continue;
+		}
+		for (f = 0; f < num_frags; f++) {
+			targets[v * num_frags + f].vert_source = source;
+			targets[v * num_frags + f].vert_source_len = length;
+		}
+	}
+	for (f = 0; f < num_frags; f++) {
+		source = buildGLSLSource(frag_filenames[f], NULL, 0, &length);
+		if (source == NULL || (num_verts > 1 && !shareShaderSource(source, num_verts))) {
+			free(source);
+			result = GLSL_FAILURE;
+			continue;
+		}
+		for (v = 0; v < num_verts; v++) {
+			targets[v * num_frags + f].frag_source = source;
+			targets[v * num_frags + f].frag_source_len = length;
 		}
 	}
+	SDL_UnlockMutex(GLSL_FILES_LOCK);
+
+	return result;
+}
+
+int loadShaderPermutations(Shader* target, const char* vert_filename, const char* frag_filename, const char** features, int num_features) {
+	int i;
+	bool success;
+	ShaderPermutation* permutation;
+
+	memset(target, 0, sizeof(Shader));
+	if (num_features < 0 || num_features > GLSL_MAX_FEATURES) {
+		SDL_SetError("Too many shader features: %d (max %d)", num_features, GLSL_MAX_FEATURES);
+		return GLSL_FAILURE;
+	}
+
+	// Read both files now so missing or circular sources fail at load rather than first draw
+	lockGLSLFiles();
+	success = expandGLSLFile(vert_filename) >= 0 && expandGLSLFile(frag_filename) >= 0;
+	SDL_UnlockMutex(GLSL_FILES_LOCK);
+	if (!success) {
+		SDL_SetError("Failed to load permutation shader \"%s\" | %s", frag_filename, SDL_GetError());
+		return GLSL_FAILURE;
+	}
+
+	permutation = (ShaderPermutation*)calloc(1, sizeof(ShaderPermutation));
+	if (permutation == NULL) {
+		SDL_SetError("Failed to allocate permutation shader \"%s\"", frag_filename);
+		return GLSL_FAILURE;
+	}
+	target->permutation = permutation;
+	target->name = copySource(frag_filename, strlen(frag_filename));
+	permutation->vert_filename = copySource(vert_filename, strlen(vert_filename));
+	permutation->frag_filename = copySource(frag_filename, strlen(frag_filename));
+	success = target->name != NULL && permutation->vert_filename != NULL && permutation->frag_filename != NULL;
+	for (i = 0; i < num_features; i++) {
+		permutation->features[i] = copySource(features[i], strlen(features[i]));
+		if (permutation->features[i] == NULL) success = false;
+	}
+	permutation->num_features = num_features;
+
+	if (!success) {
+		free(target->name);
+		freeShaderPermutation(target);
+		memset(target, 0, sizeof(Shader));
+		SDL_SetError("Failed to allocate permutation shader \"%s\"", frag_filename);
+		return GLSL_FAILURE;
+	}
+
+	return GLSL_SUCCESS;
+}
+
+Uint32 getShaderFeature(Shader* shader, const char* name) {
+	int i;
+
+	if (shader == NULL || shader->permutation == NULL) return 0;
+
+	for (i = 0; i < shader->permutation->num_features; i++) {
+		if (strcmp(shader->permutation->features[i], name) == 0) return (Uint32)1 << i;
+	}
 
 	return 0;
 }
+
+ShaderVariant* findShaderVariant(ShaderPermutation* permutation, Uint32 features) {
+	int i;
+
+	if (permutation->last != NULL && permutation->last->features == features) return permutation->last;
+
+	for (i = 0; i < permutation->num_variants; i++) {
+		if (permutation->variants[i]->features == features) {
+			permutation->last = permutation->variants[i];
+			return permutation->last;
+		}
+	}
+
+	return NULL;
+}
+
+ShaderVariant* addShaderVariant(ShaderPermutation* permutation, Uint32 features) {
+	int i;
+	int capacity;
+	size_t name_length;
+	const char* defines[GLSL_MAX_FEATURES];
+	int num_defines = 0;
+	ShaderVariant* variant;
+	Shader* shader;
+	void* realloc_ptr;
+
+	// Grow table by doubling
+	if (permutation->num_variants == permutation->capacity) {
+		capacity = permutation->capacity ? permutation->capacity * 2 : 8;
+		realloc_ptr = realloc(permutation->variants, sizeof(ShaderVariant*) * capacity);
+		if (realloc_ptr == NULL) return NULL;
+		permutation->variants = (ShaderVariant**)realloc_ptr;
+		permutation->capacity = capacity;
+	}
+	variant = (ShaderVariant*)calloc(1, sizeof(ShaderVariant));
+	if (variant == NULL) return NULL;
+	variant->features = features;
+	shader = &variant->shader;
+
+	// Name as "frag_filename [FEATURE ...]" for compile errors
+	name_length = strlen(permutation->frag_filename) + 3;
+	for (i = 0; i < permutation->num_features; i++) {
+		if (!(features & ((Uint32)1 << i))) continue;
+		defines[num_defines++] = permutation->features[i];
+		name_length += strlen(permutation->features[i]) + 1;
+	}
+	shader->name = (char*)malloc(name_length + 1);
+	if (shader->name != NULL) {
+		strcpy(shader->name, permutation->frag_filename);
+		strcat(shader->name, " [");
+		for (i = 0; i < num_defines; i++) {
+			if (i > 0) strcat(shader->name, " ");
+			strcat(shader->name, defines[i]);
+		}
+		strcat(shader->name, "]");
+	}
+
+	// Sources come from memoized files; identical stages across variants share one compile
+	lockGLSLFiles();
+	shader->vert_source = buildGLSLSource(permutation->vert_filename, defines, num_defines, &shader->vert_source_len);
+	shader->frag_source = buildGLSLSource(permutation->frag_filename, defines, num_defines, &shader->frag_source_len);
+	SDL_UnlockMutex(GLSL_FILES_LOCK);
+
+	// Variants that fail to load or compile stay cached (unready) so they are not retried every draw
+	permutation->variants[permutation->num_variants++] = variant;
+	permutation->last = variant;
+
+	return variant;
+}
+
+Uint32 maskShaderFeatures(ShaderPermutation* permutation, Uint32 features) {
+	if (permutation->num_features == GLSL_MAX_FEATURES) return features;
+	return features & (((Uint32)1 << permutation->num_features) - 1);
+}
+
+Shader* getShaderVariant(Shader* shader, Uint32 features) {
+	ShaderVariant* variant;
+
+	if (shader == NULL || shader->permutation == NULL) return shader;
+
+	features = maskShaderFeatures(shader->permutation, features);
+	variant = findShaderVariant(shader->permutation, features);
+	if (variant == NULL) {
+		variant = addShaderVariant(shader->permutation, features);
+		if (variant == NULL) return NULL;
+
+		// First use compiles now (stage and binary caches still apply)
+		if (!SDL_GLSL_SUPPORTED || !compileShaderProgram(&variant->shader)) {
+			printf("Unable to compile shader: \"%s\"\n", variant->shader.name);
+		}
+	} else if (variant->shader.pending) {
+		// Prepared ahead; only waits for what the driver has left
+		if (!finishShaderProgram(&variant->shader)) {
+			printf("Unable to compile shader: \"%s\"\n", variant->shader.name);
+		}
+	}
+
+	return &variant->shader;
+}
+
+bool prepareShaderVariant(Shader* shader, Uint32 features) {
+	ShaderVariant* variant;
+
+	if (!SDL_GLSL_SUPPORTED || shader == NULL || shader->permutation == NULL) return false;
+
+	features = maskShaderFeatures(shader->permutation, features);
+	if (findShaderVariant(shader->permutation, features) != NULL) return true;
+
+	variant = addShaderVariant(shader->permutation, features);
+	if (variant == NULL) return false;
+	if (!compileShaderAsync(&variant->shader)) {
+		printf("Unable to compile shader: \"%s\"\n", variant->shader.name);
+		return false;
+	}
+
+	return true;
+}
\ No newline at end of file
@@ -5,33 +5,491 @@ extern "C"{
 
 #include <stdbool.h>
 
+#include <SDL.h>
 #include <SDL_opengl.h>
 
 extern bool SDL_GLSL_SUPPORTED;
 extern bool SDL_GLSL_READY;
 extern char SDL_GLSL_VERSION[10];
+extern bool PARALLEL_COMPILE_SUPPORTED; // GL_KHR/ARB_parallel_shader_compile (set by initShaders())
+
+typedef struct {
+	char* name;
+	Uint64 hash;
+	GLint location;
+	GLenum type;
+	GLint size;
+	bool shadowed;
+	union {
+		GLfloat f[16];
+		GLint i[4];
+	} value;
+} ShaderUniform;
 
 typedef struct {
 	bool ready;
+	bool pending;
 	GLhandleARB program;
 	GLhandleARB vert_shader;
 	GLhandleARB frag_shader;
 	char* name;
 	char* vert_source;
 	char* frag_source;
+	int vert_source_len;
+	int frag_source_len;
+	ShaderUniform* uniforms;
+	int num_uniforms;
+	int matrix_uniforms[4];                // Handles set by setShaderMatrices(), resolved once after link
+	Uint64 compile_start;                  // Performance counter at submit (times each compile separately)
+	Uint32 features;                       // Variant drawn by glslShaderDraw() (permutation shaders only)
+	struct ShaderPermutation* permutation; // Variant table from loadShaderPermutations(), else NULL
 } Shader;
 
 #define GLSL_SUCCESS 0x0000
 #define GLSL_FAILURE 0x0001
 #define GLSL_VERT 0x0100
 #define GLSL_FRAG 0x0101
+#define GLSL_COMPILER_THREADS_MAX 0xFFFFFFFF
+#define GLSL_UNIFORM_RING_MAX_FRAMES 4
+#define FNV_OFFSET_BASIS (0xcbf29ce484222325ULL) // FNV-1a, see hashSource()
+#define FNV_PRIME (0x100000001b3ULL)
+#define GLSL_MAX_FEATURES 32 // Feature flags per permutation shader (bits of Shader.features)
+
+// Uniform names set by setShaderMatrices()
+#define GLSL_UNIFORM_PROJECTION "u_projection"
+#define GLSL_UNIFORM_VIEW "u_view"
+#define GLSL_UNIFORM_MODEL "u_model"
+#define GLSL_UNIFORM_MVP "u_model_view_projection"
+
+typedef struct {
+	GLuint buffer;
+	Uint8* mapped;
+	GLsizeiptr segment_size;
+	GLsizeiptr offset;
+	GLint alignment;
+	int segments;
+	int segment;
+	GLsync fences[GLSL_UNIFORM_RING_MAX_FRAMES];
+} UniformRing;
+
+typedef struct {
+	int hits;
+	int misses;
+	int rejected;
+	double load_ms;
+	double compile_ms;
+	double saved_ms;
+} ShaderCacheStats;
 
 extern bool initShaders();
 extern bool compileShaders(Shader* shaders, int shaders_count);
+
+/**
+ * Issue compile and link of all shaders without waiting on the driver
+ *
+ * Status checks are deferred to updateShaders(); each Shader's ready flag
+ * flips once its program finishes, so rendering can start immediately
+ * (shaders not yet ready draw without a program via glslShaderDraw()).
+ *
+ * \param shaders Shaders with loaded sources
+ * \param num_shaders Number of shaders
+ * \param threads Driver compiler threads for GL_KHR/ARB_parallel_shader_compile
+ *                (GLSL_COMPILER_THREADS_MAX for driver maximum; 0 disables)
+ * \returns true if submitted, false if shaders unsupported
+ *
+ * \sa updateShaders
+ * \sa compileShaders
+ */
+extern bool compileShadersAsync(Shader* shaders, int num_shaders, unsigned int threads);
+
+/**
+ * Check pending shaders from compileShadersAsync() (call once per frame)
+ *
+ * \param shaders Shaders given to compileShadersAsync()
+ * \param num_shaders Number of shaders
+ * \returns Number of shaders still pending
+ *
+ * \warning Without parallel shader compile support the first call
+ *          blocks until all pending shaders finish.
+ *
+ * \sa compileShadersAsync
+ */
+extern int updateShaders(Shader* shaders, int num_shaders);
+
+/**
+ * Issue compile and link of a single shader without waiting on the driver
+ *
+ * Unlike compileShadersAsync(), shader is not added to the set freed by
+ * freeShaders(); poll with updateShaders(shader, 1) (eg: a replacement
+ * built while the original keeps drawing, see swapShaderProgram()).
+ *
+ * \param shader Shader with loaded sources
+ * \returns true if submitted, false if shaders unsupported or submit failed
+ *
+ * \sa swapShaderProgram
+ */
+extern bool compileShaderAsync(Shader* shader);
+
+/**
+ * Replace a shader's program with a finished replacement, only if it linked
+ *
+ * On success the replacement's program, uniforms and sources move into
+ * shader and the previous program is destroyed; otherwise shader is left
+ * untouched. The replacement is emptied either way.
+ * Uniform handles from getShaderUniform() must be fetched again after a swap.
+ *
+ * \param shader Shader to update (may be drawing)
+ * \param replacement Shader finished by compileShaderAsync() and updateShaders()
+ * \returns true if swapped, false if replacement failed (shader kept)
+ *
+ * \sa compileShaderAsync
+ */
+extern bool swapShaderProgram(Shader* shader, Shader* replacement);
+
 extern void freeShaders(Shader* shaders);
+
+/**
+ * Use shader program for following draws (or none)
+ *
+ * Shaders not yet ready draw without a program. Permutation shaders draw
+ * the variant selected by shader->features, compiling it on first use.
+ *
+ * \param shader Shader to draw with
+ * \param enable false to draw without a program
+ *
+ * \sa loadShaderPermutations
+ */
 extern void glslShaderDraw(Shader* shader, bool enable);
+
+/**
+ * Load one vertex + fragment source whose named feature flags expand to #define permutations
+ *
+ * Feature i is bit (1 << i) of a variant mask; each set bit adds
+ * "#define <features[i]>" to both stages. No program is compiled here:
+ * each variant compiles the first time it is drawn (set shader->features,
+ * then glslShaderDraw()) and is cached in the shader's variant table, so
+ * only variants a scene uses are paid for. Pass the shader to
+ * compileShaders() or compileShadersAsync() like any other (it is skipped
+ * there) and free it with freeShaders().
+ *
+ * \param target Shader to set up
+ * \param vert_filename Vertex shader file
+ * \param frag_filename Fragment shader file
+ * \param features Feature names, eg: "USE_TEXTURE" (copied)
+ * \param num_features Number of features (up to GLSL_MAX_FEATURES)
+ * \returns GLSL_SUCCESS or GLSL_FAILURE; call SDL_GetError() for more information.
+ *
+ * \warning Shader hot reload (watchShader()) does not support permutation shaders.
+ *
+ * \sa getShaderFeature
+ * \sa getShaderVariant
+ * \sa prepareShaderVariant
+ */
+extern int loadShaderPermutations(Shader* target, const char* vert_filename, const char* frag_filename, const char** features, int num_features);
+
+/**
+ * Get variant mask bit of a named feature
+ *
+ * \param shader Permutation shader
+ * \param name Feature name given to loadShaderPermutations()
+ * \returns Feature bit or 0 if not a feature of shader
+ */
+extern Uint32 getShaderFeature(Shader* shader, const char* name);
+
+/**
+ * Get (compiling on first use) the variant of a permutation shader for a feature mask
+ *
+ * Variants own their program and uniforms; use the returned shader with
+ * getShaderUniform() and setShaderUniform*() (handles are per variant).
+ * Bits without a feature are ignored.
+ *
+ * \param shader Permutation shader (other shaders are returned as-is)
+ * \param features Variant mask
+ * \returns Variant (check ready; failed variants stay cached and unready)
+ *          or NULL if out of memory
+ *
+ * \warning First use compiles (or finishes a prepared variant) on the calling thread.
+ *
+ * \sa prepareShaderVariant
+ */
+extern Shader* getShaderVariant(Shader* shader, Uint32 features);
+
+/**
+ * Submit a variant's compile without waiting on the driver (eg: variants a level uses, while loading)
+ *
+ * First use then only waits for whatever the driver has left.
+ *
+ * \param shader Permutation shader
+ * \param features Variant mask
+ * \returns true if submitted or already cached, false if shaders unsupported or submit failed
+ *
+ * \sa getShaderVariant
+ */
+extern bool prepareShaderVariant(Shader* shader, Uint32 features);
+
+/**
+ * Get handle to an active uniform of a ready shader
+ *
+ * Uniform table is built once after link; handles stay valid until the
+ * shader is freed or recompiled. Arrays are found by base name (eg: "lights").
+ *
+ * \param shader Shader to query
+ * \param name Uniform name
+ * \returns Uniform handle for setShaderUniform* or -1 if not active or shader not ready
+ *
+ * \sa setShaderUniform1f
+ */
+extern int getShaderUniform(Shader* shader, const char* name);
+
+/**
+ * Set uniform values by handle from getShaderUniform()
+ *
+ * Last value set is shadowed per uniform; setting an unchanged value
+ * makes no GL call. Shader is bound for the update if not already in use.
+ *
+ * \param shader Shader owning uniform
+ * \param uniform Handle from getShaderUniform(); -1 is ignored
+ *
+ * \sa getShaderUniform
+ */
+extern void setShaderUniform1f(Shader* shader, int uniform, float x);
+extern void setShaderUniform2f(Shader* shader, int uniform, float x, float y);
+extern void setShaderUniform3f(Shader* shader, int uniform, float x, float y, float z);
+extern void setShaderUniform4f(Shader* shader, int uniform, float x, float y, float z, float w);
+extern void setShaderUniform1i(Shader* shader, int uniform, int x);
+extern void setShaderUniform2i(Shader* shader, int uniform, int x, int y);
+extern void setShaderUniform3i(Shader* shader, int uniform, int x, int y, int z);
+extern void setShaderUniform4i(Shader* shader, int uniform, int x, int y, int z, int w);
+extern void setShaderUniformMatrix4f(Shader* shader, int uniform, const float* matrix);
+
+/**
+ * Set transform uniforms from CPU matrices (no GL matrix stack readback)
+ *
+ * Sets whichever of GLSL_UNIFORM_PROJECTION, GLSL_UNIFORM_VIEW,
+ * GLSL_UNIFORM_MODEL and GLSL_UNIFORM_MVP the shader declares, from
+ * PROJECTION_MATRIX, CAMERA_MATRIX and model. Unchanged values make no GL call.
+ * Handles are resolved once when the shader becomes ready (no name lookups per call).
+ *
+ * \param shader Shader owning uniforms
+ * \param model Model matrix (column-major) or NULL for identity
+ *
+ * \sa setShaderUniformMatrix4f
+ */
+extern void setShaderMatrices(Shader* shader, const float* model);
+
+/**
+ * Bind a shader's uniform block to a uniform buffer binding point
+ *
+ * \param shader Ready shader
+ * \param block_name Uniform block name in GLSL (eg: "DrawParams")
+ * \param binding Binding point later given to pushUniformRing()
+ * \returns true if bound, false if block not found or uniform buffers unsupported
+ *
+ * \sa pushUniformRing
+ */
+extern bool bindShaderUniformBlock(Shader* shader, const char* block_name, GLuint binding);
+
+/**
+ * Create ring allocator over a persistently mapped uniform buffer
+ *
+ * Buffer is split into one segment per frame in flight; each segment is
+ * fenced when the frame ends and only rewritten once the GPU is done
+ * reading it, so writes never stall on in-use memory.
+ * Requires GL_ARB_uniform_buffer_object, GL_ARB_buffer_storage and GL_ARB_sync.
+ *
+ * \param frame_size Bytes of uniform data written per frame
+ * \param frames Frames in flight (2 to GLSL_UNIFORM_RING_MAX_FRAMES)
+ * \returns UniformRing or NULL on failure; call SDL_GetError() for more information.
+ *
+ * \warning User must free returned UniformRing with freeUniformRing() before losing scope
+ *
+ * \sa pushUniformRing
+ * \sa advanceUniformRing
+ * \sa freeUniformRing
+ */
+extern UniformRing* createUniformRing(GLsizeiptr frame_size, int frames);
+
+/**
+ * Copy a draw's parameter struct into the ring and bind it to a binding point
+ *
+ * \param ring UniformRing to allocate from
+ * \param binding Uniform buffer binding point (see bindShaderUniformBlock())
+ * \param data Parameter struct matching block layout (eg: std140)
+ * \param size Size of data in bytes
+ * \returns true if bound, false if frame's segment is full
+ *
+ * \sa createUniformRing
+ */
+extern bool pushUniformRing(UniformRing* ring, GLuint binding, const void* data, GLsizeiptr size);
+
+/**
+ * Fence current frame's segment and move to next one (call once per frame after drawing)
+ *
+ * \param ring UniformRing to advance
+ *
+ * \sa createUniformRing
+ */
+extern void advanceUniformRing(UniformRing* ring);
+
+/**
+ * Free uniform ring and its buffer
+ *
+ * \param ring UniformRing to free
+ *
+ * \sa createUniformRing
+ */
+extern void freeUniformRing(UniformRing* ring);
+
+/**
+ * Load GLSL source for one shader stage from file
+ *
+ * File is sized and read in a single pass (no size limit); source length
+ * is kept with the Shader and handed to glShaderSource as-is.
+ * Same as preprocessGLSLFile() with no defines.
+ *
+ * \param target Shader to receive source
+ * \param type GLSL_VERT or GLSL_FRAG
+ * \param filename GLSL source file
+ * \returns GLSL_SUCCESS or GLSL_FAILURE; call SDL_GetError() for more information.
+ *
+ * \sa loadGLSLFiles
+ */
 extern int loadGLSLFile(Shader* target, int type, const char* filename);
 
+/**
+ * Load GLSL source for one shader stage with #include resolved and #defines injected
+ *
+ * #include "file" (or <file>) is resolved relative to the including file
+ * and pasted only at its first #include per load (eg: diamond includes).
+ * Each file is read and stripped of comments and blank space once per
+ * session; later loads reuse the memoized text until the file (or anything
+ * it includes) is invalidated. Defines are inserted after #version when
+ * present. Preprocessor calls are safe from any thread.
+ *
+ * \param target Shader to receive source
+ * \param type GLSL_VERT or GLSL_FRAG
+ * \param filename GLSL source file
+ * \param defines Define bodies, eg: "USE_TEXTURE" or "OCTAVES 6" (may be NULL)
+ * \param num_defines Number of defines
+ * \returns GLSL_SUCCESS or GLSL_FAILURE; call SDL_GetError() for more information.
+ *
+ * \sa invalidateGLSLFile
+ * \sa freeGLSLFiles
+ */
+extern int preprocessGLSLFile(Shader* target, int type, const char* filename, const char** defines, int num_defines);
+
+/**
+ * Mark a GLSL file changed so it and every file including it are re-read on next load
+ *
+ * \param filename GLSL file as given to (or resolved by) the loader
+ *
+ * \sa preprocessGLSLFile
+ */
+extern void invalidateGLSLFile(const char* filename);
+
+/**
+ * Free memoized GLSL files kept by the preprocessor
+ *
+ * \sa preprocessGLSLFile
+ */
+extern void freeGLSLFiles();
+
+typedef void (*GLSLFileFunction)(const char* filename, void* data);
+
+/**
+ * Visit a loaded GLSL file and every file it includes (directly or indirectly)
+ *
+ * \param filename GLSL file as given to the loader (not visited if never loaded)
+ * \param function Called per file; must not call preprocessor functions
+ * \param data Passed to function
+ *
+ * \sa preprocessGLSLFile
+ */
+extern void forEachGLSLInclude(const char* filename, GLSLFileFunction function, void* data);
+
+/**
+ * Load vertex and fragment sources for a list of shaders in one call
+ *
+ * Files repeated within the list are read once.
+ *
+ * \param targets Shaders to fill, num_shaders in size
+ * \param vert_filenames Vertex shader file for each target
+ * \param frag_filenames Fragment shader file for each target
+ * \param num_shaders Number of shaders
+ * \returns GLSL_SUCCESS or GLSL_FAILURE if any file failed to load;
+ *          call SDL_GetError() for more information.
+ *
+ * \sa loadGLSLFile
+ */
+extern int loadGLSLFiles(Shader* targets, const char** vert_filenames, const char** frag_filenames, int num_shaders);
+
+/**
+ * Load a vertex x fragment program matrix, reading each file once
+ *
+ * Every vertex source is paired with every fragment source; identical
+ * stages are compiled once and attached to every program using them.
+ *
+ * \warning Each stage source is built once and shared by every target using
+ *          it; release targets with freeShaders() rather than free().
+ *
+ * \param targets Shaders to fill, num_verts * num_frags in size;
+ *                target for vertex v and fragment f is targets[v * num_frags + f]
+ * \param vert_filenames Vertex shader files
+ * \param num_verts Number of vertex shader files
+ * \param frag_filenames Fragment shader files
+ * \param num_frags Number of fragment shader files
+ * \returns GLSL_SUCCESS or GLSL_FAILURE if any file failed to load;
+ *          call SDL_GetError() for more information.
+ *
+ * \sa loadGLSLFile
+ * \sa compileShaders
+ */
+extern int loadGLSLMatrix(Shader* targets, const char** vert_filenames, int num_verts, const char** frag_filenames, int num_frags);
+
+/**
+ * Enable on-disk program binary cache used by compileShaders()
+ *
+ * Programs are keyed by a hash of their vertex and fragment sources plus
+ * the GL vendor, renderer and version strings. Cached binaries are loaded
+ * directly; binaries rejected by the driver fall back to a full compile
+ * and are rewritten.
+ *
+ * \param directory Existing directory to read/write cached binaries
+ * \returns true if enabled, false if GL_ARB_get_program_binary is unsupported
+ *          or shaders are not initialized; call SDL_GetError() for more information.
+ *
+ * \sa initShaders
+ * \sa getShaderCacheStats
+ */
+extern bool enableShaderCache(const char* directory);
+
+/**
+ * Disable on-disk program binary cache (cache files are kept)
+ *
+ * \sa enableShaderCache
+ */
+extern void disableShaderCache();
+
+/**
+ * Get shader binary cache hit/miss counts and timings since cache enabled
+ *
+ * \returns ShaderCacheStats; saved_ms estimates compile time avoided by hits
+ *          (stored compile time of each hit minus time taken to load it)
+ *
+ * \sa enableShaderCache
+ */
+extern ShaderCacheStats getShaderCacheStats();
+
+/**
+ * Hash GLSL source (FNV-1a over length then bytes)
+ *
+ * \param hash FNV_OFFSET_BASIS or a previous hash to chain from
+ * \param source Source bytes (may be NULL when length is 0)
+ * \param length Source length in bytes
+ * \returns Updated hash
+ */
+extern Uint64 hashSource(Uint64 hash, const char* source, int length);
+
 #ifdef __cplusplus
 }
 #endif
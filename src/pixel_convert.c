@@ -0,0 +1,403 @@
+#include "pixel_convert.h"
+
+#include <string.h>
+
+#ifdef PIXEL_CONVERT_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define PIXEL_TARGET_SSE2 __attribute__((target("sse2")))
+#define PIXEL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define PIXEL_TARGET_SSE2
+#define PIXEL_TARGET_AVX2
+#endif
+#elif defined(PIXEL_CONVERT_NEON)
+#include <arm_neon.h>
+#endif
+
+/*
+ * Scalar kernels (reference and tail handling)
+ */
+void convertRowRGB565Scalar(const Uint8* src, Uint8* dst, int w) {
+	const Uint16* p = (const Uint16*)src;
+	Uint32 r, g, b;
+	int x;
+
+	for (x = 0; x < w; x++) {
+		r = p[x] >> 11;
+		g = (p[x] >> 5) & 0x3F;
+		b = p[x] & 0x1F;
+		dst[x * 4 + 0] = (Uint8)((r << 3) | (r >> 2));
+		dst[x * 4 + 1] = (Uint8)((g << 2) | (g >> 4));
+		dst[x * 4 + 2] = (Uint8)((b << 3) | (b >> 2));
+		dst[x * 4 + 3] = 0xFF;
+	}
+}
+
+void convertRow1555Scalar(const Uint8* src, Uint8* dst, int w, bool alpha) {
+	const Uint16* p = (const Uint16*)src;
+	Uint32 r, g, b;
+	int x;
+
+	for (x = 0; x < w; x++) {
+		r = (p[x] >> 10) & 0x1F;
+		g = (p[x] >> 5) & 0x1F;
+		b = p[x] & 0x1F;
+		dst[x * 4 + 0] = (Uint8)((r << 3) | (r >> 2));
+		dst[x * 4 + 1] = (Uint8)((g << 3) | (g >> 2));
+		dst[x * 4 + 2] = (Uint8)((b << 3) | (b >> 2));
+		dst[x * 4 + 3] = (!alpha || (p[x] & 0x8000)) ? 0xFF : 0x00;
+	}
+}
+
+void convertRowARGB1555Scalar(const Uint8* src, Uint8* dst, int w) {
+	convertRow1555Scalar(src, dst, w, true);
+}
+
+void convertRowRGB555Scalar(const Uint8* src, Uint8* dst, int w) {
+	convertRow1555Scalar(src, dst, w, false);
+}
+
+void convertRowBGR24Scalar(const Uint8* src, Uint8* dst, int w) {
+	int x;
+
+	for (x = 0; x < w; x++) {
+		dst[x * 4 + 0] = src[x * 3 + 2];
+		dst[x * 4 + 1] = src[x * 3 + 1];
+		dst[x * 4 + 2] = src[x * 3 + 0];
+		dst[x * 4 + 3] = 0xFF;
+	}
+}
+
+void convertRowBGRA32Scalar(const Uint8* src, Uint8* dst, int w, bool alpha) {
+	int x;
+
+	for (x = 0; x < w; x++) {
+		dst[x * 4 + 0] = src[x * 4 + 2];
+		dst[x * 4 + 1] = src[x * 4 + 1];
+		dst[x * 4 + 2] = src[x * 4 + 0];
+		dst[x * 4 + 3] = alpha ? src[x * 4 + 3] : 0xFF;
+	}
+}
+
+void convertRowARGB8888Scalar(const Uint8* src, Uint8* dst, int w) {
+	convertRowBGRA32Scalar(src, dst, w, true);
+}
+
+void convertRowXRGB8888Scalar(const Uint8* src, Uint8* dst, int w) {
+	convertRowBGRA32Scalar(src, dst, w, false);
+}
+
+void convertRowRGBA32(const Uint8* src, Uint8* dst, int w) {
+	memcpy(dst, src, (size_t)w * 4);
+}
+
+#ifdef PIXEL_CONVERT_X86
+/*
+ * SSE2 kernels, 8 pixels (16-bit) or 4 pixels (32-bit) per iteration
+ */
+// Expand 5-bit fields held in 16-bit lanes to 8 bits
+PIXEL_TARGET_SSE2 __m128i expand5SSE2(__m128i v) {
+	return _mm_or_si128(_mm_slli_epi16(v, 3), _mm_srli_epi16(v, 2));
+}
+
+// Interleave 16-bit lanes of 8-bit channels into 8 RGBA32 pixels
+PIXEL_TARGET_SSE2 void storeRGBA8SSE2(Uint8* dst, __m128i r, __m128i g, __m128i b, __m128i a) {
+	__m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+	__m128i ba = _mm_or_si128(b, _mm_slli_epi16(a, 8));
+
+	_mm_storeu_si128((__m128i*)dst, _mm_unpacklo_epi16(rg, ba));
+	_mm_storeu_si128((__m128i*)(dst + 16), _mm_unpackhi_epi16(rg, ba));
+}
+
+PIXEL_TARGET_SSE2 void convertRowRGB565SSE2(const Uint8* src, Uint8* dst, int w) {
+	const __m128i mask5 = _mm_set1_epi16(0x1F);
+	const __m128i mask6 = _mm_set1_epi16(0x3F);
+	const __m128i alpha = _mm_set1_epi16(0xFF);
+	__m128i p, r, g, b;
+	int x;
+
+	for (x = 0; x + 8 <= w; x += 8) {
+		p = _mm_loadu_si128((const __m128i*)(src + x * 2));
+		r = expand5SSE2(_mm_srli_epi16(p, 11));
+		g = _mm_and_si128(_mm_srli_epi16(p, 5), mask6);
+		g = _mm_or_si128(_mm_slli_epi16(g, 2), _mm_srli_epi16(g, 4));
+		b = expand5SSE2(_mm_and_si128(p, mask5));
+		storeRGBA8SSE2(dst + x * 4, r, g, b, alpha);
+	}
+	convertRowRGB565Scalar(src + x * 2, dst + x * 4, w - x);
+}
+
+PIXEL_TARGET_SSE2 void convertRow1555SSE2(const Uint8* src, Uint8* dst, int w, bool has_alpha) {
+	const __m128i mask5 = _mm_set1_epi16(0x1F);
+	const __m128i mask8 = _mm_set1_epi16(0xFF);
+	__m128i p, r, g, b, a;
+	int x;
+
+	for (x = 0; x + 8 <= w; x += 8) {
+		p = _mm_loadu_si128((const __m128i*)(src + x * 2));
+		r = expand5SSE2(_mm_and_si128(_mm_srli_epi16(p, 10), mask5));
+		g = expand5SSE2(_mm_and_si128(_mm_srli_epi16(p, 5), mask5));
+		b = expand5SSE2(_mm_and_si128(p, mask5));
+		// Sign-extend top bit into 0x0000 or 0xFFFF
+		a = has_alpha ? _mm_and_si128(_mm_srai_epi16(p, 15), mask8) : mask8;
+		storeRGBA8SSE2(dst + x * 4, r, g, b, a);
+	}
+	convertRow1555Scalar(src + x * 2, dst + x * 4, w - x, has_alpha);
+}
+
+PIXEL_TARGET_SSE2 void convertRowARGB1555SSE2(const Uint8* src, Uint8* dst, int w) {
+	convertRow1555SSE2(src, dst, w, true);
+}
+
+PIXEL_TARGET_SSE2 void convertRowRGB555SSE2(const Uint8* src, Uint8* dst, int w) {
+	convertRow1555SSE2(src, dst, w, false);
+}
+
+PIXEL_TARGET_SSE2 void convertRowBGRA32SSE2(const Uint8* src, Uint8* dst, int w, bool has_alpha) {
+	const __m128i mask_ga = _mm_set1_epi32((int)0xFF00FF00);
+	const __m128i mask_b = _mm_set1_epi32(0xFF);
+	const __m128i alpha = _mm_set1_epi32(has_alpha ? 0 : (int)0xFF000000);
+	__m128i p, rb;
+	int x;
+
+	// Swap bytes 0 and 2 of each pixel with shifts (no byte shuffle in SSE2)
+	for (x = 0; x + 4 <= w; x += 4) {
+		p = _mm_loadu_si128((const __m128i*)(src + x * 4));
+		rb = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(p, 16), mask_b), _mm_slli_epi32(_mm_and_si128(p, mask_b), 16));
+		p = _mm_or_si128(_mm_or_si128(_mm_and_si128(p, mask_ga), rb), alpha);
+		_mm_storeu_si128((__m128i*)(dst + x * 4), p);
+	}
+	convertRowBGRA32Scalar(src + x * 4, dst + x * 4, w - x, has_alpha);
+}
+
+PIXEL_TARGET_SSE2 void convertRowARGB8888SSE2(const Uint8* src, Uint8* dst, int w) {
+	convertRowBGRA32SSE2(src, dst, w, true);
+}
+
+PIXEL_TARGET_SSE2 void convertRowXRGB8888SSE2(const Uint8* src, Uint8* dst, int w) {
+	convertRowBGRA32SSE2(src, dst, w, false);
+}
+
+/*
+ * AVX2 kernels, 8 pixels per iteration in 32-bit lanes
+ */
+PIXEL_TARGET_AVX2 __m256i expand5AVX2(__m256i v) {
+	return _mm256_or_si256(_mm256_slli_epi32(v, 3), _mm256_srli_epi32(v, 2));
+}
+
+PIXEL_TARGET_AVX2 __m256i packRGBA8AVX2(__m256i r, __m256i g, __m256i b, __m256i a) {
+	return _mm256_or_si256(_mm256_or_si256(r, _mm256_slli_epi32(g, 8)), _mm256_or_si256(_mm256_slli_epi32(b, 16), _mm256_slli_epi32(a, 24)));
+}
+
+PIXEL_TARGET_AVX2 void convertRowRGB565AVX2(const Uint8* src, Uint8* dst, int w) {
+	const __m256i mask5 = _mm256_set1_epi32(0x1F);
+	const __m256i mask6 = _mm256_set1_epi32(0x3F);
+	const __m256i alpha = _mm256_set1_epi32(0xFF);
+	__m256i p, r, g, b;
+	int x;
+
+	for (x = 0; x + 8 <= w; x += 8) {
+		p = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(src + x * 2)));
+		r = expand5AVX2(_mm256_srli_epi32(p, 11));
+		g = _mm256_and_si256(_mm256_srli_epi32(p, 5), mask6);
+		g = _mm256_or_si256(_mm256_slli_epi32(g, 2), _mm256_srli_epi32(g, 4));
+		b = expand5AVX2(_mm256_and_si256(p, mask5));
+		_mm256_storeu_si256((__m256i*)(dst + x * 4), packRGBA8AVX2(r, g, b, alpha));
+	}
+	convertRowRGB565Scalar(src + x * 2, dst + x * 4, w - x);
+}
+
+PIXEL_TARGET_AVX2 void convertRow1555AVX2(const Uint8* src, Uint8* dst, int w, bool has_alpha) {
+	const __m256i mask5 = _mm256_set1_epi32(0x1F);
+	const __m256i mask8 = _mm256_set1_epi32(0xFF);
+	__m256i p, r, g, b, a;
+	int x;
+
+	for (x = 0; x + 8 <= w; x += 8) {
+		p = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(src + x * 2)));
+		r = expand5AVX2(_mm256_and_si256(_mm256_srli_epi32(p, 10), mask5));
+		g = expand5AVX2(_mm256_and_si256(_mm256_srli_epi32(p, 5), mask5));
+		b = expand5AVX2(_mm256_and_si256(p, mask5));
+		a = has_alpha ? _mm256_mullo_epi32(_mm256_srli_epi32(p, 15), mask8) : mask8;
+		_mm256_storeu_si256((__m256i*)(dst + x * 4), packRGBA8AVX2(r, g, b, a));
+	}
+	convertRow1555Scalar(src + x * 2, dst + x * 4, w - x, has_alpha);
+}
+
+PIXEL_TARGET_AVX2 void convertRowARGB1555AVX2(const Uint8* src, Uint8* dst, int w) {
+	convertRow1555AVX2(src, dst, w, true);
+}
+
+PIXEL_TARGET_AVX2 void convertRowRGB555AVX2(const Uint8* src, Uint8* dst, int w) {
+	convertRow1555AVX2(src, dst, w, false);
+}
+
+PIXEL_TARGET_AVX2 void convertRowBGR24AVX2(const Uint8* src, Uint8* dst, int w) {
+	// Per 128-bit lane: 4 BGR pixels (12 bytes) -> 4 RGBA pixels, alpha slots zeroed
+	const __m256i shuffle = _mm256_setr_epi8(
+		2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1,
+		2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+	const __m256i alpha = _mm256_set1_epi32((int)0xFF000000);
+	__m128i lo, hi;
+	__m256i p;
+	int x;
+
+	// Second load ends 28 bytes past pixel x, so stop 10 pixels before row end
+	for (x = 0; x + 10 <= w; x += 8) {
+		lo = _mm_loadu_si128((const __m128i*)(src + x * 3));
+		hi = _mm_loadu_si128((const __m128i*)(src + x * 3 + 12));
+		p = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+		p = _mm256_or_si256(_mm256_shuffle_epi8(p, shuffle), alpha);
+		_mm256_storeu_si256((__m256i*)(dst + x * 4), p);
+	}
+	convertRowBGR24Scalar(src + x * 3, dst + x * 4, w - x);
+}
+
+PIXEL_TARGET_AVX2 void convertRowBGRA32AVX2(const Uint8* src, Uint8* dst, int w, bool has_alpha) {
+	const __m256i shuffle = _mm256_setr_epi8(
+		2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+		2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+	const __m256i alpha = _mm256_set1_epi32(has_alpha ? 0 : (int)0xFF000000);
+	__m256i p;
+	int x;
+
+	for (x = 0; x + 8 <= w; x += 8) {
+		p = _mm256_loadu_si256((const __m256i*)(src + x * 4));
+		p = _mm256_or_si256(_mm256_shuffle_epi8(p, shuffle), alpha);
+		_mm256_storeu_si256((__m256i*)(dst + x * 4), p);
+	}
+	convertRowBGRA32Scalar(src + x * 4, dst + x * 4, w - x, has_alpha);
+}
+
+PIXEL_TARGET_AVX2 void convertRowARGB8888AVX2(const Uint8* src, Uint8* dst, int w) {
+	convertRowBGRA32AVX2(src, dst, w, true);
+}
+
+PIXEL_TARGET_AVX2 void convertRowXRGB8888AVX2(const Uint8* src, Uint8* dst, int w) {
+	convertRowBGRA32AVX2(src, dst, w, false);
+}
+#endif
+
+#ifdef PIXEL_CONVERT_NEON
+/*
+ * NEON kernels, 16 pixels per iteration via (de)interleaving loads/stores
+ */
+void convertRowBGR24NEON(const Uint8* src, Uint8* dst, int w) {
+	uint8x16x3_t bgr;
+	uint8x16x4_t rgba;
+	int x;
+
+	rgba.val[3] = vdupq_n_u8(0xFF);
+	for (x = 0; x + 16 <= w; x += 16) {
+		bgr = vld3q_u8(src + x * 3);
+		rgba.val[0] = bgr.val[2];
+		rgba.val[1] = bgr.val[1];
+		rgba.val[2] = bgr.val[0];
+		vst4q_u8(dst + x * 4, rgba);
+	}
+	convertRowBGR24Scalar(src + x * 3, dst + x * 4, w - x);
+}
+
+void convertRowBGRA32NEON(const Uint8* src, Uint8* dst, int w, bool has_alpha) {
+	uint8x16x4_t p;
+	uint8x16_t t;
+	int x;
+
+	for (x = 0; x + 16 <= w; x += 16) {
+		p = vld4q_u8(src + x * 4);
+		t = p.val[0];
+		p.val[0] = p.val[2];
+		p.val[2] = t;
+		if (!has_alpha) p.val[3] = vdupq_n_u8(0xFF);
+		vst4q_u8(dst + x * 4, p);
+	}
+	convertRowBGRA32Scalar(src + x * 4, dst + x * 4, w - x, has_alpha);
+}
+
+void convertRowARGB8888NEON(const Uint8* src, Uint8* dst, int w) {
+	convertRowBGRA32NEON(src, dst, w, true);
+}
+
+void convertRowXRGB8888NEON(const Uint8* src, Uint8* dst, int w) {
+	convertRowBGRA32NEON(src, dst, w, false);
+}
+#endif
+
+/*
+ * Pick best row kernel for source format and running CPU
+ */
+ConvertRowFunction getConvertRowFunction(Uint32 format) {
+#ifdef PIXEL_CONVERT_X86
+	static int cpu_level = -1;
+
+	// 0 = scalar, 1 = SSE2, 2 = AVX2 (benign race: same result on every thread)
+	if (cpu_level < 0) cpu_level = SDL_HasAVX2() ? 2 : SDL_HasSSE2() ? 1 : 0;
+#endif
+
+	switch (format) {
+	case SDL_PIXELFORMAT_RGB565:
+#ifdef PIXEL_CONVERT_X86
+		if (cpu_level == 2) return convertRowRGB565AVX2;
+		if (cpu_level == 1) return convertRowRGB565SSE2;
+#endif
+		return convertRowRGB565Scalar;
+	case SDL_PIXELFORMAT_ARGB1555:
+#ifdef PIXEL_CONVERT_X86
+		if (cpu_level == 2) return convertRowARGB1555AVX2;
+		if (cpu_level == 1) return convertRowARGB1555SSE2;
+#endif
+		return convertRowARGB1555Scalar;
+	case SDL_PIXELFORMAT_RGB555:
+#ifdef PIXEL_CONVERT_X86
+		if (cpu_level == 2) return convertRowRGB555AVX2;
+		if (cpu_level == 1) return convertRowRGB555SSE2;
+#endif
+		return convertRowRGB555Scalar;
+	case SDL_PIXELFORMAT_BGR24:
+#ifdef PIXEL_CONVERT_X86
+		if (cpu_level == 2) return convertRowBGR24AVX2;
+#elif defined(PIXEL_CONVERT_NEON)
+		return convertRowBGR24NEON;
+#endif
+		return convertRowBGR24Scalar;
+	case SDL_PIXELFORMAT_ARGB8888:
+#ifdef PIXEL_CONVERT_X86
+		if (cpu_level == 2) return convertRowARGB8888AVX2;
+		if (cpu_level == 1) return convertRowARGB8888SSE2;
+#elif defined(PIXEL_CONVERT_NEON)
+		return convertRowARGB8888NEON;
+#endif
+		return convertRowARGB8888Scalar;
+	case SDL_PIXELFORMAT_XRGB8888:
+#ifdef PIXEL_CONVERT_X86
+		if (cpu_level == 2) return convertRowXRGB8888AVX2;
+		if (cpu_level == 1) return convertRowXRGB8888SSE2;
+#elif defined(PIXEL_CONVERT_NEON)
+		return convertRowXRGB8888NEON;
+#endif
+		return convertRowXRGB8888Scalar;
+	case SDL_PIXELFORMAT_RGBA32:
+		return convertRowRGBA32;
+	default:
+		return NULL;
+	}
+}
+
+bool convertPixelsToRGBA32(SDL_Surface* src, void* dst, int dst_pitch) {
+	ConvertRowFunction convert;
+	const Uint8* src_row;
+	Uint8* dst_row;
+	int y;
+
+	convert = getConvertRowFunction(src->format->format);
+	if (!convert || SDL_MUSTLOCK(src)) return false;
+
+	for (y = 0; y < src->h; y++) {
+		src_row = (const Uint8*)src->pixels + (size_t)y * src->pitch;
+		dst_row = (Uint8*)dst + (size_t)y * dst_pitch;
+		convert(src_row, dst_row, src->w);
+	}
+	return true;
+}
@@ -0,0 +1,89 @@
+#pragma once
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include <stdbool.h>
+
+#include <SDL.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PIXEL_CONVERT_X86
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define PIXEL_CONVERT_NEON
+#endif
+
+// Row kernel: convert w pixels from src into RGBA32 dst
+typedef void (*ConvertRowFunction)(const Uint8* src, Uint8* dst, int w);
+
+// Scalar row kernels (reference and SIMD tail handling)
+extern void convertRowRGB565Scalar(const Uint8* src, Uint8* dst, int w);
+extern void convertRow1555Scalar(const Uint8* src, Uint8* dst, int w, bool alpha);
+extern void convertRowARGB1555Scalar(const Uint8* src, Uint8* dst, int w);
+extern void convertRowRGB555Scalar(const Uint8* src, Uint8* dst, int w);
+extern void convertRowBGR24Scalar(const Uint8* src, Uint8* dst, int w);
+extern void convertRowBGRA32Scalar(const Uint8* src, Uint8* dst, int w, bool alpha);
+extern void convertRowARGB8888Scalar(const Uint8* src, Uint8* dst, int w);
+extern void convertRowXRGB8888Scalar(const Uint8* src, Uint8* dst, int w);
+extern void convertRowRGBA32(const Uint8* src, Uint8* dst, int w);
+
+#ifdef PIXEL_CONVERT_X86
+// SSE2 row kernels, 8 pixels (16-bit) or 4 pixels (32-bit) per iteration
+extern void convertRowRGB565SSE2(const Uint8* src, Uint8* dst, int w);
+extern void convertRow1555SSE2(const Uint8* src, Uint8* dst, int w, bool has_alpha);
+extern void convertRowARGB1555SSE2(const Uint8* src, Uint8* dst, int w);
+extern void convertRowRGB555SSE2(const Uint8* src, Uint8* dst, int w);
+extern void convertRowBGRA32SSE2(const Uint8* src, Uint8* dst, int w, bool has_alpha);
+extern void convertRowARGB8888SSE2(const Uint8* src, Uint8* dst, int w);
+extern void convertRowXRGB8888SSE2(const Uint8* src, Uint8* dst, int w);
+
+// AVX2 row kernels, 8 pixels per iteration (only call when SDL_HasAVX2())
+extern void convertRowRGB565AVX2(const Uint8* src, Uint8* dst, int w);
+extern void convertRow1555AVX2(const Uint8* src, Uint8* dst, int w, bool has_alpha);
+extern void convertRowARGB1555AVX2(const Uint8* src, Uint8* dst, int w);
+extern void convertRowRGB555AVX2(const Uint8* src, Uint8* dst, int w);
+extern void convertRowBGR24AVX2(const Uint8* src, Uint8* dst, int w);
+extern void convertRowBGRA32AVX2(const Uint8* src, Uint8* dst, int w, bool has_alpha);
+extern void convertRowARGB8888AVX2(const Uint8* src, Uint8* dst, int w);
+extern void convertRowXRGB8888AVX2(const Uint8* src, Uint8* dst, int w);
+#endif
+
+#ifdef PIXEL_CONVERT_NEON
+// NEON row kernels, 16 pixels per iteration
+extern void convertRowBGR24NEON(const Uint8* src, Uint8* dst, int w);
+extern void convertRowBGRA32NEON(const Uint8* src, Uint8* dst, int w, bool has_alpha);
+extern void convertRowARGB8888NEON(const Uint8* src, Uint8* dst, int w);
+extern void convertRowXRGB8888NEON(const Uint8* src, Uint8* dst, int w);
+#endif
+
+/**
+ * Get fastest row kernel converting format to RGBA32 on running CPU
+ *
+ * \param format Source SDL_PIXELFORMAT_*
+ * \returns Row kernel or NULL if format has no kernel
+ *
+ * \sa convertPixelsToRGBA32
+ */
+extern ConvertRowFunction getConvertRowFunction(Uint32 format);
+
+/**
+ * Convert surface pixels to RGBA32 (bytes R, G, B, A) without SDL_BlitSurface
+ *
+ * Dedicated kernels (AVX2/SSE2 on x86, NEON on ARM, scalar otherwise) for:
+ * SDL_PIXELFORMAT_RGB565, ARGB1555, RGB555, BGR24, ARGB8888, XRGB8888 and RGBA32.
+ * Channels are expanded by bit replication (eg: 5-bit 31 -> 255); alpha-less
+ * formats get alpha 255. Colors are copied as-is (no blending).
+ *
+ * \param src Source surface (must not need locking)
+ * \param dst Destination pixels, at least src->h rows of dst_pitch bytes
+ * \param dst_pitch Destination row size in bytes (>= src->w * 4)
+ * \returns true if converted, false if source format has no kernel
+ *          (caller should fall back to SDL_BlitSurface)
+ *
+ * \sa getConvertRowFunction
+ */
+extern bool convertPixelsToRGBA32(SDL_Surface* src, void* dst, int dst_pitch);
+
+#ifdef __cplusplus
+}
+#endif
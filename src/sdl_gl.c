@@ -1,13 +1,33 @@
 #include "sdl_gl.h"
 
+#include <math.h>
 #include <stdio.h>
+#include <string.h>
+
+#include "gl_math.h"
+#include "gl_profiler.h"
+#include "gl_state.h"
+#include "glsl_ext.h"
+#include "pixel_convert.h"
+#include "texture_mipmap.h"
 
 // Externs
 char SDL_GL_VERSION[150];
 float DELTA_TIME;
 float CAMERA_MATRIX[16];
-
-Uint64 LAST_TICKS;
+float PROJECTION_MATRIX[16];
+int FRAME_PACING_MODE = FRAME_PACING_NONE;
+
+Uint64 LAST_COUNTER;
+Uint64 FRAME_PACING_INTERVAL = 0; // Performance counter ticks per frame, 0 if not limiting
+Uint64 FRAME_PACING_DEADLINE = 0;
+bool FRAME_DELTA_SMOOTH = false;
+float FRAME_DELTAS[FRAME_DELTA_SMOOTHING];
+int FRAME_DELTA_NEXT = 0;
+int FRAME_DELTA_COUNT = 0;
+float FRAME_TIMES[FRAME_PACING_HISTORY]; // Milliseconds, ring
+int FRAME_TIME_NEXT = 0;
+Uint32 FRAME_TIME_COUNT = 0;
 
 int nearestPowerOfTwo(int input) {
 	int value = 1;
@@ -34,40 +54,62 @@ void initializeGL(int view_width, int view_height, double fov, bool orthographic
 	double inv_aspect;
 	double clip_near = 0.001;
 	double clip_far = 100000.0;
-	double fwidth, fheight;
 
 	// Setup viewport and background
 	glViewport(0, 0, view_width, view_height);
 	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
 	glClearDepth(1.0);
 
+	// Start state shadowing fresh for new context
+	glStateReset();
+
 	// Setup rendering style
-	glDepthFunc(GL_LEQUAL);
-	glEnable(GL_DEPTH_TEST);
+	glStateDepthFunc(GL_LEQUAL);
+	glStateEnable(GL_DEPTH_TEST, true);
 	glShadeModel(GL_SMOOTH);
 
-	// Setup perspective
-	glMatrixMode(GL_PROJECTION);
-	glLoadIdentity();
+	// Setup perspective (built on CPU, only ever uploaded)
 	if (orthographic) {
 		fov *= 0.5f;
 		inv_aspect = (float)view_height / (float)view_width;
-		glOrtho(-fov, fov, -fov * inv_aspect, fov * inv_aspect, 0.0f, clip_far);
+		mat4Ortho(PROJECTION_MATRIX, -fov, fov, -fov * inv_aspect, fov * inv_aspect, 0.0f, clip_far);
 	}
 	else {
-		getFrustrumValues(view_width, view_height, fov, clip_near, &fwidth, &fheight);
-		glFrustum(-fwidth, fwidth, -fheight, fheight, clip_near, clip_far);
+		mat4Perspective(PROJECTION_MATRIX, view_width, view_height, fov, clip_near, clip_far);
 	}
+	glMatrixMode(GL_PROJECTION);
+	glLoadMatrixf(PROJECTION_MATRIX);
 
 	// Ready for drawing geometry
 	glMatrixMode(GL_MODELVIEW);
-	glGetFloatv(GL_MODELVIEW_MATRIX, CAMERA_MATRIX);
+	mat4Identity(CAMERA_MATRIX);
+
+	LAST_COUNTER = SDL_GetPerformanceCounter();
+}
+
+// Create window with current OpenGL context; sets error and returns NULL on failure
+static SDL_Window* openSDLGLWindow(const char* title, int width, int height, Uint32 window_flags, SDL_GLContext* context) {
+	SDL_Window* window;
 
-	LAST_TICKS = SDL_GetTicks64();
+	window = SDL_CreateWindow(title, 100, 100, width, height, SDL_WINDOW_OPENGL | window_flags);
+	if (!window) {
+		SDL_SetError("Failed to create OpenGL window: %s", SDL_GetError());
+		return NULL;
+	}
+
+	*context = SDL_GL_CreateContext(window);
+	if (!*context) {
+		SDL_SetError("Failed to create OpenGL context: %s", SDL_GetError());
+		SDL_DestroyWindow(window);
+		return NULL;
+	}
+
+	return window;
 }
 
 SDL_Window* createSDLGLWindow(const char* title, int width, int height, double fov, bool orthographic) {
 	SDL_Window* window;
+	SDL_GLContext context;
 
 	// Initialize SDL
 	if (SDL_Init(SDL_INIT_VIDEO) < 0) {
@@ -75,17 +117,10 @@ SDL_Window* createSDLGLWindow(const char* title, int width, int height, double f
 		exit(1);
 	}
 
-	// Create OpenGL window
-	window = SDL_CreateWindow(title, 100, 100, width, height, SDL_WINDOW_OPENGL);
+	// Create OpenGL window and context
+	window = openSDLGLWindow(title, width, height, 0, &context);
 	if (!window) {
-		printf("Failed to create OpenGL window: %s\n", SDL_GetError());
-		SDL_Quit();
-		exit(2);
-	}
-
-	// OpenGL context for window
-	if (!SDL_GL_CreateContext(window)) {
-		printf("Failed to create OpenGL context: %s\n", SDL_GetError());
+		printf("%s\n", SDL_GetError());
 		SDL_Quit();
 		exit(2);
 	}
@@ -99,11 +134,193 @@ SDL_Window* createSDLGLWindow(const char* title, int width, int height, double f
 	return window;
 }
 
-Texture* loadTextureBMP(const char* filename, bool forceNrSqr) {
+HeadlessGL* createHeadlessGL(int width, int height, double fov, bool orthographic) {
+	HeadlessGL* headless;
+
+	// No display (eg: build machines); fall back to SDL's EGL pbuffer driver (eg: Mesa llvmpipe)
+	if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+		if (SDL_getenv("SDL_VIDEODRIVER") != NULL) {
+			SDL_SetError("Failed to initialize SDL video: %s", SDL_GetError());
+			return NULL;
+		}
+		SDL_setenv("SDL_VIDEODRIVER", "offscreen", 1);
+		if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+			SDL_SetError("Failed to initialize SDL video (offscreen driver): %s", SDL_GetError());
+			return NULL;
+		}
+	}
+
+	headless = (HeadlessGL*)calloc(1, sizeof(HeadlessGL));
+	if (headless == NULL) {
+		SDL_SetError("Failed to allocate headless context");
+		return NULL;
+	}
+
+	// Window only carries the context; everything is drawn to the render target
+	headless->window = openSDLGLWindow("headless", HEADLESS_WINDOW_SIZE, HEADLESS_WINDOW_SIZE, SDL_WINDOW_HIDDEN, &headless->context);
+	if (headless->window == NULL) {
+		free(headless);
+		return NULL;
+	}
+
+	initializeGL(width, height, fov, orthographic);
+	snprintf(SDL_GL_VERSION, 150, "%s", glGetString(GL_VERSION));
+
+	headless->target = createRenderTarget(width, height);
+	if (headless->target == NULL) {
+		freeHeadlessGL(headless);
+		return NULL;
+	}
+	bindRenderTarget(headless->target);
+
+	return headless;
+}
+
+void freeHeadlessGL(HeadlessGL* headless) {
+	if (headless == NULL) return;
+
+	if (headless->target != NULL) freeRenderTarget(headless->target);
+	SDL_GL_DeleteContext(headless->context);
+	SDL_DestroyWindow(headless->window);
+	free(headless);
+}
+
+RenderTarget* createRenderTarget(int width, int height) {
+	RenderTarget* target;
+	GLenum status;
+
+	if (width <= 0 || height <= 0) {
+		SDL_SetError("Invalid render target size: %dx%d", width, height);
+		return NULL;
+	}
+	if (!createFramebufferFunctions()) {
+		SDL_SetError("Render targets unsupported: requires framebuffer objects");
+		return NULL;
+	}
+
+	target = (RenderTarget*)calloc(1, sizeof(RenderTarget));
+	if (target == NULL) {
+		SDL_SetError("Failed to allocate render target");
+		return NULL;
+	}
+	target->width = width;
+	target->height = height;
+
+	// Color as texture so results can be drawn or captured later
+	glGenTextures(1, &target->color);
+	glStateBindTexture(target->color);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+
+	glGenRenderbuffers(1, &target->depth);
+	glBindRenderbuffer(GL_RENDERBUFFER, target->depth);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &target->framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, target->framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target->color, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, target->depth);
+	status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (status != GL_FRAMEBUFFER_COMPLETE) {
+		freeRenderTarget(target);
+		SDL_SetError("Render target %dx%d incomplete: 0x%04X", width, height, status);
+		return NULL;
+	}
+
+	return target;
+}
+
+void bindRenderTarget(const RenderTarget* target) {
+	if (target == NULL) {
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		return;
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, target->framebuffer);
+	glViewport(0, 0, target->width, target->height);
+}
+
+void freeRenderTarget(RenderTarget* target) {
+	if (target == NULL) return;
+
+	glDeleteFramebuffers(1, &target->framebuffer);
+	glDeleteRenderbuffers(1, &target->depth);
+	glStateForgetTexture(target->color);
+	glDeleteTextures(1, &target->color);
+	free(target);
+}
+
+SDL_Surface* loadSurfaceBMP(const char* filename, bool forceNrSqr) {
+	return loadSurfaceBMPEx(filename, forceNrSqr ? TEXTURE_FORCE_NR_SQR : 0);
+}
+
+void getBMPTextureSize(const SDL_Surface* surface, Uint32 flags, int* w, int* h) {
+	// Find OpenGL compatible resolution (OpenGL 1.x change res if needed)
+	if (!(flags & TEXTURE_KEEP_SIZE) && ((flags & TEXTURE_FORCE_NR_SQR) || SDL_GL_VERSION[0] == '1')) {
+		*w = nearestPowerOfTwo(surface->w);
+		*h = nearestPowerOfTwo(surface->h);
+	} else {
+		*w = surface->w;
+		*h = surface->h;
+	}
+}
+
+bool isBMPPacked16(const SDL_Surface* surface, Uint32 flags) {
+	Uint32 format = surface->format->format;
+
+	// 16-bit layouts map directly onto GL packed pixel types
+	return (flags & TEXTURE_PACKED_16) &&
+		(format == SDL_PIXELFORMAT_RGB565 || format == SDL_PIXELFORMAT_RGB555 || format == SDL_PIXELFORMAT_ARGB1555);
+}
+
+SDL_Surface* convertSurfaceBMP(SDL_Surface* original, const char* filename, Uint32 flags) {
 	int w, h;
-	SDL_Surface* original;
 	SDL_Surface* glcompat;
-	Texture* texture;
+
+	getBMPTextureSize(original, flags, &w, &h);
+
+	// Already OpenGL compatible layout (packed 16-bit kept when not resampled)
+	if (original->format->format == SDL_PIXELFORMAT_RGBA32 || (isBMPPacked16(original, flags) && w == original->w && h == original->h)) {
+		glcompat = original;
+	} else {
+		glcompat = SDL_CreateRGBSurfaceWithFormat(0, original->w, original->h, 32, SDL_PIXELFORMAT_RGBA32);
+		if (!glcompat) {
+			SDL_FreeSurface(original);
+			SDL_SetError("Failed to create SDL format surface for BMP \"%s\" | SDL surface error: %s", filename, SDL_GetError());
+			return NULL;
+		}
+
+		// Convert original into OpenGL compatible
+		if (!convertPixelsToRGBA32(original, glcompat->pixels, glcompat->pitch) && SDL_BlitSurface(original, NULL, glcompat, NULL) != 0) {
+			SDL_FreeSurface(glcompat);
+			SDL_FreeSurface(original);
+			SDL_SetError("Failed to convert/transfer BMP \"%s\" for OpenGL | SDL blit surface error: %s", filename, SDL_GetError());
+			return NULL;
+		}
+		SDL_FreeSurface(original);
+	}
+
+	// Stretch to power of two resolution instead of padding with black
+	if (w != glcompat->w || h != glcompat->h) {
+		original = glcompat;
+		glcompat = resampleSurface(original, w, h, MIPMAP_FILTER_KAISER, 0);
+		SDL_FreeSurface(original);
+		if (!glcompat) {
+			SDL_SetError("Failed to resample BMP \"%s\" to %dx%d | %s", filename, w, h, SDL_GetError());
+			return NULL;
+		}
+	}
+
+	return glcompat;
+}
+
+SDL_Surface* loadSurfaceBMPEx(const char* filename, Uint32 flags) {
+	SDL_Surface* original;
 
 	// Load BMP file onto SDL surface
 	original = SDL_LoadBMP(filename);
@@ -112,78 +329,279 @@ Texture* loadTextureBMP(const char* filename, bool forceNrSqr) {
 		return NULL;
 	}
 
-	// Create a OpenGL compatible surface (OpenGL 1.x change res if needed)
-	if (forceNrSqr || SDL_GL_VERSION[0] == '1') {
-		w = nearestPowerOfTwo(original->w);
-		h = nearestPowerOfTwo(original->h);
-	} else {
-		w = original->w;
-		h = original->h;
+	return convertSurfaceBMP(original, filename, flags);
+}
+
+bool getSurfaceGLFormat(SDL_Surface* surface, GLint* internal_format, GLenum* format, GLenum* type) {
+	switch (surface->format->format) {
+	case SDL_PIXELFORMAT_RGBA32:
+		*internal_format = GL_RGBA8;
+		*format = GL_RGBA;
+		*type = GL_UNSIGNED_BYTE;
+		return true;
+	case SDL_PIXELFORMAT_RGB565:
+		// Exact 5/6/5 storage needs GL 4.1 / ES2 compatibility, else nearest 5/5/5
+		*internal_format = SDL_GL_ExtensionSupported("GL_ARB_ES2_compatibility") ? GL_RGB565 : GL_RGB5;
+		*format = GL_RGB;
+		*type = GL_UNSIGNED_SHORT_5_6_5;
+		return true;
+	case SDL_PIXELFORMAT_RGB555:
+		// Unused top bit lands in alpha, dropped by internal format
+		*internal_format = GL_RGB5;
+		*format = GL_BGRA;
+		*type = GL_UNSIGNED_SHORT_1_5_5_5_REV;
+		return true;
+	case SDL_PIXELFORMAT_ARGB1555:
+		*internal_format = GL_RGB5_A1;
+		*format = GL_BGRA;
+		*type = GL_UNSIGNED_SHORT_1_5_5_5_REV;
+		return true;
+	default:
+		return false;
 	}
-	glcompat = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_RGBA32);
-	if (!glcompat) {
-		SDL_FreeSurface(original);
-		SDL_SetError("Failed to create SDL format surface for BMP \"%s\" | SDL surface error: %s", filename, SDL_GetError());
+}
+
+Texture* loadTextureBMP(const char* filename, bool forceNrSqr) {
+	return loadTextureBMPEx(filename, forceNrSqr ? TEXTURE_FORCE_NR_SQR : 0);
+}
+
+Texture* loadTextureBMPEx(const char* filename, Uint32 flags) {
+	SDL_Surface* original;
+	SDL_Surface* glcompat = NULL;
+	MipmapChain* chain = NULL;
+	Texture* texture;
+	Uint8* pixels = NULL;
+	GLint internal_format = GL_RGBA8;
+	GLenum format = GL_RGBA, type = GL_UNSIGNED_BYTE;
+	int i, w, h;
+
+	// Load BMP file onto SDL surface (mip chain is built in RGBA32)
+	if (flags & TEXTURE_MIPMAPS) flags &= ~TEXTURE_PACKED_16;
+	original = SDL_LoadBMP(filename);
+	if (!original) {
+		SDL_SetError("Failed to load BMP \"%s\" | SDL error: %s", filename, SDL_GetError());
 		return NULL;
 	}
 
-	// Copy original into OpenGL compatible
-	if (SDL_BlitSurface(original, NULL, glcompat, NULL) != 0) {
-		SDL_FreeSurface(glcompat);
-		SDL_FreeSurface(original);
-		SDL_SetError("Failed to convert/transfer BMP \"%s\" for OpenGL | SDL blit surface error: %s", filename, SDL_GetError());
-		return NULL;
+	// Convert decoded BMP straight into RGBA32 upload buffer when neither resampled nor mipmapped
+	getBMPTextureSize(original, flags, &w, &h);
+	if (!(flags & TEXTURE_MIPMAPS) && w == original->w && h == original->h &&
+		original->format->format != SDL_PIXELFORMAT_RGBA32 && !isBMPPacked16(original, flags)) {
+		pixels = (Uint8*)malloc((size_t)w * h * 4);
+		if (pixels && convertPixelsToRGBA32(original, pixels, w * 4)) {
+			SDL_FreeSurface(original);
+		} else {
+			free(pixels);
+			pixels = NULL;
+		}
+	}
+
+	// Otherwise load onto OpenGL compatible surface (takes ownership of original)
+	if (!pixels) {
+		glcompat = convertSurfaceBMP(original, filename, flags);
+		if (!glcompat) return NULL;
+		getSurfaceGLFormat(glcompat, &internal_format, &format, &type);
+		w = glcompat->w;
+		h = glcompat->h;
+	}
+
+	// Build every mip level on CPU (chain takes ownership of glcompat)
+	if (flags & TEXTURE_MIPMAPS) {
+		chain = createMipmapChain(glcompat, (flags & TEXTURE_MIPMAP_BOX) ? MIPMAP_FILTER_BOX : MIPMAP_FILTER_KAISER, 0);
+		if (!chain) {
+			SDL_FreeSurface(glcompat);
+			SDL_SetError("Failed to build mipmaps for BMP \"%s\" | %s", filename, SDL_GetError());
+			return NULL;
+		}
 	}
 
 	// Setup return Texture
 	texture = (Texture*)malloc(sizeof(Texture));
 	if (texture == NULL) {
-		SDL_FreeSurface(glcompat);
-		SDL_FreeSurface(original);
+		if (chain) freeMipmapChain(chain);
+		else SDL_FreeSurface(glcompat);
+		free(pixels);
 		SDL_SetError("Failed to allocate texture memory for BMP \"%s\"", filename);
 		return NULL;
 	}
 
 	// Fill and bind texture.data via OpenGL
 	glGenTextures(1, &texture->data);
-	glBindTexture(GL_TEXTURE_2D, texture->data);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glStateBindTexture(texture->data);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, chain ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, glcompat->pixels);
+	texture->width = w;
+	texture->height = h;
+	texture->internal_format = (GLenum)internal_format;
+	texture->bytes = (size_t)w * h * (glcompat ? glcompat->format->BytesPerPixel : 4);
+	if (chain) {
+		uploadMipmapChain(chain);
+		for (i = 1; i < chain->num_levels; i++) texture->bytes += (size_t)chain->levels[i]->w * chain->levels[i]->h * 4;
+		freeMipmapChain(chain);
+	} else if (pixels) {
+		glTexImage2D(GL_TEXTURE_2D, 0, internal_format, w, h, 0, format, type, pixels);
+		free(pixels);
+	} else {
+		glTexImage2D(GL_TEXTURE_2D, 0, internal_format, w, h, 0, format, type, glcompat->pixels);
+		SDL_FreeSurface(glcompat);
+	}
+	texture->ready = true;
+	texture->failed = false;
 
-	SDL_FreeSurface(glcompat);
-	SDL_FreeSurface(original);
 	return texture;
 }
 
 void freeTexture(Texture* texture) {
+	glStateForgetTexture(texture->data);
 	glDeleteTextures(1, &texture->data);
 	free(texture);
 }
 
+// Wait until frame deadline; sleep while far from it, spin the rest for precision
+static void waitFrameDeadline() {
+	Uint64 frequency = SDL_GetPerformanceFrequency();
+	Uint64 spin = (Uint64)(frequency * FRAME_PACING_SPIN_MS * 0.001);
+	Uint64 now = SDL_GetPerformanceCounter();
+	Uint32 sleep_ms;
+
+	// Over a frame behind (eg: hitch or stall); restart schedule rather than rushing to catch up
+	if (now > FRAME_PACING_DEADLINE + FRAME_PACING_INTERVAL) FRAME_PACING_DEADLINE = now;
+
+	while (FRAME_PACING_DEADLINE > now + spin) {
+		sleep_ms = (Uint32)((FRAME_PACING_DEADLINE - now - spin) * 1000 / frequency);
+		if (sleep_ms == 0) break;
+		SDL_Delay(sleep_ms);
+		now = SDL_GetPerformanceCounter();
+	}
+	while (now < FRAME_PACING_DEADLINE) now = SDL_GetPerformanceCounter();
+
+	FRAME_PACING_DEADLINE += FRAME_PACING_INTERVAL;
+}
+
 void drawGLBegin() {
-	// Update delta time
-	DELTA_TIME = (SDL_GetTicks64() - LAST_TICKS) * 0.001f;
-	LAST_TICKS = SDL_GetTicks64();
+	Uint64 counter = SDL_GetPerformanceCounter();
+	float frame_time;
+	int i;
+
+	// Update delta time (sub-millisecond, SDL_GetTicks64() would quantize)
+	frame_time = (float)((double)(counter - LAST_COUNTER) / (double)SDL_GetPerformanceFrequency());
+	LAST_COUNTER = counter;
+
+	FRAME_TIMES[FRAME_TIME_NEXT] = frame_time * 1000.0f;
+	FRAME_TIME_NEXT = (FRAME_TIME_NEXT + 1) % FRAME_PACING_HISTORY;
+	if (FRAME_TIME_COUNT < FRAME_PACING_HISTORY) FRAME_TIME_COUNT++;
+
+	if (FRAME_DELTA_SMOOTH) {
+		FRAME_DELTAS[FRAME_DELTA_NEXT] = frame_time;
+		FRAME_DELTA_NEXT = (FRAME_DELTA_NEXT + 1) % FRAME_DELTA_SMOOTHING;
+		if (FRAME_DELTA_COUNT < FRAME_DELTA_SMOOTHING) FRAME_DELTA_COUNT++;
+		DELTA_TIME = 0.0f;
+		for (i = 0; i < FRAME_DELTA_COUNT; i++) DELTA_TIME += FRAME_DELTAS[i];
+		DELTA_TIME /= FRAME_DELTA_COUNT;
+	} else {
+		DELTA_TIME = frame_time;
+	}
+
+	profileBeginFrame();
 
 	// Enable depth buffer writting and clear screen
-	glDepthMask(GL_TRUE);
+	glStateDepthMask(GL_TRUE);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	// Fresh matrix with camera applied
-	glLoadIdentity();
-	glMultMatrixf(CAMERA_MATRIX);
+	glLoadMatrixf(CAMERA_MATRIX);
 }
 
 void drawGLEnd(SDL_Window* window) {
-	// Swap buffer (double buffer handling)
-	SDL_GL_SwapWindow(window);
+	// Hold frame until its slot when limiting frame rate
+	if (FRAME_PACING_INTERVAL) {
+		profileBegin(PROFILE_SCOPE_PACING, PROFILE_CPU);
+		waitFrameDeadline();
+		profileEnd();
+	}
+
+	// Swap buffer (double buffer handling); headless only submits queued work
+	profileBegin(PROFILE_SCOPE_SWAP, PROFILE_CPU);
+	if (window != NULL) SDL_GL_SwapWindow(window);
+	else glFlush();
+	profileEnd();
+
+	profileEndFrame();
+}
+
+bool setFramePacing(SDL_Window* window, int mode, double target_fps, bool smooth_delta) {
+	SDL_DisplayMode display_mode;
+
+	if (mode != FRAME_PACING_NONE && mode != FRAME_PACING_VSYNC && mode != FRAME_PACING_LIMIT) {
+		SDL_SetError("Unknown frame pacing mode: %d", mode);
+		return false;
+	}
+
+	if (mode == FRAME_PACING_VSYNC) {
+		// Adaptive first; plain vsync halves frame rate whenever a frame runs late
+		if (SDL_GL_SetSwapInterval(-1) == 0 || SDL_GL_SetSwapInterval(1) == 0) {
+			FRAME_PACING_INTERVAL = 0;
+			FRAME_PACING_MODE = FRAME_PACING_VSYNC;
+			FRAME_DELTA_SMOOTH = smooth_delta;
+			FRAME_DELTA_NEXT = FRAME_DELTA_COUNT = 0;
+			return true;
+		}
+
+		printf("[WARN] Vsync unsupported (%s), limiting frame rate instead\n", SDL_GetError());
+		if (target_fps <= 0.0 && SDL_GetWindowDisplayMode(window, &display_mode) == 0) target_fps = display_mode.refresh_rate;
+		if (target_fps <= 0.0) target_fps = 60.0;
+		mode = FRAME_PACING_LIMIT;
+	}
+
+	if (mode == FRAME_PACING_LIMIT) {
+		if (target_fps <= 0.0) {
+			SDL_SetError("Invalid frame pacing target: %.2f FPS", target_fps);
+			return false;
+		}
+		FRAME_PACING_INTERVAL = (Uint64)(SDL_GetPerformanceFrequency() / target_fps);
+		FRAME_PACING_DEADLINE = SDL_GetPerformanceCounter() + FRAME_PACING_INTERVAL;
+	} else {
+		FRAME_PACING_INTERVAL = 0;
+	}
+
+	// Limiter does the waiting; vsync on top would quantize it
+	SDL_GL_SetSwapInterval(0);
+	FRAME_PACING_MODE = mode;
+	FRAME_DELTA_SMOOTH = smooth_delta;
+	FRAME_DELTA_NEXT = FRAME_DELTA_COUNT = 0;
+	return true;
+}
+
+bool getFramePacingStats(FramePacingStats* stats) {
+	double sum = 0.0, sum_squares = 0.0, variance;
+	Uint32 i;
+
+	if (FRAME_TIME_COUNT == 0) return false;
+
+	stats->frames = FRAME_TIME_COUNT;
+	stats->min_ms = stats->max_ms = FRAME_TIMES[0];
+	for (i = 0; i < FRAME_TIME_COUNT; i++) {
+		sum += FRAME_TIMES[i];
+		sum_squares += (double)FRAME_TIMES[i] * FRAME_TIMES[i];
+		if (FRAME_TIMES[i] < stats->min_ms) stats->min_ms = FRAME_TIMES[i];
+		if (FRAME_TIMES[i] > stats->max_ms) stats->max_ms = FRAME_TIMES[i];
+	}
+	stats->mean_ms = sum / FRAME_TIME_COUNT;
+	variance = sum_squares / FRAME_TIME_COUNT - stats->mean_ms * stats->mean_ms;
+	stats->stddev_ms = variance > 0.0 ? sqrt(variance) : 0.0;
+	return true;
+}
+
+void resetFramePacingStats() {
+	FRAME_TIME_NEXT = 0;
+	FRAME_TIME_COUNT = 0;
 }
 
 void debugCameraControl(const Uint8* keys, float translation_speed, float rotation_speed) {
 	// Sum key state values to check if any are used (zero = none pressed)
+	float delta[16];
 	Uint8 modify_camera_matrix = keys[SDL_SCANCODE_W] + keys[SDL_SCANCODE_A] + keys[SDL_SCANCODE_S] +
 		keys[SDL_SCANCODE_D] + keys[SDL_SCANCODE_LSHIFT] + keys[SDL_SCANCODE_LCTRL] + keys[SDL_SCANCODE_UP] +
 		keys[SDL_SCANCODE_LEFT] + keys[SDL_SCANCODE_DOWN] + keys[SDL_SCANCODE_RIGHT];
@@ -194,30 +612,25 @@ void debugCameraControl(const Uint8* keys, float translation_speed, float rotati
 		rotation_speed *= DELTA_TIME;
 
 		// Fresh matrix
-		glPushMatrix();
-		glLoadIdentity();
+		mat4Identity(delta);
 
 		// Apply transforms to matrix based on key input
-		if (keys[SDL_SCANCODE_A]) glTranslatef(translation_speed, 0.0f, 0.0f);
-		if (keys[SDL_SCANCODE_D]) glTranslatef(-translation_speed, 0.0f, 0.0f);
-
-		if (keys[SDL_SCANCODE_W]) glTranslatef(0.0f, 0.0f, translation_speed);
-		if (keys[SDL_SCANCODE_S]) glTranslatef(0.0f, 0.0f, -translation_speed);
+		if (keys[SDL_SCANCODE_A]) mat4Translate(delta, translation_speed, 0.0f, 0.0f);
+		if (keys[SDL_SCANCODE_D]) mat4Translate(delta, -translation_speed, 0.0f, 0.0f);
 
-		if (keys[SDL_SCANCODE_LCTRL]) glTranslatef(0.0f, translation_speed, 0.0f);
-		if (keys[SDL_SCANCODE_LSHIFT]) glTranslatef(0.0f, -translation_speed, 0.0f);
+		if (keys[SDL_SCANCODE_W]) mat4Translate(delta, 0.0f, 0.0f, translation_speed);
+		if (keys[SDL_SCANCODE_S]) mat4Translate(delta, 0.0f, 0.0f, -translation_speed);
 
-		if (keys[SDL_SCANCODE_RIGHT]) glRotatef(rotation_speed, 0.0f, 1.0f, 0.0f);
-		if (keys[SDL_SCANCODE_LEFT]) glRotatef(-rotation_speed, 0.0f, 1.0f, 0.0f);
-		if (keys[SDL_SCANCODE_DOWN]) glRotatef(rotation_speed, 1.0f, 0.0f, 0.0f);
-		if (keys[SDL_SCANCODE_UP]) glRotatef(-rotation_speed, 1.0f, 0.0f, 0.0f);
+		if (keys[SDL_SCANCODE_LCTRL]) mat4Translate(delta, 0.0f, translation_speed, 0.0f);
+		if (keys[SDL_SCANCODE_LSHIFT]) mat4Translate(delta, 0.0f, -translation_speed, 0.0f);
 
-		// Combine with previous camera matrix
-		glMultMatrixf(CAMERA_MATRIX);
+		if (keys[SDL_SCANCODE_RIGHT]) mat4Rotate(delta, rotation_speed, 0.0f, 1.0f, 0.0f);
+		if (keys[SDL_SCANCODE_LEFT]) mat4Rotate(delta, -rotation_speed, 0.0f, 1.0f, 0.0f);
+		if (keys[SDL_SCANCODE_DOWN]) mat4Rotate(delta, rotation_speed, 1.0f, 0.0f, 0.0f);
+		if (keys[SDL_SCANCODE_UP]) mat4Rotate(delta, -rotation_speed, 1.0f, 0.0f, 0.0f);
 
-		// Save matrix to update camera matrix; free matrix
-		glGetFloatv(GL_MODELVIEW_MATRIX, CAMERA_MATRIX);
-		glPopMatrix();
+		// Combine with previous camera matrix (no GL round trip)
+		mat4Multiply(CAMERA_MATRIX, delta, CAMERA_MATRIX);
 	}
 }
 
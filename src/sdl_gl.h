@@ -10,19 +10,174 @@ extern "C"{
 
 extern char SDL_GL_VERSION[150];
 extern float DELTA_TIME;
-extern float CAMERA_MATRIX[16];
+extern float CAMERA_MATRIX[16];     // View matrix loaded by drawGLBegin()
+extern float PROJECTION_MATRIX[16]; // Set by initializeGL()
+
+// Frame pacing modes (see setFramePacing())
+#define FRAME_PACING_NONE  0 // Swap immediately, vsync off
+#define FRAME_PACING_VSYNC 1 // Adaptive vsync, falling back to vsync then FRAME_PACING_LIMIT
+#define FRAME_PACING_LIMIT 2 // Wait for target FPS before swapping (sleep then spin), vsync off
+
+#define FRAME_PACING_SPIN_MS  2.0 // Final part of wait spun rather than slept (covers SDL_Delay() overshoot)
+#define FRAME_PACING_HISTORY  240 // Frame times measured by getFramePacingStats()
+#define FRAME_DELTA_SMOOTHING 8   // Frame times averaged for smoothed DELTA_TIME
+
+extern int FRAME_PACING_MODE; // Mode in effect after any fallback
+
+typedef struct {
+	Uint32 frames;    // Frame times measured (up to FRAME_PACING_HISTORY)
+	double mean_ms;
+	double stddev_ms; // Frame-time jitter
+	double min_ms;
+	double max_ms;
+} FramePacingStats;
 
 typedef struct {
 	GLuint data;
+	bool ready;
+	bool failed;             // Async load failed (ready with placeholder kept)
+	int width, height;       // Level 0 size
+	GLenum internal_format;  // eg: GL_RGBA8, GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+	size_t bytes;            // Estimated GPU memory (all mip levels)
 } Texture;
 
+extern int nearestPowerOfTwo(int input);
+
+/**
+ * Half extents of near clip plane for horizontal field of view
+ *
+ * \param view_width Viewport width
+ * \param view_height Viewport height
+ * \param fov Horizontal field of view in degrees
+ * \param clip_near Near clip distance
+ * \param width Receives half width at clip_near
+ * \param height Receives half height at clip_near
+ *
+ * \sa mat4Perspective
+ */
+extern void getFrustrumValues(double view_width, double view_height, double fov, double clip_near, double* width, double* height);
+
 extern SDL_Window* createSDLGLWindow(const char* title, int width, int height, double fov, bool orthographic);
 
+#define HEADLESS_WINDOW_SIZE 16 // Hidden window carrying headless context (drawing goes to render target)
+
+// Framebuffer object drawn into instead of a window
+typedef struct {
+	GLuint framebuffer;
+	GLuint color;  // GL_RGBA8 texture
+	GLuint depth;  // 24-bit depth renderbuffer
+	int width, height;
+} RenderTarget;
+
+typedef struct {
+	SDL_Window* window;    // Hidden, never shown
+	SDL_GLContext context;
+	RenderTarget* target;  // Bound by createHeadlessGL()
+} HeadlessGL;
+
+/**
+ * Create OpenGL context without a visible window, drawing into a render target
+ *
+ * Uses a hidden window, or SDL's "offscreen" EGL driver when no display is
+ * available (eg: Mesa llvmpipe on GPU-less machines). Unlike
+ * createSDLGLWindow() failures are returned rather than exiting.
+ * Pass NULL to drawGLEnd() for headless frames.
+ *
+ * \param width Render target width
+ * \param height Render target height
+ * \param fov Horizontal field of view in degrees (or view width if orthographic)
+ * \param orthographic Use orthographic projection
+ * \returns HeadlessGL or NULL on failure; call SDL_GetError() for more information.
+ *
+ * \warning User must free returned context with freeHeadlessGL() before SDL_Quit()
+ *
+ * \sa createRenderTarget
+ */
+extern HeadlessGL* createHeadlessGL(int width, int height, double fov, bool orthographic);
+
+extern void freeHeadlessGL(HeadlessGL* headless);
+
+/**
+ * Create framebuffer object with color texture and depth buffer
+ *
+ * \param width Width in pixels
+ * \param height Height in pixels
+ * \returns RenderTarget or NULL on failure; call SDL_GetError() for more information.
+ *
+ * \warning User must free returned target with freeRenderTarget()
+ */
+extern RenderTarget* createRenderTarget(int width, int height);
+
+/**
+ * Draw into target (and set viewport to its size)
+ *
+ * \param target Render target or NULL for window (viewport left unchanged)
+ */
+extern void bindRenderTarget(const RenderTarget* target);
+
+extern void freeRenderTarget(RenderTarget* target);
+
+// loadSurfaceBMPEx()/loadTextureBMPEx() flags
+#define TEXTURE_FORCE_NR_SQR 0x0001 // Resample width/height to nearest square numbers (eg: 900 -> 1024)
+#define TEXTURE_PACKED_16    0x0002 // Keep 16-bit BMPs (RGB565/RGB555/ARGB1555) packed instead of RGBA32
+#define TEXTURE_MIPMAPS      0x0004 // Build full mip chain on CPU (gamma-correct Kaiser filter), implies RGBA32
+#define TEXTURE_MIPMAP_BOX   0x0008 // Use box filter instead of Kaiser for TEXTURE_MIPMAPS
+#define TEXTURE_KEEP_SIZE    0x0010 // Never resample, even on OpenGL 1.x (eg: images packed into an atlas)
+
+/**
+ * Loads BMP from file into an OpenGL compatible RGBA32 surface (no GL calls)
+ *
+ * Safe to call from worker threads.
+ *
+ * \param filname BMP file to load from
+ * \param forceNrSqr Resamples respective width/height resolution
+*                    to nearest square numbers (eg: 900 -> 1024)
+ * \returns SDL_Surface in SDL_PIXELFORMAT_RGBA32 or NULL on failure;
+ *          call SDL_GetError() for more information.
+ *
+ * \warning User must free returned surface with SDL_FreeSurface()
+ *
+ * \sa loadSurfaceBMPEx
+ * \sa loadTextureBMP
+ */
+extern SDL_Surface* loadSurfaceBMP(const char* filename, bool forceNrSqr);
+
+/**
+ * Loads BMP from file into an OpenGL compatible surface (no GL calls)
+ *
+ * Pixels are converted with SIMD kernels (see convertPixelsToRGBA32()),
+ * falling back to SDL_BlitSurface for uncommon formats. Power of two
+ * sizes are reached by resampling (see resampleSurface()), not padding.
+ * Safe to call from worker threads.
+ *
+ * \param filname BMP file to load from
+ * \param flags TEXTURE_* flags
+ * \returns SDL_Surface in SDL_PIXELFORMAT_RGBA32 (or source 16-bit format
+ *          with TEXTURE_PACKED_16 when not resampled) or NULL on failure;
+ *          call SDL_GetError() for more information.
+ *
+ * \warning User must free returned surface with SDL_FreeSurface()
+ *
+ * \sa getSurfaceGLFormat
+ */
+extern SDL_Surface* loadSurfaceBMPEx(const char* filename, Uint32 flags);
+
+/**
+ * Get glTexImage2D() parameters matching surface pixel layout
+ *
+ * \param surface Surface in RGBA32, RGB565, RGB555 or ARGB1555
+ * \param internal_format Receives sized internal format (eg: GL_RGB5_A1)
+ * \param format Receives pixel format (eg: GL_BGRA)
+ * \param type Receives pixel type (eg: GL_UNSIGNED_SHORT_1_5_5_5_REV)
+ * \returns true on success or false for unsupported surface format
+ */
+extern bool getSurfaceGLFormat(SDL_Surface* surface, GLint* internal_format, GLenum* format, GLenum* type);
+
 /**
  * Loads BMP from file for usee with OpenGL texturing
  *
  * \param filname BMP file to load from
- * \param forceNrSqr Forces respective width/height resolution
+ * \param forceNrSqr Resamples respective width/height resolution
 *                    to nearest square numbers (eg: 900 -> 1024)
  *                   (default: false)
  * \returns Texture structure usable with OpenGL or NULL on failure;
@@ -36,6 +191,28 @@ extern SDL_Window* createSDLGLWindow(const char* title, int width, int height, d
  */
 extern Texture* loadTextureBMP(const char* filename, bool forceNrSqr);
 
+/**
+ * Loads BMP from file for use with OpenGL texturing
+ *
+ * With TEXTURE_PACKED_16, 16-bit BMPs upload as GL_UNSIGNED_SHORT_5_6_5 or
+ * GL_UNSIGNED_SHORT_1_5_5_5_REV (half the memory and bandwidth of RGBA8).
+ * Other BMPs kept at their size convert straight from the decoded pixels
+ * into the upload buffer (no intermediate RGBA32 surface).
+ * With TEXTURE_MIPMAPS, all levels are uploaded and sampled with
+ * GL_LINEAR_MIPMAP_LINEAR minification.
+ *
+ * \param filname BMP file to load from
+ * \param flags TEXTURE_* flags
+ * \returns Texture structure usable with OpenGL or NULL on failure;
+ *          call SDL_GetError() for more information.
+ *
+ * \warning User must free returned Texture with freeTexture() before losing scope
+ *
+ * \sa loadTextureBMP
+ * \sa freeTexture
+ */
+extern Texture* loadTextureBMPEx(const char* filename, Uint32 flags);
+
 /**
  * Free texture memory
  * 
@@ -48,8 +225,43 @@ extern void freeTexture(Texture* texture);
 
 extern void drawGLBegin();
 
+/**
+ * Finish frame: pace (see setFramePacing()) and swap
+ *
+ * \param window Window to swap or NULL for headless (work is flushed instead)
+ */
 extern void drawGLEnd(SDL_Window* window);
 
+/**
+ * Set how drawGLEnd() paces frames
+ *
+ * FRAME_PACING_VSYNC tries adaptive vsync (late frames tear instead of
+ * waiting a whole refresh), then vsync, then falls back to FRAME_PACING_LIMIT
+ * at target_fps or the display refresh rate. Check FRAME_PACING_MODE for the
+ * mode in effect.
+ *
+ * \param window Window being drawn (used for display refresh rate)
+ * \param mode FRAME_PACING_* mode
+ * \param target_fps Frame rate for FRAME_PACING_LIMIT (may be 0 for FRAME_PACING_VSYNC)
+ * \param smooth_delta Average DELTA_TIME over last FRAME_DELTA_SMOOTHING frames
+ * \returns true on success or false on failure; call SDL_GetError() for more information.
+ *
+ * \sa getFramePacingStats
+ */
+extern bool setFramePacing(SDL_Window* window, int mode, double target_fps, bool smooth_delta);
+
+/**
+ * Get frame time (drawGLBegin() to drawGLBegin()) statistics
+ *
+ * \param stats Filled with statistics over last FRAME_PACING_HISTORY frames
+ * \returns true on success or false if no frames were measured
+ *
+ * \sa resetFramePacingStats
+ */
+extern bool getFramePacingStats(FramePacingStats* stats);
+
+extern void resetFramePacingStats();
+
 extern void debugCameraControl(const Uint8* keys, float translation_speed, float rotation_speed);
 
 /**
@@ -7,27 +7,50 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <math.h>
 
 #include <SDL.h>
 
 #include "sdl_gl.h"
 #include "glsl_shader.h"
 #include "glsl_ext.h"
+#include "glsl_reload.h"
+#include "gl_state.h"
+#include "gl_batch.h"
+#include "gl_capture.h"
+#include "gl_instance.h"
+#include "gl_profiler.h"
+#include "texture_async.h"
+#include "texture_bc.h"
+#include "texture_mipmap.h"
 
 void drawGLScene(SDL_Window* window, Texture** textures, Shader* shaders);
+void drawSpriteField(Texture** textures);
+void drawInstancedRing(Texture** textures, Shader* shaders);
 void setDrawGLTexturesSmooth(bool smooth);
 
 #define NUM_TEXTURES 4
 #define NUM_SHADERS 4
+#define FEATURE_SHADER (NUM_SHADERS * 2)  // Permutation shader after plain and instanced shaders
+#define NUM_FEATURES 3
+#define SPRITE_FIELD_SIZE 320  // Sprites per side (~100k total)
+#define NUM_RING_INSTANCES 256
 
 int current_shader = 0;
+int feature_variant = -1;  // Feature mask drawn instead of current shader (-1 off)
 int current_texture = 0;
 float angle = 0.0f;
+bool sprite_field_enabled = false;
+bool instanced_ring_enabled = false;
+InstanceMesh* quad_mesh = NULL;
+InstanceBuffer* ring_instances = NULL;
 
 int main(int argc, char** argv) {
 	bool smooth_texture = false;
 	bool spin_enabled = false;
 	int i;
+	int pacing_mode = FRAME_PACING_VSYNC;
+	bool capturing = false;
 	float shader_time = 0.0f;
 	float angle_speed = 45.0f;  // Deg per sec
 	const char TEXTURE_FILENAMES[NUM_TEXTURES][100] = {
@@ -36,16 +59,40 @@ int main(int argc, char** argv) {
 		"resources/test_corners_colors_oddres_16bit.bmp",
 		"resources/test_corners_colors_oddres_16bit_alpha.bmp"
 	};
-	const char SHADER_VERT_FILENAME[100] = "resources/common_color_textcoord.vert";
-	const char SHADER_FRAG_FILENAMES[NUM_SHADERS][100] = {
+	const char* SHADER_VERT_FILENAMES[2] = {
+		"resources/common_color_textcoord.vert",
+		"resources/common_instanced.vert"
+	};
+	const char* SHADER_FRAG_FILENAMES[NUM_SHADERS] = {
 		"resources/shader_texture.frag",
 		"resources/shader_color_texcoord_alpha.frag",
 		"resources/shader_noise_mask.frag",
 		"resources/shader_color.frag"
 	};
+	const char* SHADER_FEATURES[NUM_FEATURES] = {
+		"USE_TEXTURE",
+		"USE_VERTEX_COLOR",
+		"USE_ALPHA"
+	};
+	char compressed_filename[sizeof(TEXTURE_FILENAMES[0]) + 5];
+	double psnr;
 	Texture* textures[NUM_TEXTURES];
-	Shader shaders[NUM_SHADERS];
-	GLint uniform_loc;
+	Shader shaders[NUM_SHADERS * 2 + 1];  // Plain then instanced vertex stage, then feature permutations
+	const GLBatchVertex QUAD_VERTICES[4] = {
+		{-1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 255, 255, 255, 255},
+		{1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 255, 255, 255, 255},
+		{1.0f, -1.0f, 0.0f, 1.0f, 1.0f, 255, 255, 255, 255},
+		{-1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 255, 255, 255, 255}
+	};
+	const GLushort QUAD_INDICES[6] = {0, 1, 2, 2, 3, 0};
+	ShaderCacheStats cache_stats;
+	ShaderReloadStats reload_stats;
+	GLStateStats state_stats;
+	GLBatchStats batch_stats;
+	FramePacingStats pacing_stats;
+	CaptureStats capture_stats;
+	int time_uniform = -1;
+	bool uniforms_resolved = false;
 	Uint8* keys;
 	SDL_Window* window;
 	SDL_Event event;
@@ -57,9 +104,23 @@ int main(int argc, char** argv) {
 		75.0f, false
 	);
 
-	// Load Texture(s)
+	// Streaming quad batches (client arrays if VBOs are unsupported)
+	if (!glBatchInit(GL_BATCH_MAX_QUADS)) {
+		printf("Unable to create quad batch: %s\n", SDL_GetError());
+		SDL_DestroyWindow(window);
+		SDL_Quit();
+		return 1;
+	}
+
+	// Load Texture(s) in background; placeholders bound until each is uploaded
+	if (!initAsyncTextures(0, 2)) {
+		printf("Unable to start texture loading: %s\n", SDL_GetError());
+		SDL_DestroyWindow(window);
+		SDL_Quit();
+		return 1;
+	}
 	for (i = 0; i < NUM_TEXTURES; i++) {
-		textures[i] = loadTextureBMP(TEXTURE_FILENAMES[i], false);
+		textures[i] = loadTextureBMPAsync(TEXTURE_FILENAMES[i], false);
 		if (textures[i] == NULL) {
 			printf("Unable to load texture: %s\n", SDL_GetError());
 			SDL_DestroyWindow(window);
@@ -68,25 +129,78 @@ int main(int argc, char** argv) {
 		}
 	}
 
+	// Block compression report (encodes next to source, with mip chain)
+	for (i = 0; i < NUM_TEXTURES; i++) {
+		if (snprintf(compressed_filename, sizeof(compressed_filename), "%s.bctx", TEXTURE_FILENAMES[i]) >= (int)sizeof(compressed_filename)) {
+			printf("[WARN] BC encode skipped, path too long: %s\n", TEXTURE_FILENAMES[i]);
+		} else if (encodeTextureBMPToBC(TEXTURE_FILENAMES[i], compressed_filename, TEXTURE_MIPMAPS, BC_FORMAT_AUTO, 0, &psnr)) {
+			printf("BC encode %s: PSNR %.2f dB\n", TEXTURE_FILENAMES[i], psnr);
+		} else {
+			printf("[WARN] BC encode failed: %s\n", SDL_GetError());
+		}
+	}
+
 	// Setup Shaders
 	initShaders();
 	if (!SDL_GLSL_SUPPORTED) {
 		printf("[WARN] Shaders are unsupported on this system\n");
 	} else {
-		// Load and Compile Shaders
-		for (i = 0; i < NUM_SHADERS; i++) {
-			if (loadGLSLFile(&shaders[i], GLSL_VERT, SHADER_VERT_FILENAME) != GLSL_SUCCESS) {
-				printf("Unable to load shader vert: %s\n", SDL_GetError());
-			}
-			if (loadGLSLFile(&shaders[i], GLSL_FRAG, SHADER_FRAG_FILENAMES[i]) != GLSL_SUCCESS) {
-				printf("Unable to load shader frag: %s\n", SDL_GetError());
-			}
+		// Reuse program binaries from previous runs when supported
+		if (!enableShaderCache("resources")) {
+			printf("[WARN] Shader cache disabled: %s\n", SDL_GetError());
+		}
+
+		// Load and Compile Shaders (each vertex stage paired with every fragment stage)
+		if (loadGLSLMatrix(shaders, SHADER_VERT_FILENAMES, 2, SHADER_FRAG_FILENAMES, NUM_SHADERS) != GLSL_SUCCESS) {
+			printf("Unable to load shaders: %s\n", SDL_GetError());
 		}
-		compileShaders(shaders, NUM_SHADERS);
+
+		// One source for every feature combination; each variant compiles when first drawn
+		if (loadShaderPermutations(&shaders[FEATURE_SHADER], SHADER_VERT_FILENAMES[0], "resources/shader_features.frag", SHADER_FEATURES, NUM_FEATURES) != GLSL_SUCCESS) {
+			printf("[WARN] Feature shader unavailable: %s\n", SDL_GetError());
+		}
+		compileShadersAsync(shaders, NUM_SHADERS * 2 + 1, GLSL_COMPILER_THREADS_MAX);
+		cache_stats = getShaderCacheStats();
+		printf("Shader cache: %d hits, %d misses, %d rejected, %.2fms saved\n",
+			cache_stats.hits, cache_stats.misses, cache_stats.rejected, cache_stats.saved_ms);
 		if (SDL_GLSL_SUPPORTED && SDL_GLSL_READY) printf("Shaders supported and ready\n");
 		else printf("[WARN] Shaders are unsupported or not ready\n");
+
+		// Reload shaders as their files are saved
+		if (initShaderReload()) {
+			for (i = 0; i < NUM_SHADERS * 2; i++) {
+				if (!watchShader(&shaders[i], SHADER_VERT_FILENAMES[i / NUM_SHADERS], SHADER_FRAG_FILENAMES[i % NUM_SHADERS], NULL, 0)) {
+					printf("[WARN] Shader not watched: %s\n", SDL_GetError());
+				}
+			}
+		} else {
+			printf("[WARN] Shader hot reload disabled: %s\n", SDL_GetError());
+		}
 	}
 	printf("OpenGL Version: %s\nGLSL Version: %s\n", SDL_GL_VERSION, SDL_GLSL_VERSION);
+	printf("GL capabilities: %s%s%s%s%s%s%s%s\n",
+		GL_CAPABILITIES.core_20 ? "core-2.0 " : "",
+		GL_CAPABILITIES.shader_objects ? "arb-shader-objects " : "",
+		GL_CAPABILITIES.core_33 ? "core-3.3 " : "",
+		GL_CAPABILITIES.dsa ? "dsa " : "",
+		GL_CAPABILITIES.buffer_storage ? "buffer-storage " : "",
+		GL_CAPABILITIES.multi_draw_indirect ? "multi-draw-indirect " : "",
+		GL_CAPABILITIES.uniform_int64 ? "uniform-int64 " : "",
+		GL_CAPABILITIES.uniform_double ? "uniform-double " : "");
+
+	// Setup instanced quad ring (drawn one instance at a time if instancing is unsupported)
+	if (initInstancing()) {
+		quad_mesh = createInstanceMesh(GL_TRIANGLES, QUAD_VERTICES, 4, QUAD_INDICES, 6);
+		ring_instances = createInstanceBuffer(NUM_RING_INSTANCES);
+	}
+	if (quad_mesh == NULL || ring_instances == NULL) printf("[WARN] Instanced ring disabled: %s\n", SDL_GetError());
+	else if (!INSTANCING_SUPPORTED) printf("[WARN] Instancing unsupported; ring drawn per instance\n");
+
+	// Time frames from here on (CPU only if timer queries are unsupported)
+	if (!initProfiler()) printf("[WARN] Profiler disabled: %s\n", SDL_GetError());
+
+	// Pace frames to display (limited to 60 FPS if vsync is unavailable)
+	if (!setFramePacing(window, pacing_mode, 60.0, true)) printf("[WARN] Frame pacing disabled: %s\n", SDL_GetError());
 
 	// Set OpenGL initial draw types
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -102,9 +216,30 @@ int main(int argc, char** argv) {
 	}
 
 	while (true) {
+		// Upload loaded textures within a per-frame budget (4MB or 2ms)
+		profileBegin("texture uploads", PROFILE_CPU);
+		updateAsyncTextures(4 * 1024 * 1024, 2000);
+		profileEnd();
+
+		// Pick up shaders as the driver finishes them
+		if (SDL_GLSL_SUPPORTED && SDL_GLSL_READY) updateShaders(shaders, NUM_SHADERS * 2 + 1);
+
+		// Resolve uniform handles once shader is ready, and again after a reload swaps its program
+		if (updateShaderReload() > 0 || (!uniforms_resolved && shaders[2].ready)) {
+			time_uniform = getShaderUniform(&shaders[2], "u_time");
+			uniforms_resolved = shaders[2].ready;
+		}
+
 		// Draw GL Scene(s)
 		drawGLBegin();
+		profileBegin("scene", PROFILE_CPU | PROFILE_GPU);
 		drawGLScene(window, textures, shaders);
+		profileEnd();
+		if (capturing) {
+			profileBegin("capture", PROFILE_CPU);
+			captureFrame();
+			profileEnd();
+		}
 		drawGLEnd(window);
 
 		// Updates
@@ -113,10 +248,7 @@ int main(int argc, char** argv) {
 		// Update Mandelbrot uniforms if specific shader in use
 		if (SDL_GLSL_SUPPORTED && SDL_GLSL_READY && current_shader == 2) {
 			shader_time += DELTA_TIME;
-			glUseProgramObject(shaders[current_shader].program);
-			uniform_loc = glGetUniformLocation(shaders[current_shader].program, "u_time");
-			if (uniform_loc >= 0) glUniform1f(uniform_loc, shader_time);
-			glUseProgramObject(0);
+			setShaderUniform1f(&shaders[current_shader], time_uniform, shader_time);
 		}
 
 		// Event Handling
@@ -132,6 +264,55 @@ int main(int argc, char** argv) {
 				// Control Toggle quad spin
 				else if (event.key.keysym.scancode == SDL_SCANCODE_SPACE) spin_enabled = !spin_enabled;
 
+				// Control Toggle batched sprite field
+				else if (event.key.keysym.scancode == SDL_SCANCODE_B) sprite_field_enabled = !sprite_field_enabled;
+
+				// Control Toggle instanced quad ring
+				else if (event.key.keysym.scancode == SDL_SCANCODE_I) instanced_ring_enabled = !instanced_ring_enabled;
+
+				// Control Cycle frame pacing (none, vsync, 60 FPS limit), reporting previous mode
+				else if (event.key.keysym.scancode == SDL_SCANCODE_V) {
+					if (getFramePacingStats(&pacing_stats)) {
+						printf("Frame pacing %d: %.3fms mean, %.3fms stddev, %.3f-%.3fms over %u frames\n",
+							FRAME_PACING_MODE, pacing_stats.mean_ms, pacing_stats.stddev_ms,
+							pacing_stats.min_ms, pacing_stats.max_ms, pacing_stats.frames);
+					}
+					pacing_mode = (pacing_mode + 1) % 3;
+					if (!setFramePacing(window, pacing_mode, 60.0, true)) printf("[WARN] Frame pacing unchanged: %s\n", SDL_GetError());
+					resetFramePacingStats();
+				}
+
+				// Control Toggle frame capture (BMP per frame, written in background)
+				else if (event.key.keysym.scancode == SDL_SCANCODE_C) {
+					if (capturing) {
+						quitCapture();
+						capture_stats = getCaptureStats();
+						printf("Captured %llu frames (%llu written, %llu failed, %llu stalls)\n",
+							(unsigned long long)capture_stats.frames, (unsigned long long)capture_stats.written,
+							(unsigned long long)capture_stats.failed, (unsigned long long)capture_stats.stalls);
+						capturing = false;
+					} else {
+						capturing = initCapture(640, 480, 4, 0, CAPTURE_FORMAT_BMP, "capture_%05d.bmp");
+						if (!capturing) printf("[WARN] Unable to start capture: %s\n", SDL_GetError());
+					}
+				}
+
+				// Control Cycle feature shader variant (off, then each feature mask)
+				else if (event.key.keysym.scancode == SDL_SCANCODE_F) {
+					feature_variant = feature_variant + 1 < (1 << NUM_FEATURES) ? feature_variant + 1 : -1;
+					if (feature_variant < 0) printf("Feature shader off\n");
+					else printf("Feature shader: %s%s%s\n",
+						feature_variant & 1 ? "USE_TEXTURE " : "",
+						feature_variant & 2 ? "USE_VERTEX_COLOR " : "",
+						feature_variant & 4 ? "USE_ALPHA " : "");
+				}
+
+				// Control Save profiler trace
+				else if (event.key.keysym.scancode == SDL_SCANCODE_P) {
+					if (saveProfileTrace("profile_trace.json")) printf("Saved profile_trace.json\n");
+					else printf("[WARN] Unable to save profile trace: %s\n", SDL_GetError());
+				}
+
 				// Control Texture and Shader selections
 				else if (event.key.keysym.scancode == SDL_SCANCODE_SEMICOLON) current_texture -= 1;
 				else if (event.key.keysym.scancode == SDL_SCANCODE_APOSTROPHE) current_texture += 1;
@@ -146,7 +327,7 @@ int main(int argc, char** argv) {
 
 				// Call here to update all textures for both smooth and selection changes
 				for (i = 0; i < NUM_TEXTURES; i++) {
-					glBindTexture(GL_TEXTURE_2D, textures[i]->data);
+					glStateBindTexture(textures[i]->data);
 					setDrawGLTexturesSmooth(smooth_texture);
 				}
 			}
@@ -158,7 +339,34 @@ int main(int argc, char** argv) {
 		}
 	}
 
+	state_stats = glStateGetStats();
+	printf("GL state calls: %llu issued, %llu elided\n",
+		(unsigned long long)state_stats.issued, (unsigned long long)state_stats.elided);
+	batch_stats = glBatchGetStats();
+	printf("Batched quads: %llu in %llu draws (%llu buffer orphans)\n",
+		(unsigned long long)batch_stats.quads, (unsigned long long)batch_stats.draws,
+		(unsigned long long)batch_stats.orphans);
+	if (getFramePacingStats(&pacing_stats)) {
+		printf("Frame pacing %d: %.3fms mean, %.3fms stddev, %.3f-%.3fms over %u frames\n",
+			FRAME_PACING_MODE, pacing_stats.mean_ms, pacing_stats.stddev_ms,
+			pacing_stats.min_ms, pacing_stats.max_ms, pacing_stats.frames);
+	}
+	reload_stats = getShaderReloadStats();
+	if (reload_stats.reloads || reload_stats.failures) {
+		printf("Shader reloads: %d swapped, %d failed, %.3fms longest update\n",
+			reload_stats.reloads, reload_stats.failures, reload_stats.max_update_ms);
+	}
+	printProfileReport();
+
 	// Clean Up
+	quitShaderReload();
+	quitCapture();
+	quitProfiler();
+	freeInstanceBuffer(ring_instances);
+	freeInstanceMesh(quad_mesh);
+	glBatchQuit();
+	quitAsyncTextures();
+	quitTextureRowThreads();
 	for (i=0; i < NUM_TEXTURES; i++) {
 		freeTexture(textures[i]);
 	}
@@ -186,33 +394,72 @@ void drawTriangle(Texture** textures) {
 }
 
 void drawQuad(Texture** textures) {
-	// Setup Texturing
-	glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
-	glBindTexture(GL_TEXTURE_2D, textures[current_texture]->data);
+	SDL_Color white = {255, 255, 255, 255};
 
-	glBegin(GL_QUADS);
+	// Setup Texturing
+	glStateTexEnvMode(GL_MODULATE);
+	glBatchTexture(textures[current_texture]->data);
 
 	// Drawn clockwise starting at top left
-	glColor3f(1.0f, 1.0f, 1.0f);
-	glTexCoord2f(0.0f, 0.0f);
-	glVertex3f(-1.0f, 1.0f, 0.0f);
+	glBatchSprite(-1.0f, 1.0f, 2.0f, 2.0f, 0.0f, 0.0f, 1.0f, 1.0f, white);
+	glBatchFlush();
+}
 
-	glTexCoord2f(1.0f, 0.0f);
-	glVertex3f(1.0f, 1.0f, 0.0f);
+void drawSpriteField(Texture** textures) {
+	SDL_Color color;
+	float size = 16.0f / SPRITE_FIELD_SIZE;
+	int x, y;
 
-	glTexCoord2f(1.0f, 1.0f);
-	glVertex3f(1.0f, -1.0f, 0.0f);
+	// Grid of small sprites behind scene; every texture switch is one draw call
+	glStateTexEnvMode(GL_MODULATE);
+	glPushMatrix();
+	glTranslatef(-8.0f, 8.0f, -6.0f);
+	for (y = 0; y < SPRITE_FIELD_SIZE; y++) {
+		glBatchTexture(textures[(y * NUM_TEXTURES) / SPRITE_FIELD_SIZE]->data);
+		for (x = 0; x < SPRITE_FIELD_SIZE; x++) {
+			color.r = (Uint8)(x * 255 / SPRITE_FIELD_SIZE);
+			color.g = (Uint8)(y * 255 / SPRITE_FIELD_SIZE);
+			color.b = 255;
+			color.a = 255;
+			glBatchSprite(x * size, -y * size, size * 0.8f, size * 0.8f, 0.0f, 0.0f, 1.0f, 1.0f, color);
+		}
+	}
+	glBatchFlush();
+	glPopMatrix();
+}
 
-	glTexCoord2f(0.0f, 1.0f);
-	glVertex3f(-1.0f, -1.0f, 0.0f);
+void drawInstancedRing(Texture** textures, Shader* shaders) {
+	InstanceAttributes ring[NUM_RING_INSTANCES];
+	float t;
+	int i;
 
-	glEnd();
+	if (quad_mesh == NULL || ring_instances == NULL) return;
+
+	// One transform per quad instead of a matrix push and draw each
+	for (i = 0; i < NUM_RING_INSTANCES; i++) {
+		t = (float)i / NUM_RING_INSTANCES;
+		setInstanceTransform(&ring[i], cosf(t * 6.2831853f) * 3.0f, sinf(t * 6.2831853f) * 3.0f, -2.0f,
+			angle + t * 720.0f, 0.0f, 1.0f, 0.0f, 0.15f);
+		ring[i].color[0] = 1.0f - t;
+		ring[i].color[1] = t;
+		ring[i].color[2] = 1.0f;
+		ring[i].color[3] = 1.0f;
+		ring[i].layer = 0.0f;
+	}
+	updateInstanceBuffer(ring_instances, ring, NUM_RING_INSTANCES);
+
+	glStateTexEnvMode(GL_MODULATE);
+	glStateBindTexture(textures[current_texture]->data);
+	drawInstances(&shaders[NUM_SHADERS + current_shader], quad_mesh, ring_instances);
 }
 
 void drawGLScene(SDL_Window* window, Texture** textures, Shader* shaders) {
 	// Setup scene 4 units in front of viewport/camera
 	glTranslatef(0.0f, 0.0f, -4.0f);
 
+	// Draw sprite field
+	if (sprite_field_enabled) drawSpriteField(textures);
+
 	// Draw triangle
 	glPushMatrix();
 	glTranslatef(0.0f, 0.0f, -1.0f);
@@ -220,9 +467,17 @@ void drawGLScene(SDL_Window* window, Texture** textures, Shader* shaders) {
 	glPopMatrix();
 
 	// Enable transparency blending and shader
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glslShaderDraw(&shaders[current_shader], true);
+	glStateEnable(GL_BLEND, true);
+	glStateBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	if (feature_variant >= 0) {
+		shaders[FEATURE_SHADER].features = (Uint32)feature_variant;
+		glBatchShader(&shaders[FEATURE_SHADER]);
+	} else {
+		glBatchShader(&shaders[current_shader]);
+	}
+
+	// Draw instanced ring around quad
+	if (instanced_ring_enabled) drawInstancedRing(textures, shaders);
 
 	// Draw quad
 	glPushMatrix();
@@ -232,7 +487,7 @@ void drawGLScene(SDL_Window* window, Texture** textures, Shader* shaders) {
 	glPopMatrix();
 
 	// Disable shaders
-	glslShaderDraw(NULL, false);
+	glBatchShader(NULL);
 }
 
 void setDrawGLTexturesSmooth(bool smooth) {
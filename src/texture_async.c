@@ -0,0 +1,293 @@
+#include "texture_async.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "gl_state.h"
+#include "glsl_ext.h"
+
+#define ASYNC_TEXTURE_QUEUED 0
+#define ASYNC_TEXTURE_DECODED 1
+#define ASYNC_TEXTURE_FAILED 2
+
+typedef struct AsyncTextureJob {
+	Texture* texture;
+	char* filename;
+	bool forceNrSqr;
+	int state;
+	SDL_Surface* surface;
+	struct AsyncTextureJob* next;
+} AsyncTextureJob;
+
+typedef struct {
+	AsyncTextureJob* head;
+	AsyncTextureJob* tail;
+} AsyncTextureQueue;
+
+SDL_mutex* ASYNC_TEXTURE_LOCK = NULL;
+SDL_cond* ASYNC_TEXTURE_WAKE = NULL;
+AsyncTextureQueue ASYNC_TEXTURE_DECODE_QUEUE;
+AsyncTextureQueue ASYNC_TEXTURE_UPLOAD_QUEUE;
+SDL_Thread* ASYNC_TEXTURE_WORKERS[ASYNC_TEXTURE_MAX_WORKERS];
+int ASYNC_TEXTURE_WORKER_COUNT = 0;
+bool ASYNC_TEXTURE_QUIT = false;
+int ASYNC_TEXTURE_PENDING = 0;
+
+bool ASYNC_TEXTURE_PBO_SUPPORTED = false;
+GLuint ASYNC_TEXTURE_PBOS[ASYNC_TEXTURE_MAX_UPLOAD_BUFFERS];
+int ASYNC_TEXTURE_PBO_COUNT = 0;
+int ASYNC_TEXTURE_PBO_NEXT = 0;
+
+void pushAsyncTextureJob(AsyncTextureQueue* queue, AsyncTextureJob* job) {
+	job->next = NULL;
+	if (queue->tail) queue->tail->next = job;
+	else queue->head = job;
+	queue->tail = job;
+}
+
+AsyncTextureJob* popAsyncTextureJob(AsyncTextureQueue* queue) {
+	AsyncTextureJob* job = queue->head;
+
+	if (job) {
+		queue->head = job->next;
+		if (queue->head == NULL) queue->tail = NULL;
+	}
+
+	return job;
+}
+
+void freeAsyncTextureJob(AsyncTextureJob* job) {
+	if (job->surface) SDL_FreeSurface(job->surface);
+	free(job->filename);
+	free(job);
+}
+
+int asyncTextureWorker(void* data) {
+	AsyncTextureJob* job;
+
+	(void)data;
+	while (true) {
+		// Wait for queued file or quit
+		SDL_LockMutex(ASYNC_TEXTURE_LOCK);
+		while (ASYNC_TEXTURE_DECODE_QUEUE.head == NULL && !ASYNC_TEXTURE_QUIT) {
+			SDL_CondWait(ASYNC_TEXTURE_WAKE, ASYNC_TEXTURE_LOCK);
+		}
+		if (ASYNC_TEXTURE_QUIT) {
+			SDL_UnlockMutex(ASYNC_TEXTURE_LOCK);
+			return 0;
+		}
+		job = popAsyncTextureJob(&ASYNC_TEXTURE_DECODE_QUEUE);
+		SDL_UnlockMutex(ASYNC_TEXTURE_LOCK);
+
+		// File I/O and pixel conversion off render thread
+		job->surface = loadSurfaceBMP(job->filename, job->forceNrSqr);
+		if (job->surface) {
+			job->state = ASYNC_TEXTURE_DECODED;
+		} else {
+			job->state = ASYNC_TEXTURE_FAILED;
+			printf("Unable to load texture: %s\n", SDL_GetError());
+		}
+
+		// Hand to render thread for upload
+		SDL_LockMutex(ASYNC_TEXTURE_LOCK);
+		pushAsyncTextureJob(&ASYNC_TEXTURE_UPLOAD_QUEUE, job);
+		SDL_UnlockMutex(ASYNC_TEXTURE_LOCK);
+	}
+}
+
+bool initAsyncTextures(int num_workers, int num_upload_buffers) {
+	int i;
+
+	if (ASYNC_TEXTURE_LOCK) return true;
+
+	if (num_workers <= 0) num_workers = SDL_GetCPUCount() - 1;
+	if (num_workers < 1) num_workers = 1;
+	if (num_workers > ASYNC_TEXTURE_MAX_WORKERS) num_workers = ASYNC_TEXTURE_MAX_WORKERS;
+	if (num_upload_buffers < 1) num_upload_buffers = 1;
+	if (num_upload_buffers > ASYNC_TEXTURE_MAX_UPLOAD_BUFFERS) num_upload_buffers = ASYNC_TEXTURE_MAX_UPLOAD_BUFFERS;
+
+	ASYNC_TEXTURE_LOCK = SDL_CreateMutex();
+	ASYNC_TEXTURE_WAKE = SDL_CreateCond();
+	if (!ASYNC_TEXTURE_LOCK || !ASYNC_TEXTURE_WAKE) {
+		SDL_SetError("Failed to create async texture lock | SDL error: %s", SDL_GetError());
+		if (ASYNC_TEXTURE_WAKE) SDL_DestroyCond(ASYNC_TEXTURE_WAKE);
+		if (ASYNC_TEXTURE_LOCK) SDL_DestroyMutex(ASYNC_TEXTURE_LOCK);
+		ASYNC_TEXTURE_WAKE = NULL;
+		ASYNC_TEXTURE_LOCK = NULL;
+		return false;
+	}
+	memset(&ASYNC_TEXTURE_DECODE_QUEUE, 0, sizeof(AsyncTextureQueue));
+	memset(&ASYNC_TEXTURE_UPLOAD_QUEUE, 0, sizeof(AsyncTextureQueue));
+	ASYNC_TEXTURE_QUIT = false;
+	ASYNC_TEXTURE_PENDING = 0;
+
+	// Pixel buffers let glTexImage2D return before the transfer completes
+	ASYNC_TEXTURE_PBO_SUPPORTED = createPixelBufferFunctions();
+	if (ASYNC_TEXTURE_PBO_SUPPORTED) {
+		ASYNC_TEXTURE_PBO_COUNT = num_upload_buffers;
+		ASYNC_TEXTURE_PBO_NEXT = 0;
+		glGenBuffers(ASYNC_TEXTURE_PBO_COUNT, ASYNC_TEXTURE_PBOS);
+	}
+
+	for (i = 0; i < num_workers; i++) {
+		ASYNC_TEXTURE_WORKERS[i] = SDL_CreateThread(asyncTextureWorker, "AsyncTexture", NULL);
+		if (!ASYNC_TEXTURE_WORKERS[i]) {
+			SDL_SetError("Failed to create async texture worker | SDL error: %s", SDL_GetError());
+			quitAsyncTextures();
+			return false;
+		}
+		ASYNC_TEXTURE_WORKER_COUNT++;
+	}
+
+	return true;
+}
+
+Texture* loadTextureBMPAsync(const char* filename, bool forceNrSqr) {
+	const GLubyte placeholder[4] = { 128, 128, 128, 255 };
+	size_t filename_len;
+	Texture* texture;
+	AsyncTextureJob* job;
+
+	if (!ASYNC_TEXTURE_LOCK) {
+		SDL_SetError("Failed to queue BMP \"%s\": async textures not initialized", filename);
+		return NULL;
+	}
+
+	texture = (Texture*)malloc(sizeof(Texture));
+	job = (AsyncTextureJob*)calloc(1, sizeof(AsyncTextureJob));
+	filename_len = strlen(filename);
+	if (texture) {
+		texture->ready = false;
+		texture->failed = false;
+	}
+	if (job) job->filename = (char*)malloc(sizeof(char) * (filename_len + 1));
+	if (texture == NULL || job == NULL || job->filename == NULL) {
+		free(texture);
+		if (job) free(job->filename);
+		free(job);
+		SDL_SetError("Failed to allocate texture memory for BMP \"%s\"", filename);
+		return NULL;
+	}
+	memcpy(job->filename, filename, filename_len + 1);
+	job->texture = texture;
+	job->forceNrSqr = forceNrSqr;
+	job->state = ASYNC_TEXTURE_QUEUED;
+
+	// Texture usable now with placeholder; real image uploads into same name later
+	glGenTextures(1, &texture->data);
+	glStateBindTexture(texture->data);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+	texture->width = 1;
+	texture->height = 1;
+	texture->internal_format = GL_RGBA8;
+	texture->bytes = 4;
+
+	SDL_LockMutex(ASYNC_TEXTURE_LOCK);
+	pushAsyncTextureJob(&ASYNC_TEXTURE_DECODE_QUEUE, job);
+	SDL_CondSignal(ASYNC_TEXTURE_WAKE);
+	SDL_UnlockMutex(ASYNC_TEXTURE_LOCK);
+	ASYNC_TEXTURE_PENDING++;
+
+	return texture;
+}
+
+void uploadAsyncTexture(AsyncTextureJob* job) {
+	size_t size;
+	void* mapped = NULL;
+	SDL_Surface* surface = job->surface;
+
+	size = (size_t)surface->pitch * surface->h;
+	glStateBindTexture(job->texture->data);
+
+	// Stream through next pixel buffer; orphaning avoids waiting on its previous upload
+	if (ASYNC_TEXTURE_PBO_SUPPORTED) {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ASYNC_TEXTURE_PBOS[ASYNC_TEXTURE_PBO_NEXT]);
+		ASYNC_TEXTURE_PBO_NEXT = (ASYNC_TEXTURE_PBO_NEXT + 1) % ASYNC_TEXTURE_PBO_COUNT;
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+		mapped = glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+		if (mapped) {
+			memcpy(mapped, surface->pixels, size);
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, surface->w, surface->h, 0, GL_RGBA, GL_UNSIGNED_BYTE, (const void*)0);
+		}
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
+
+	// Direct upload without pixel buffers (or if mapping failed)
+	if (mapped == NULL) {
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, surface->w, surface->h, 0, GL_RGBA, GL_UNSIGNED_BYTE, surface->pixels);
+	}
+
+	job->texture->width = surface->w;
+	job->texture->height = surface->h;
+	job->texture->bytes = (size_t)surface->w * surface->h * 4;
+	job->texture->ready = true;
+}
+
+int updateAsyncTextures(size_t max_bytes, Uint32 max_us) {
+	size_t uploaded = 0;
+	Uint64 start;
+	Uint64 max_counts;
+	AsyncTextureJob* job;
+
+	if (!ASYNC_TEXTURE_LOCK) return 0;
+
+	start = SDL_GetPerformanceCounter();
+	max_counts = SDL_GetPerformanceFrequency() * max_us / 1000000;
+
+	while (ASYNC_TEXTURE_PENDING > 0) {
+		// Stop once either budget is used (after at least one upload)
+		if (uploaded > 0 && (uploaded >= max_bytes || SDL_GetPerformanceCounter() - start >= max_counts)) break;
+
+		SDL_LockMutex(ASYNC_TEXTURE_LOCK);
+		job = popAsyncTextureJob(&ASYNC_TEXTURE_UPLOAD_QUEUE);
+		SDL_UnlockMutex(ASYNC_TEXTURE_LOCK);
+		if (job == NULL) break;
+
+		// Failed loads keep placeholder but still finish (ready and failed)
+		if (job->state == ASYNC_TEXTURE_DECODED) {
+			uploadAsyncTexture(job);
+			uploaded += (size_t)job->surface->pitch * job->surface->h;
+		} else {
+			job->texture->failed = true;
+			job->texture->ready = true;
+		}
+
+		freeAsyncTextureJob(job);
+		ASYNC_TEXTURE_PENDING--;
+	}
+
+	return ASYNC_TEXTURE_PENDING;
+}
+
+void quitAsyncTextures() {
+	int i;
+	AsyncTextureJob* job;
+
+	if (!ASYNC_TEXTURE_LOCK) return;
+
+	// Stop and join workers
+	SDL_LockMutex(ASYNC_TEXTURE_LOCK);
+	ASYNC_TEXTURE_QUIT = true;
+	SDL_CondBroadcast(ASYNC_TEXTURE_WAKE);
+	SDL_UnlockMutex(ASYNC_TEXTURE_LOCK);
+	for (i = 0; i < ASYNC_TEXTURE_WORKER_COUNT; i++) SDL_WaitThread(ASYNC_TEXTURE_WORKERS[i], NULL);
+	ASYNC_TEXTURE_WORKER_COUNT = 0;
+
+	// Drop pending jobs
+	while ((job = popAsyncTextureJob(&ASYNC_TEXTURE_DECODE_QUEUE)) != NULL) freeAsyncTextureJob(job);
+	while ((job = popAsyncTextureJob(&ASYNC_TEXTURE_UPLOAD_QUEUE)) != NULL) freeAsyncTextureJob(job);
+	ASYNC_TEXTURE_PENDING = 0;
+
+	if (ASYNC_TEXTURE_PBO_SUPPORTED && ASYNC_TEXTURE_PBO_COUNT > 0) glDeleteBuffers(ASYNC_TEXTURE_PBO_COUNT, ASYNC_TEXTURE_PBOS);
+	ASYNC_TEXTURE_PBO_COUNT = 0;
+
+	SDL_DestroyCond(ASYNC_TEXTURE_WAKE);
+	SDL_DestroyMutex(ASYNC_TEXTURE_LOCK);
+	ASYNC_TEXTURE_WAKE = NULL;
+	ASYNC_TEXTURE_LOCK = NULL;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include <stdbool.h>
+
+#include <SDL.h>
+#include <SDL_opengl.h>
+
+#include "sdl_gl.h"
+
+#define ASYNC_TEXTURE_MAX_WORKERS 16
+#define ASYNC_TEXTURE_MAX_UPLOAD_BUFFERS 16
+
+/**
+ * Start worker threads and pixel buffer pool for asynchronous texture loading
+ *
+ * \param num_workers Worker threads for file I/O and pixel conversion
+ *                    (0 or less for CPU count - 1, minimum 1)
+ * \param num_upload_buffers Pixel buffer objects cycled for uploads
+ *                           (unused if GL_ARB_pixel_buffer_object unsupported)
+ * \returns true on success or false on failure; call SDL_GetError() for more information.
+ *
+ * \sa loadTextureBMPAsync
+ * \sa quitAsyncTextures
+ */
+extern bool initAsyncTextures(int num_workers, int num_upload_buffers);
+
+/**
+ * Queue BMP for loading and return its texture immediately
+ *
+ * Returned texture holds a 1x1 placeholder until updateAsyncTextures()
+ * uploads the loaded image into it (texture->ready becomes true).
+ * If the file fails to load, texture->ready still becomes true with
+ * texture->failed set and the placeholder kept.
+ * Texture name never changes, so it can be bound right away.
+ *
+ * \param filename BMP file to load from
+ * \param forceNrSqr See loadTextureBMP()
+ * \returns Texture or NULL on failure; call SDL_GetError() for more information.
+ *
+ * \warning Do not freeTexture() a texture still loading; wait for texture->ready
+ *          (set for failed loads too) or call quitAsyncTextures() first.
+ *
+ * \sa loadTextureBMP
+ * \sa updateAsyncTextures
+ */
+extern Texture* loadTextureBMPAsync(const char* filename, bool forceNrSqr);
+
+/**
+ * Upload textures finished by workers (call once per frame on render thread)
+ *
+ * Uploads stop once either budget is used; at least one texture is uploaded
+ * per call when one is available so large images still progress.
+ * Changes texture binding of active unit (via gl_state).
+ *
+ * \param max_bytes Upload byte budget for this call
+ * \param max_us Upload time budget in microseconds for this call
+ * \returns Number of textures still loading
+ *
+ * \sa loadTextureBMPAsync
+ */
+extern int updateAsyncTextures(size_t max_bytes, Uint32 max_us);
+
+/**
+ * Stop workers and free pending loads and pixel buffers
+ *
+ * Textures not yet uploaded keep their placeholder.
+ *
+ * \sa initAsyncTextures
+ */
+extern void quitAsyncTextures();
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,300 @@
+#include "texture_atlas.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "gl_state.h"
+
+typedef struct {
+	int x, y, width;
+} AtlasSkylineNode;
+
+typedef struct {
+	int num_nodes;
+	AtlasSkylineNode* nodes;
+} AtlasSkyline;
+
+typedef struct {
+	int index;
+	int w, h; // Including padding
+} AtlasItem;
+
+/*
+ * Skyline bottom-left packer
+ */
+static bool initAtlasSkyline(AtlasSkyline* skyline, int page_size) {
+	// A skyline never has more segments than pixels across
+	skyline->nodes = (AtlasSkylineNode*)malloc(sizeof(AtlasSkylineNode) * (page_size + 1));
+	if (!skyline->nodes) return false;
+	skyline->nodes[0].x = 0;
+	skyline->nodes[0].y = 0;
+	skyline->nodes[0].width = page_size;
+	skyline->num_nodes = 1;
+	return true;
+}
+
+// Lowest y a w x h rect can rest at when its left edge is on node, or -1
+static int fitAtlasSkyline(const AtlasSkyline* skyline, int node, int w, int h, int page_size) {
+	int x, y, remaining;
+
+	x = skyline->nodes[node].x;
+	if (x + w > page_size) return -1;
+
+	y = 0;
+	remaining = w;
+	while (remaining > 0) {
+		if (skyline->nodes[node].y > y) y = skyline->nodes[node].y;
+		if (y + h > page_size) return -1;
+		remaining -= skyline->nodes[node].width;
+		node++;
+	}
+	return y;
+}
+
+// Find best node (lowest top edge, then narrowest segment), returns false if nothing fits
+static bool findAtlasSkyline(const AtlasSkyline* skyline, int w, int h, int page_size, int* best_node, int* best_y) {
+	int i, y, best_top = page_size + 1, best_width = page_size + 1;
+
+	*best_node = -1;
+	for (i = 0; i < skyline->num_nodes; i++) {
+		y = fitAtlasSkyline(skyline, i, w, h, page_size);
+		if (y < 0) continue;
+		if (y + h < best_top || (y + h == best_top && skyline->nodes[i].width < best_width)) {
+			best_top = y + h;
+			best_width = skyline->nodes[i].width;
+			*best_node = i;
+			*best_y = y;
+		}
+	}
+	return *best_node >= 0;
+}
+
+static void insertAtlasSkyline(AtlasSkyline* skyline, int node, int x, int y, int w, int h) {
+	AtlasSkylineNode* nodes = skyline->nodes;
+	int shrink, i;
+
+	// New segment on top of placed rect
+	memmove(&nodes[node + 1], &nodes[node], sizeof(AtlasSkylineNode) * (skyline->num_nodes - node));
+	nodes[node].x = x;
+	nodes[node].y = y + h;
+	nodes[node].width = w;
+	skyline->num_nodes++;
+
+	// Trim or drop segments now under it
+	for (i = node + 1; i < skyline->num_nodes; i++) {
+		if (nodes[i].x >= nodes[i - 1].x + nodes[i - 1].width) break;
+		shrink = nodes[i - 1].x + nodes[i - 1].width - nodes[i].x;
+		nodes[i].x += shrink;
+		nodes[i].width -= shrink;
+		if (nodes[i].width > 0) break;
+		memmove(&nodes[i], &nodes[i + 1], sizeof(AtlasSkylineNode) * (skyline->num_nodes - i - 1));
+		skyline->num_nodes--;
+		i--;
+	}
+
+	// Merge neighbours at equal height
+	for (i = 0; i < skyline->num_nodes - 1; i++) {
+		if (nodes[i].y == nodes[i + 1].y) {
+			nodes[i].width += nodes[i + 1].width;
+			memmove(&nodes[i + 1], &nodes[i + 2], sizeof(AtlasSkylineNode) * (skyline->num_nodes - i - 2));
+			skyline->num_nodes--;
+			i--;
+		}
+	}
+}
+
+static int compareAtlasItems(const void* a, const void* b) {
+	const AtlasItem* item_a = (const AtlasItem*)a;
+	const AtlasItem* item_b = (const AtlasItem*)b;
+
+	// Tallest first, then widest, keeps skyline flat
+	if (item_a->h != item_b->h) return item_b->h - item_a->h;
+	if (item_a->w != item_b->w) return item_b->w - item_a->w;
+	return item_a->index - item_b->index;
+}
+
+/*
+ * Page composition
+ */
+// Copy image into page at region and replicate its edges into padding
+static void blitAtlasRegion(SDL_Surface* page, SDL_Surface* image, const AtlasRegion* region, int padding) {
+	Uint32* row;
+	Uint32 left, right;
+	int x, y;
+
+	for (y = 0; y < image->h; y++) {
+		row = (Uint32*)((Uint8*)page->pixels + (size_t)(region->y + y) * page->pitch) + region->x;
+		memcpy(row, (Uint8*)image->pixels + (size_t)y * image->pitch, (size_t)image->w * 4);
+		left = row[0];
+		right = row[image->w - 1];
+		for (x = 1; x <= padding; x++) {
+			row[-x] = left;
+			row[image->w - 1 + x] = right;
+		}
+	}
+	for (y = 1; y <= padding; y++) {
+		memcpy((Uint32*)((Uint8*)page->pixels + (size_t)(region->y - y) * page->pitch) + region->x - padding,
+			(Uint32*)((Uint8*)page->pixels + (size_t)region->y * page->pitch) + region->x - padding,
+			(size_t)(image->w + padding * 2) * 4);
+		memcpy((Uint32*)((Uint8*)page->pixels + (size_t)(region->y + image->h - 1 + y) * page->pitch) + region->x - padding,
+			(Uint32*)((Uint8*)page->pixels + (size_t)(region->y + image->h - 1) * page->pitch) + region->x - padding,
+			(size_t)(image->w + padding * 2) * 4);
+	}
+}
+
+static Texture* uploadAtlasPage(SDL_Surface* page) {
+	Texture* texture;
+
+	texture = (Texture*)malloc(sizeof(Texture));
+	if (texture == NULL) return NULL;
+
+	glGenTextures(1, &texture->data);
+	glStateBindTexture(texture->data);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, page->w, page->h, 0, GL_RGBA, GL_UNSIGNED_BYTE, page->pixels);
+	texture->width = page->w;
+	texture->height = page->h;
+	texture->internal_format = GL_RGBA8;
+	texture->bytes = (size_t)page->w * page->h * 4;
+	texture->ready = true;
+	texture->failed = false;
+
+	return texture;
+}
+
+/*
+ * Public API
+ */
+TextureAtlas* createTextureAtlas(const char** filenames, int num_files, int page_size, int padding) {
+	TextureAtlas* atlas;
+	SDL_Surface** images;
+	SDL_Surface* pages[TEXTURE_ATLAS_MAX_PAGES];
+	AtlasSkyline skylines[TEXTURE_ATLAS_MAX_PAGES];
+	AtlasItem* items;
+	AtlasRegion* region;
+	GLint max_size;
+	int i, p, node, y;
+
+	// Page must be a texture the driver accepts
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+	if (page_size > max_size) page_size = max_size;
+	if (SDL_GL_VERSION[0] == '1') page_size = nearestPowerOfTwo(page_size + 1) / 2;
+	if (padding < 0) padding = 0;
+
+	atlas = (TextureAtlas*)calloc(1, sizeof(TextureAtlas));
+	images = (SDL_Surface**)calloc(num_files, sizeof(SDL_Surface*));
+	items = (AtlasItem*)malloc(sizeof(AtlasItem) * num_files);
+	if (atlas) atlas->regions = (AtlasRegion*)calloc(num_files, sizeof(AtlasRegion));
+	if (!atlas || !images || !items || !atlas->regions) {
+		if (atlas) free(atlas->regions);
+		free(atlas);
+		free(images);
+		free(items);
+		SDL_SetError("Failed to allocate texture atlas memory for %d images", num_files);
+		return NULL;
+	}
+	atlas->width = page_size;
+	atlas->height = page_size;
+	atlas->num_regions = num_files;
+
+	// Load every image at native size
+	for (i = 0; i < num_files; i++) {
+		images[i] = loadSurfaceBMPEx(filenames[i], TEXTURE_KEEP_SIZE);
+		if (!images[i]) goto fail;
+		items[i].index = i;
+		items[i].w = images[i]->w + padding * 2;
+		items[i].h = images[i]->h + padding * 2;
+		if (items[i].w > page_size || items[i].h > page_size) {
+			SDL_SetError("BMP \"%s\" (%dx%d + %d padding) does not fit %dx%d atlas page", filenames[i], images[i]->w, images[i]->h, padding, page_size, page_size);
+			goto fail;
+		}
+	}
+	qsort(items, num_files, sizeof(AtlasItem), compareAtlasItems);
+
+	// Place on first page with room, open new page otherwise
+	for (i = 0; i < num_files; i++) {
+		for (p = 0; p < atlas->num_pages; p++) {
+			if (findAtlasSkyline(&skylines[p], items[i].w, items[i].h, page_size, &node, &y)) break;
+		}
+		if (p == atlas->num_pages) {
+			if (p == TEXTURE_ATLAS_MAX_PAGES) {
+				SDL_SetError("Texture atlas needs more than %d pages of %dx%d", TEXTURE_ATLAS_MAX_PAGES, page_size, page_size);
+				goto fail;
+			}
+			if (!initAtlasSkyline(&skylines[p], page_size)) {
+				SDL_SetError("Failed to allocate texture atlas skyline");
+				goto fail;
+			}
+			pages[p] = NULL;
+			atlas->num_pages++;
+			findAtlasSkyline(&skylines[p], items[i].w, items[i].h, page_size, &node, &y);
+		}
+
+		region = &atlas->regions[items[i].index];
+		region->page = p;
+		region->x = skylines[p].nodes[node].x + padding;
+		region->y = y + padding;
+		region->w = items[i].w - padding * 2;
+		region->h = items[i].h - padding * 2;
+		region->u0 = (float)region->x / page_size;
+		region->v0 = (float)region->y / page_size;
+		region->u1 = (float)(region->x + region->w) / page_size;
+		region->v1 = (float)(region->y + region->h) / page_size;
+		insertAtlasSkyline(&skylines[p], node, skylines[p].nodes[node].x, y, items[i].w, items[i].h);
+	}
+
+	// Compose and upload pages
+	for (p = 0; p < atlas->num_pages; p++) {
+		pages[p] = SDL_CreateRGBSurfaceWithFormat(0, page_size, page_size, 32, SDL_PIXELFORMAT_RGBA32);
+		if (!pages[p]) {
+			SDL_SetError("Failed to create %dx%d atlas page | SDL surface error: %s", page_size, page_size, SDL_GetError());
+			goto fail;
+		}
+	}
+	for (i = 0; i < num_files; i++) {
+		blitAtlasRegion(pages[atlas->regions[i].page], images[i], &atlas->regions[i], padding);
+	}
+	for (p = 0; p < atlas->num_pages; p++) {
+		atlas->pages[p] = uploadAtlasPage(pages[p]);
+		if (!atlas->pages[p]) {
+			SDL_SetError("Failed to allocate texture memory for atlas page %d", p);
+			goto fail;
+		}
+	}
+
+	for (p = 0; p < atlas->num_pages; p++) {
+		SDL_FreeSurface(pages[p]);
+		free(skylines[p].nodes);
+	}
+	for (i = 0; i < num_files; i++) SDL_FreeSurface(images[i]);
+	free(images);
+	free(items);
+	return atlas;
+
+fail:
+	for (p = 0; p < atlas->num_pages; p++) {
+		if (pages[p]) SDL_FreeSurface(pages[p]);
+		free(skylines[p].nodes);
+	}
+	for (i = 0; i < num_files; i++) {
+		if (images[i]) SDL_FreeSurface(images[i]);
+	}
+	free(images);
+	free(items);
+	freeTextureAtlas(atlas);
+	return NULL;
+}
+
+void freeTextureAtlas(TextureAtlas* atlas) {
+	int p;
+
+	if (!atlas) return;
+	for (p = 0; p < atlas->num_pages; p++) {
+		if (atlas->pages[p]) freeTexture(atlas->pages[p]);
+	}
+	free(atlas->regions);
+	free(atlas);
+}
@@ -0,0 +1,60 @@
+#pragma once
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include <stdbool.h>
+
+#include <SDL.h>
+#include <SDL_opengl.h>
+
+#include "sdl_gl.h"
+
+#define TEXTURE_ATLAS_MAX_PAGES 16
+
+typedef struct {
+	int page;       // Index into TextureAtlas.pages
+	int x, y, w, h; // Pixel rectangle on page (excluding padding)
+	float u0, v0;   // Texture coordinates of top-left corner
+	float u1, v1;   // Texture coordinates of bottom-right corner
+} AtlasRegion;
+
+typedef struct {
+	int width, height;
+	int num_pages;
+	Texture* pages[TEXTURE_ATLAS_MAX_PAGES];
+	int num_regions;
+	AtlasRegion* regions;
+} TextureAtlas;
+
+/**
+ * Pack many BMPs into as few textures as possible
+ *
+ * Images are sorted by height and placed with a skyline bottom-left packer,
+ * opening a new page when one fills. Each image is surrounded by padding
+ * filled with its own edge pixels (extrusion), so filtering near region
+ * edges never bleeds neighbouring images.
+ *
+ * \param filenames BMP files to load from
+ * \param num_files Number of filenames
+ * \param page_size Page width and height in pixels (clamped to GL_MAX_TEXTURE_SIZE)
+ * \param padding Extruded border around each image in pixels (eg: 1 for GL_LINEAR, more with mipmaps)
+ * \returns TextureAtlas with one region per filename (same order) or NULL on failure;
+ *          call SDL_GetError() for more information.
+ *
+ * \warning User must free returned atlas with freeTextureAtlas()
+ *
+ * \sa AtlasRegion
+ */
+extern TextureAtlas* createTextureAtlas(const char** filenames, int num_files, int page_size, int padding);
+
+/**
+ * Free atlas pages and regions
+ *
+ * \param atlas Atlas to free (NULL is ignored)
+ */
+extern void freeTextureAtlas(TextureAtlas* atlas);
+
+#ifdef __cplusplus
+}
+#endif
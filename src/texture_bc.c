@@ -0,0 +1,735 @@
+#include "texture_bc.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "gl_state.h"
+#include "glsl_ext.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BC_SSE2
+#include <emmintrin.h>
+#endif
+
+#define BC_FILE_MAGIC 0x58544342 // "BCTX"
+#define BC_FILE_VERSION 1
+#define BC_FILE_MAX_SIZE 16384 // Largest width/height accepted from file
+
+typedef struct {
+	Uint32 magic;
+	Uint32 version;
+	Uint32 format;
+	Uint32 width;
+	Uint32 height;
+	Uint32 num_levels;
+} CompressedFileHeader;
+
+typedef struct {
+	SDL_Surface* surface;
+	Uint8* blocks;
+	int format;
+	int blocks_x;
+} CompressJob;
+
+int BC_UPLOAD_SUPPORTED = -1;
+
+/*
+ * Helpers
+ */
+static int getBCBlockSize(int format) {
+	return format == BC_FORMAT_BC1 ? 8 : 16;
+}
+
+// Bytes of w x h level or 0 if it does not fit in Uint32
+static Uint32 getBCLevelSize(int format, int w, int h) {
+	size_t blocks_x, blocks_y, block_size;
+
+	if (w <= 0 || h <= 0) return 0;
+	blocks_x = ((size_t)w + 3) / 4;
+	blocks_y = ((size_t)h + 3) / 4;
+	block_size = (size_t)getBCBlockSize(format);
+	if (blocks_x > 0xFFFFFFFFu / block_size / blocks_y) return 0;
+	return (Uint32)(blocks_x * blocks_y * block_size);
+}
+
+// Mip levels down to 1x1 for w x h (createMipmapChain() halves the larger side too)
+static int getBCMaxLevels(int w, int h) {
+	int levels = 1;
+
+	while (w > 1 || h > 1) {
+		w = w > 1 ? w / 2 : 1;
+		h = h > 1 ? h / 2 : 1;
+		levels++;
+	}
+	return levels;
+}
+
+// Read 4x4 RGBA block, clamping at right/bottom edges (sizes not multiple of 4)
+static void fetchBCBlock(SDL_Surface* surface, int bx, int by, Uint8 block[64]) {
+	int x, y, sx, sy;
+
+	for (y = 0; y < 4; y++) {
+		sy = by * 4 + y < surface->h ? by * 4 + y : surface->h - 1;
+		for (x = 0; x < 4; x++) {
+			sx = bx * 4 + x < surface->w ? bx * 4 + x : surface->w - 1;
+			memcpy(block + (y * 4 + x) * 4, (Uint8*)surface->pixels + (size_t)sy * surface->pitch + sx * 4, 4);
+		}
+	}
+}
+
+static Uint16 quantizeBC565(const float c[3]) {
+	int r, g, b;
+
+	r = (int)(c[0] * 31.0f / 255.0f + 0.5f);
+	g = (int)(c[1] * 63.0f / 255.0f + 0.5f);
+	b = (int)(c[2] * 31.0f / 255.0f + 0.5f);
+	r = r < 0 ? 0 : r > 31 ? 31 : r;
+	g = g < 0 ? 0 : g > 63 ? 63 : g;
+	b = b < 0 ? 0 : b > 31 ? 31 : b;
+	return (Uint16)((r << 11) | (g << 5) | b);
+}
+
+static void expandBC565(Uint16 c, Uint8 rgba[4]) {
+	int r = c >> 11, g = (c >> 5) & 0x3F, b = c & 0x1F;
+
+	rgba[0] = (Uint8)((r << 3) | (r >> 2));
+	rgba[1] = (Uint8)((g << 2) | (g >> 4));
+	rgba[2] = (Uint8)((b << 3) | (b >> 2));
+	rgba[3] = 0xFF;
+}
+
+// Palette as decoded by hardware (four_color: c0 > c1 or any BC3 block)
+static void buildBCColorPalette(Uint16 c0, Uint16 c1, bool four_color, Uint8 palette[16]) {
+	int i;
+
+	expandBC565(c0, palette);
+	expandBC565(c1, palette + 4);
+	for (i = 0; i < 3; i++) {
+		if (four_color) {
+			palette[8 + i] = (Uint8)((2 * palette[i] + palette[4 + i]) / 3);
+			palette[12 + i] = (Uint8)((palette[i] + 2 * palette[4 + i]) / 3);
+		} else {
+			palette[8 + i] = (Uint8)((palette[i] + palette[4 + i]) / 2);
+			palette[12 + i] = 0;
+		}
+	}
+	palette[11] = 0xFF;
+	palette[15] = four_color ? 0xFF : 0x00;
+}
+
+/*
+ * Index search: nearest palette color (RGB squared distance) per pixel
+ */
+#ifdef BC_SSE2
+static Uint32 findBCColorIndices(const Uint8 block[64], const Uint8 palette[16], Uint8 indices[16]) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i rgb_mask = _mm_set1_epi32(0x00FFFFFF);
+	__m128i colors[4];
+	__m128i lo, hi, d, sq_lo, sq_hi, dist, best, best_index, less;
+	Uint32 best_dists[4], best_indices[4], error = 0, color;
+	int i, c, k;
+
+	for (c = 0; c < 4; c++) {
+		memcpy(&color, palette + c * 4, 4);
+		colors[c] = _mm_unpacklo_epi8(_mm_and_si128(_mm_set1_epi32((int)color), rgb_mask), zero);
+	}
+
+	// 4 pixels per iteration, widened to 16-bit, squared and summed with madd
+	for (i = 0; i < 16; i += 4) {
+		d = _mm_and_si128(_mm_loadu_si128((const __m128i*)(block + i * 4)), rgb_mask);
+		lo = _mm_unpacklo_epi8(d, zero);
+		hi = _mm_unpackhi_epi8(d, zero);
+		best = best_index = zero;
+		for (c = 0; c < 4; c++) {
+			d = _mm_sub_epi16(lo, colors[c]);
+			sq_lo = _mm_madd_epi16(d, d);
+			d = _mm_sub_epi16(hi, colors[c]);
+			sq_hi = _mm_madd_epi16(d, d);
+			// Lanes hold (r2+g2, b2+0) per pixel, gather and add halves
+			dist = _mm_add_epi32(
+				_mm_unpacklo_epi64(_mm_shuffle_epi32(sq_lo, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_epi32(sq_hi, _MM_SHUFFLE(2, 0, 2, 0))),
+				_mm_unpacklo_epi64(_mm_shuffle_epi32(sq_lo, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_epi32(sq_hi, _MM_SHUFFLE(3, 1, 3, 1))));
+			if (c == 0) {
+				best = dist;
+				continue;
+			}
+			less = _mm_cmplt_epi32(dist, best);
+			best = _mm_or_si128(_mm_and_si128(less, dist), _mm_andnot_si128(less, best));
+			best_index = _mm_or_si128(_mm_and_si128(less, _mm_set1_epi32(c)), _mm_andnot_si128(less, best_index));
+		}
+		_mm_storeu_si128((__m128i*)best_dists, best);
+		_mm_storeu_si128((__m128i*)best_indices, best_index);
+		for (k = 0; k < 4; k++) {
+			indices[i + k] = (Uint8)best_indices[k];
+			error += best_dists[k];
+		}
+	}
+	return error;
+}
+#else
+static Uint32 findBCColorIndices(const Uint8 block[64], const Uint8 palette[16], Uint8 indices[16]) {
+	Uint32 error = 0, dist, best;
+	int i, c, dr, dg, db;
+
+	for (i = 0; i < 16; i++) {
+		best = 0xFFFFFFFF;
+		for (c = 0; c < 4; c++) {
+			dr = block[i * 4 + 0] - palette[c * 4 + 0];
+			dg = block[i * 4 + 1] - palette[c * 4 + 1];
+			db = block[i * 4 + 2] - palette[c * 4 + 2];
+			dist = (Uint32)(dr * dr + dg * dg + db * db);
+			if (dist < best) {
+				best = dist;
+				indices[i] = (Uint8)c;
+			}
+		}
+		error += best;
+	}
+	return error;
+}
+#endif
+
+/*
+ * Color block (BC1, and color half of BC3)
+ */
+// Principal axis of block colors by power iteration, endpoints at projection extremes
+static void findBCColorEndpoints(const Uint8 block[64], float e0[3], float e1[3]) {
+	float mean[3] = {0.0f, 0.0f, 0.0f}, cov[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+	float axis[3], next[3], d[3], t, t_min, t_max, scale;
+	int i, k;
+
+	for (i = 0; i < 16; i++) {
+		for (k = 0; k < 3; k++) mean[k] += block[i * 4 + k];
+	}
+	for (k = 0; k < 3; k++) mean[k] /= 16.0f;
+	for (i = 0; i < 16; i++) {
+		for (k = 0; k < 3; k++) d[k] = block[i * 4 + k] - mean[k];
+		cov[0] += d[0] * d[0];
+		cov[1] += d[0] * d[1];
+		cov[2] += d[0] * d[2];
+		cov[3] += d[1] * d[1];
+		cov[4] += d[1] * d[2];
+		cov[5] += d[2] * d[2];
+	}
+
+	axis[0] = axis[1] = axis[2] = 1.0f;
+	for (i = 0; i < 8; i++) {
+		next[0] = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+		next[1] = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+		next[2] = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+		scale = fabsf(next[0]) > fabsf(next[1]) ? fabsf(next[0]) : fabsf(next[1]);
+		if (fabsf(next[2]) > scale) scale = fabsf(next[2]);
+		// Flat block, every pixel equals mean
+		if (scale == 0.0f) {
+			memcpy(e0, mean, sizeof(mean));
+			memcpy(e1, mean, sizeof(mean));
+			return;
+		}
+		for (k = 0; k < 3; k++) axis[k] = next[k] / scale;
+	}
+	scale = 1.0f / sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+	for (k = 0; k < 3; k++) axis[k] *= scale;
+
+	t_min = t_max = 0.0f;
+	for (i = 0; i < 16; i++) {
+		t = 0.0f;
+		for (k = 0; k < 3; k++) t += (block[i * 4 + k] - mean[k]) * axis[k];
+		if (t < t_min) t_min = t;
+		if (t > t_max) t_max = t;
+	}
+	for (k = 0; k < 3; k++) {
+		e0[k] = mean[k] + axis[k] * t_max;
+		e1[k] = mean[k] + axis[k] * t_min;
+	}
+}
+
+// Order endpoints for four color mode and pick indices, returns squared error
+static Uint32 fitBCColorEndpoints(const Uint8 block[64], Uint16* c0, Uint16* c1, Uint8 indices[16]) {
+	Uint8 palette[16];
+	Uint16 swap;
+	Uint32 error;
+
+	if (*c0 < *c1) {
+		swap = *c0;
+		*c0 = *c1;
+		*c1 = swap;
+	}
+	buildBCColorPalette(*c0, *c1, true, palette);
+	error = findBCColorIndices(block, palette, indices);
+	// Equal endpoints decode as three color mode, index 0 is still exact
+	if (*c0 == *c1) memset(indices, 0, 16);
+	return error;
+}
+
+// Least squares endpoints for fixed indices
+static bool refineBCColorEndpoints(const Uint8 block[64], const Uint8 indices[16], float e0[3], float e1[3]) {
+	static const float weights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+	float a2 = 0.0f, ab = 0.0f, b2 = 0.0f, ax[3] = {0.0f, 0.0f, 0.0f}, bx[3] = {0.0f, 0.0f, 0.0f};
+	float a, b, det;
+	int i, k;
+
+	for (i = 0; i < 16; i++) {
+		a = weights[indices[i]];
+		b = 1.0f - a;
+		a2 += a * a;
+		ab += a * b;
+		b2 += b * b;
+		for (k = 0; k < 3; k++) {
+			ax[k] += a * block[i * 4 + k];
+			bx[k] += b * block[i * 4 + k];
+		}
+	}
+	det = a2 * b2 - ab * ab;
+	if (fabsf(det) < 1e-6f) return false;
+	for (k = 0; k < 3; k++) {
+		e0[k] = (ax[k] * b2 - bx[k] * ab) / det;
+		e1[k] = (bx[k] * a2 - ax[k] * ab) / det;
+	}
+	return true;
+}
+
+static void encodeBCColorBlock(const Uint8 block[64], Uint8 out[8]) {
+	float e0[3], e1[3];
+	Uint16 c0, c1, r0, r1;
+	Uint8 indices[16], refined[16];
+	Uint32 error, bits;
+	int i;
+
+	findBCColorEndpoints(block, e0, e1);
+	c0 = quantizeBC565(e0);
+	c1 = quantizeBC565(e1);
+	error = fitBCColorEndpoints(block, &c0, &c1, indices);
+
+	// One refinement pass, kept only if it lowers error
+	if (error > 0 && c0 != c1 && refineBCColorEndpoints(block, indices, e0, e1)) {
+		r0 = quantizeBC565(e0);
+		r1 = quantizeBC565(e1);
+		if (fitBCColorEndpoints(block, &r0, &r1, refined) < error) {
+			c0 = r0;
+			c1 = r1;
+			memcpy(indices, refined, 16);
+		}
+	}
+
+	bits = 0;
+	for (i = 0; i < 16; i++) bits |= (Uint32)indices[i] << (i * 2);
+	out[0] = (Uint8)(c0 & 0xFF);
+	out[1] = (Uint8)(c0 >> 8);
+	out[2] = (Uint8)(c1 & 0xFF);
+	out[3] = (Uint8)(c1 >> 8);
+	out[4] = (Uint8)(bits & 0xFF);
+	out[5] = (Uint8)((bits >> 8) & 0xFF);
+	out[6] = (Uint8)((bits >> 16) & 0xFF);
+	out[7] = (Uint8)(bits >> 24);
+}
+
+/*
+ * Alpha block (BC3)
+ */
+static void buildBCAlphaPalette(Uint8 a0, Uint8 a1, Uint8 palette[8]) {
+	int i;
+
+	palette[0] = a0;
+	palette[1] = a1;
+	if (a0 > a1) {
+		for (i = 1; i < 7; i++) palette[i + 1] = (Uint8)(((7 - i) * a0 + i * a1) / 7);
+	} else {
+		for (i = 1; i < 5; i++) palette[i + 1] = (Uint8)(((5 - i) * a0 + i * a1) / 5);
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+}
+
+static void encodeBCAlphaBlock(const Uint8 block[64], Uint8 out[8]) {
+	Uint8 palette[8], a_min = 255, a_max = 0;
+	Uint64 bits = 0;
+	int i, c, best, dist, index;
+
+	for (i = 0; i < 16; i++) {
+		if (block[i * 4 + 3] < a_min) a_min = block[i * 4 + 3];
+		if (block[i * 4 + 3] > a_max) a_max = block[i * 4 + 3];
+	}
+	out[0] = a_max;
+	out[1] = a_min;
+
+	// Eight value mode (a0 > a1) spans min..max, equal endpoints need no indices
+	if (a_max != a_min) {
+		buildBCAlphaPalette(a_max, a_min, palette);
+		for (i = 0; i < 16; i++) {
+			best = 256;
+			index = 0;
+			for (c = 0; c < 8; c++) {
+				dist = abs(block[i * 4 + 3] - palette[c]);
+				if (dist < best) {
+					best = dist;
+					index = c;
+				}
+			}
+			bits |= (Uint64)index << (i * 3);
+		}
+	}
+	for (i = 0; i < 6; i++) out[2 + i] = (Uint8)((bits >> (i * 8)) & 0xFF);
+}
+
+/*
+ * Block decoding
+ */
+static void decodeBCBlock(const Uint8* in, int format, Uint8 block[64]) {
+	const Uint8* color = format == BC_FORMAT_BC1 ? in : in + 8;
+	Uint8 palette[16], alpha[8];
+	Uint16 c0, c1;
+	Uint32 bits;
+	Uint64 alpha_bits = 0;
+	int i;
+
+	c0 = (Uint16)(color[0] | (color[1] << 8));
+	c1 = (Uint16)(color[2] | (color[3] << 8));
+	bits = (Uint32)color[4] | ((Uint32)color[5] << 8) | ((Uint32)color[6] << 16) | ((Uint32)color[7] << 24);
+	buildBCColorPalette(c0, c1, format != BC_FORMAT_BC1 || c0 > c1, palette);
+	for (i = 0; i < 16; i++) memcpy(block + i * 4, palette + ((bits >> (i * 2)) & 3) * 4, 4);
+
+	if (format == BC_FORMAT_BC3) {
+		buildBCAlphaPalette(in[0], in[1], alpha);
+		for (i = 0; i < 6; i++) alpha_bits |= (Uint64)in[2 + i] << (i * 8);
+		for (i = 0; i < 16; i++) block[i * 4 + 3] = alpha[(alpha_bits >> (i * 3)) & 7];
+	}
+}
+
+/*
+ * Compression
+ */
+static void compressBCRows(void* data, int row_begin, int row_end) {
+	CompressJob* job = (CompressJob*)data;
+	Uint8 block[64];
+	Uint8* out;
+	int bx, by;
+
+	for (by = row_begin; by < row_end; by++) {
+		for (bx = 0; bx < job->blocks_x; bx++) {
+			out = job->blocks + ((size_t)by * job->blocks_x + bx) * getBCBlockSize(job->format);
+			fetchBCBlock(job->surface, bx, by, block);
+			if (job->format == BC_FORMAT_BC3) {
+				encodeBCAlphaBlock(block, out);
+				encodeBCColorBlock(block, out + 8);
+			} else {
+				encodeBCColorBlock(block, out);
+			}
+		}
+	}
+}
+
+static bool isSurfaceOpaque(SDL_Surface* surface) {
+	const Uint8* row;
+	int x, y;
+
+	for (y = 0; y < surface->h; y++) {
+		row = (const Uint8*)surface->pixels + (size_t)y * surface->pitch;
+		for (x = 0; x < surface->w; x++) {
+			if (row[x * 4 + 3] != 0xFF) return false;
+		}
+	}
+	return true;
+}
+
+CompressedImage* compressMipmapChain(const MipmapChain* chain, int format, int num_threads) {
+	CompressedImage* image;
+	CompressJob job;
+	int i;
+
+	for (i = 0; i < chain->num_levels; i++) {
+		if (chain->levels[i]->format->format != SDL_PIXELFORMAT_RGBA32) {
+			SDL_SetError("Block compression requires SDL_PIXELFORMAT_RGBA32 levels");
+			return NULL;
+		}
+	}
+	if (format == BC_FORMAT_AUTO) format = isSurfaceOpaque(chain->levels[0]) ? BC_FORMAT_BC1 : BC_FORMAT_BC3;
+
+	image = (CompressedImage*)calloc(1, sizeof(CompressedImage));
+	if (!image) {
+		SDL_SetError("Failed to allocate compressed image");
+		return NULL;
+	}
+	image->format = format;
+	image->width = chain->levels[0]->w;
+	image->height = chain->levels[0]->h;
+
+	for (i = 0; i < chain->num_levels; i++) {
+		image->level_width[i] = chain->levels[i]->w;
+		image->level_height[i] = chain->levels[i]->h;
+		image->level_size[i] = getBCLevelSize(format, chain->levels[i]->w, chain->levels[i]->h);
+		image->levels[i] = image->level_size[i] ? (Uint8*)malloc(image->level_size[i]) : NULL;
+		if (!image->levels[i]) {
+			freeCompressedImage(image);
+			SDL_SetError("Failed to allocate compressed level %d", i);
+			return NULL;
+		}
+		image->num_levels++;
+
+		job.surface = chain->levels[i];
+		job.blocks = image->levels[i];
+		job.format = format;
+		job.blocks_x = (chain->levels[i]->w + 3) / 4;
+		runTextureRows(compressBCRows, &job, (chain->levels[i]->h + 3) / 4, job.blocks_x * 64, num_threads);
+	}
+
+	return image;
+}
+
+CompressedImage* compressSurface(SDL_Surface* surface, int format, int num_threads) {
+	MipmapChain chain;
+
+	chain.num_levels = 1;
+	chain.levels[0] = surface;
+	return compressMipmapChain(&chain, format, num_threads);
+}
+
+SDL_Surface* decompressImageLevel(const CompressedImage* image, int level) {
+	SDL_Surface* surface;
+	Uint8 block[64];
+	int bx, by, blocks_x, x, y, w, h;
+
+	if (level < 0 || level >= image->num_levels) {
+		SDL_SetError("Compressed image has no level %d", level);
+		return NULL;
+	}
+	w = image->level_width[level];
+	h = image->level_height[level];
+	surface = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_RGBA32);
+	if (!surface) return NULL;
+
+	blocks_x = (w + 3) / 4;
+	for (by = 0; by < (h + 3) / 4; by++) {
+		for (bx = 0; bx < blocks_x; bx++) {
+			decodeBCBlock(image->levels[level] + ((size_t)by * blocks_x + bx) * getBCBlockSize(image->format), image->format, block);
+			for (y = 0; y < 4 && by * 4 + y < h; y++) {
+				for (x = 0; x < 4 && bx * 4 + x < w; x++) {
+					memcpy((Uint8*)surface->pixels + (size_t)(by * 4 + y) * surface->pitch + (bx * 4 + x) * 4, block + (y * 4 + x) * 4, 4);
+				}
+			}
+		}
+	}
+	return surface;
+}
+
+double getCompressedPSNR(const CompressedImage* image, SDL_Surface* reference) {
+	SDL_Surface* decoded;
+	const Uint8* a;
+	const Uint8* b;
+	double sum = 0.0, mse, diff;
+	int channels, x, y, c;
+
+	if (reference->format->format != SDL_PIXELFORMAT_RGBA32 || reference->w != image->width || reference->h != image->height) return -1.0;
+	decoded = decompressImageLevel(image, 0);
+	if (!decoded) return -1.0;
+
+	channels = image->format == BC_FORMAT_BC3 ? 4 : 3;
+	for (y = 0; y < reference->h; y++) {
+		a = (const Uint8*)reference->pixels + (size_t)y * reference->pitch;
+		b = (const Uint8*)decoded->pixels + (size_t)y * decoded->pitch;
+		for (x = 0; x < reference->w; x++) {
+			for (c = 0; c < channels; c++) {
+				diff = (double)a[x * 4 + c] - b[x * 4 + c];
+				sum += diff * diff;
+			}
+		}
+	}
+	SDL_FreeSurface(decoded);
+
+	mse = sum / ((double)reference->w * reference->h * channels);
+	if (mse == 0.0) return 99.0;
+	return 10.0 * log10(255.0 * 255.0 / mse);
+}
+
+/*
+ * File I/O
+ */
+bool saveCompressedImage(const CompressedImage* image, const char* filename) {
+	CompressedFileHeader header;
+	FILE* file;
+	int i;
+
+	file = fopen(filename, "wb");
+	if (!file) {
+		SDL_SetError("Failed to open \"%s\" for writing", filename);
+		return false;
+	}
+
+	header.magic = BC_FILE_MAGIC;
+	header.version = BC_FILE_VERSION;
+	header.format = (Uint32)image->format;
+	header.width = (Uint32)image->width;
+	header.height = (Uint32)image->height;
+	header.num_levels = (Uint32)image->num_levels;
+	if (fwrite(&header, sizeof(header), 1, file) != 1) goto fail;
+	for (i = 0; i < image->num_levels; i++) {
+		if (fwrite(image->levels[i], 1, image->level_size[i], file) != image->level_size[i]) goto fail;
+	}
+
+	fclose(file);
+	return true;
+
+fail:
+	fclose(file);
+	remove(filename);
+	SDL_SetError("Failed to write compressed image \"%s\"", filename);
+	return false;
+}
+
+CompressedImage* loadCompressedImage(const char* filename) {
+	CompressedFileHeader header;
+	CompressedImage* image;
+	FILE* file;
+	int i, w, h;
+
+	file = fopen(filename, "rb");
+	if (!file) {
+		SDL_SetError("Failed to open compressed image \"%s\"", filename);
+		return NULL;
+	}
+	if (fread(&header, sizeof(header), 1, file) != 1 ||
+		header.magic != BC_FILE_MAGIC ||
+		header.version != BC_FILE_VERSION ||
+		(header.format != BC_FORMAT_BC1 && header.format != BC_FORMAT_BC3) ||
+		header.width == 0 || header.height == 0 ||
+		header.width > BC_FILE_MAX_SIZE || header.height > BC_FILE_MAX_SIZE ||
+		header.num_levels == 0 || header.num_levels > MIPMAP_MAX_LEVELS ||
+		header.num_levels > (Uint32)getBCMaxLevels((int)header.width, (int)header.height)) {
+		fclose(file);
+		SDL_SetError("Invalid compressed image header in \"%s\"", filename);
+		return NULL;
+	}
+
+	image = (CompressedImage*)calloc(1, sizeof(CompressedImage));
+	if (!image) {
+		fclose(file);
+		SDL_SetError("Failed to allocate compressed image");
+		return NULL;
+	}
+	image->format = (int)header.format;
+	image->width = (int)header.width;
+	image->height = (int)header.height;
+
+	// Levels halve (rounding down, minimum 1) like createMipmapChain()
+	w = image->width;
+	h = image->height;
+	for (i = 0; i < (int)header.num_levels; i++) {
+		image->level_width[i] = w;
+		image->level_height[i] = h;
+		image->level_size[i] = getBCLevelSize(image->format, w, h);
+		image->levels[i] = image->level_size[i] ? (Uint8*)malloc(image->level_size[i]) : NULL;
+		if (!image->levels[i]) break;
+		image->num_levels++;
+		if (fread(image->levels[i], 1, image->level_size[i], file) != image->level_size[i]) break;
+		w = w > 1 ? w / 2 : 1;
+		h = h > 1 ? h / 2 : 1;
+	}
+	fclose(file);
+
+	if (image->num_levels != (int)header.num_levels || i != (int)header.num_levels) {
+		freeCompressedImage(image);
+		SDL_SetError("Truncated compressed image \"%s\"", filename);
+		return NULL;
+	}
+	return image;
+}
+
+void freeCompressedImage(CompressedImage* image) {
+	int i;
+
+	if (!image) return;
+	for (i = 0; i < image->num_levels; i++) free(image->levels[i]);
+	free(image);
+}
+
+/*
+ * Texture helpers
+ */
+bool encodeTextureBMPToBC(const char* bmp_filename, const char* filename, Uint32 flags, int format, int num_threads, double* psnr) {
+	SDL_Surface* surface;
+	MipmapChain* chain;
+	CompressedImage* image;
+	bool saved;
+
+	surface = loadSurfaceBMPEx(bmp_filename, flags & ~TEXTURE_PACKED_16);
+	if (!surface) return false;
+
+	if (flags & TEXTURE_MIPMAPS) {
+		chain = createMipmapChain(surface, (flags & TEXTURE_MIPMAP_BOX) ? MIPMAP_FILTER_BOX : MIPMAP_FILTER_KAISER, num_threads);
+		if (!chain) {
+			SDL_FreeSurface(surface);
+			return false;
+		}
+		image = compressMipmapChain(chain, format, num_threads);
+	} else {
+		chain = NULL;
+		image = compressSurface(surface, format, num_threads);
+	}
+
+	if (image && psnr) *psnr = getCompressedPSNR(image, surface);
+	saved = image && saveCompressedImage(image, filename);
+
+	freeCompressedImage(image);
+	if (chain) freeMipmapChain(chain);
+	else SDL_FreeSurface(surface);
+	return saved;
+}
+
+Texture* loadTextureBC(const char* filename) {
+	CompressedImage* image;
+	SDL_Surface* decoded;
+	Texture* texture;
+	GLenum internal_format;
+	int i;
+
+	image = loadCompressedImage(filename);
+	if (!image) return NULL;
+
+	texture = (Texture*)malloc(sizeof(Texture));
+	if (texture == NULL) {
+		freeCompressedImage(image);
+		SDL_SetError("Failed to allocate texture memory for \"%s\"", filename);
+		return NULL;
+	}
+
+	// Check once per run (requires current context)
+	if (BC_UPLOAD_SUPPORTED < 0) BC_UPLOAD_SUPPORTED = createCompressedTextureFunctions() ? 1 : 0;
+	internal_format = image->format == BC_FORMAT_BC1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+
+	glGenTextures(1, &texture->data);
+	glStateBindTexture(texture->data);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, image->num_levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, image->num_levels - 1);
+	texture->width = image->width;
+	texture->height = image->height;
+	texture->internal_format = BC_UPLOAD_SUPPORTED ? internal_format : GL_RGBA8;
+	texture->bytes = 0;
+	for (i = 0; i < image->num_levels; i++) {
+		if (BC_UPLOAD_SUPPORTED) {
+			glCompressedTexImage(GL_TEXTURE_2D, i, internal_format, image->level_width[i], image->level_height[i], 0, (GLsizei)image->level_size[i], image->levels[i]);
+			texture->bytes += image->level_size[i];
+			continue;
+		}
+
+		// No S3TC, decode on CPU
+		decoded = decompressImageLevel(image, i);
+		if (!decoded) {
+			freeTexture(texture);
+			freeCompressedImage(image);
+			SDL_SetError("Failed to decode level %d of \"%s\"", i, filename);
+			return NULL;
+		}
+		glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA8, decoded->w, decoded->h, 0, GL_RGBA, GL_UNSIGNED_BYTE, decoded->pixels);
+		texture->bytes += (size_t)decoded->w * decoded->h * 4;
+		SDL_FreeSurface(decoded);
+	}
+	texture->ready = true;
+	texture->failed = false;
+
+	freeCompressedImage(image);
+	return texture;
+}
@@ -0,0 +1,131 @@
+#pragma once
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include <stdbool.h>
+
+#include <SDL.h>
+#include <SDL_opengl.h>
+
+#include "sdl_gl.h"
+#include "texture_mipmap.h"
+
+// Block compression formats
+#define BC_FORMAT_AUTO 0 // BC1 when every pixel is opaque, else BC3
+#define BC_FORMAT_BC1  1 // 4x4 RGB in 8 bytes (GL_COMPRESSED_RGB_S3TC_DXT1_EXT)
+#define BC_FORMAT_BC3  3 // 4x4 RGBA in 16 bytes (GL_COMPRESSED_RGBA_S3TC_DXT5_EXT)
+
+typedef struct {
+	int format;
+	int width, height;
+	int num_levels;
+	int level_width[MIPMAP_MAX_LEVELS];
+	int level_height[MIPMAP_MAX_LEVELS];
+	Uint32 level_size[MIPMAP_MAX_LEVELS];
+	Uint8* levels[MIPMAP_MAX_LEVELS];
+} CompressedImage;
+
+/**
+ * Block compress every level of a mip chain
+ *
+ * Endpoints come from the principal axis of each 4x4 block, refined once
+ * by least squares; index search uses SSE2 where available. Blocks rows
+ * are split across threads.
+ *
+ * \param chain Chain of SDL_PIXELFORMAT_RGBA32 levels (see createMipmapChain())
+ * \param format BC_FORMAT_* to encode
+ * \param num_threads Worker threads (0 or less for CPU count)
+ * \returns CompressedImage or NULL on failure; call SDL_GetError() for more information.
+ *
+ * \warning User must free returned image with freeCompressedImage()
+ */
+extern CompressedImage* compressMipmapChain(const MipmapChain* chain, int format, int num_threads);
+
+/**
+ * Block compress single RGBA32 surface (one level)
+ *
+ * \sa compressMipmapChain
+ */
+extern CompressedImage* compressSurface(SDL_Surface* surface, int format, int num_threads);
+
+/**
+ * Decode one level back to RGBA32 (eg: when S3TC upload is unsupported)
+ *
+ * \param image Compressed image
+ * \param level Mip level to decode
+ * \returns SDL_Surface in SDL_PIXELFORMAT_RGBA32 or NULL on failure;
+ *          call SDL_GetError() for more information.
+ *
+ * \warning User must free returned surface with SDL_FreeSurface()
+ */
+extern SDL_Surface* decompressImageLevel(const CompressedImage* image, int level);
+
+/**
+ * Peak signal-to-noise ratio of level 0 against its source
+ *
+ * Alpha is included for BC_FORMAT_BC3.
+ *
+ * \param image Compressed image
+ * \param reference Source surface in SDL_PIXELFORMAT_RGBA32 (same size as level 0)
+ * \returns PSNR in dB (higher is better, 99.0 when identical) or negative on failure
+ */
+extern double getCompressedPSNR(const CompressedImage* image, SDL_Surface* reference);
+
+/**
+ * Write compressed image and all its levels to file
+ *
+ * \returns true on success or false on failure; call SDL_GetError() for more information.
+ */
+extern bool saveCompressedImage(const CompressedImage* image, const char* filename);
+
+/**
+ * Read compressed image written by saveCompressedImage()
+ *
+ * \returns CompressedImage or NULL on failure; call SDL_GetError() for more information.
+ *
+ * \warning User must free returned image with freeCompressedImage()
+ */
+extern CompressedImage* loadCompressedImage(const char* filename);
+
+/**
+ * Free compressed image and its level data
+ *
+ * \param image Image to free (NULL is ignored)
+ */
+extern void freeCompressedImage(CompressedImage* image);
+
+/**
+ * Encode BMP into compressed texture file (offline step)
+ *
+ * \param bmp_filename BMP file to load from
+ * \param filename Compressed file to write
+ * \param flags TEXTURE_* flags (TEXTURE_MIPMAPS stores full mip chain)
+ * \param format BC_FORMAT_* to encode
+ * \param num_threads Worker threads (0 or less for CPU count)
+ * \param psnr Receives level 0 PSNR in dB (may be NULL)
+ * \returns true on success or false on failure; call SDL_GetError() for more information.
+ *
+ * \sa loadTextureBC
+ */
+extern bool encodeTextureBMPToBC(const char* bmp_filename, const char* filename, Uint32 flags, int format, int num_threads, double* psnr);
+
+/**
+ * Loads compressed texture file for use with OpenGL texturing
+ *
+ * Uploads blocks as-is with glCompressedTexImage2D when S3TC is supported,
+ * otherwise decodes every level on CPU and uploads RGBA8.
+ *
+ * \param filename Compressed file written by saveCompressedImage()
+ * \returns Texture structure usable with OpenGL or NULL on failure;
+ *          call SDL_GetError() for more information.
+ *
+ * \warning User must free returned Texture with freeTexture() before losing scope
+ *
+ * \sa encodeTextureBMPToBC
+ */
+extern Texture* loadTextureBC(const char* filename);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,607 @@
+#include "texture_mipmap.h"
+
+#include <math.h>
+#include <string.h>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define MIPMAP_SSE
+#include <xmmintrin.h>
+#endif
+
+#define MIPMAP_MAX_THREADS 32
+#define MIPMAP_MIN_ROW_COST 16384 // Work below this per chunk runs on calling thread
+#define MIPMAP_KAISER_RADIUS 3.0f
+#define MIPMAP_KAISER_ALPHA 4.0f
+#define MIPMAP_LINEAR_TO_SRGB_SIZE 4096
+
+// Linear light, premultiplied RGBA float image
+typedef struct {
+	int w, h;
+	float* data;
+} MipmapImage;
+
+// Per output pixel taps of a 1D filter (source indices already clamped)
+typedef struct {
+	int max_taps;
+	int* counts;
+	int* indices;
+	float* weights;
+} MipmapTaps;
+
+// Rows split into chunks; pool workers and calling thread take chunks until none are left
+typedef struct MipmapRowJob {
+	TextureRowFunction run;
+	void* data;
+	int rows;
+	int count;
+	int next;                  // Next chunk to take (pool mutex)
+	int done;                  // Chunks finished (pool mutex)
+	struct MipmapRowJob* link; // Next job with chunks left
+} MipmapRowJob;
+
+float SRGB_TO_LINEAR[256];
+Uint8 LINEAR_TO_SRGB[MIPMAP_LINEAR_TO_SRGB_SIZE + 1];
+SDL_atomic_t MIPMAP_TABLES_READY;
+
+// Persistent row workers, started on first parallel job
+SDL_SpinLock MIPMAP_POOL_LOCK = 0;
+bool MIPMAP_POOL_STARTED = false;
+bool MIPMAP_POOL_QUIT = false;
+SDL_mutex* MIPMAP_POOL_MUTEX = NULL;
+SDL_cond* MIPMAP_POOL_WORK = NULL;
+SDL_cond* MIPMAP_POOL_DONE = NULL;
+SDL_Thread* MIPMAP_POOL_THREADS[MIPMAP_MAX_THREADS];
+int MIPMAP_POOL_SIZE = 0;
+MipmapRowJob* MIPMAP_POOL_JOBS = NULL;
+
+/*
+ * Color tables
+ */
+static void buildMipmapTables() {
+	float c;
+	int i;
+
+	if (SDL_AtomicGet(&MIPMAP_TABLES_READY)) return;
+
+	// Concurrent builders write identical values, so no lock needed
+	for (i = 0; i < 256; i++) {
+		c = i / 255.0f;
+		SRGB_TO_LINEAR[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+	}
+	for (i = 0; i <= MIPMAP_LINEAR_TO_SRGB_SIZE; i++) {
+		c = (float)i / MIPMAP_LINEAR_TO_SRGB_SIZE;
+		c = c <= 0.0031308f ? c * 12.92f : 1.055f * powf(c, 1.0f / 2.4f) - 0.055f;
+		LINEAR_TO_SRGB[i] = (Uint8)(c * 255.0f + 0.5f);
+	}
+	SDL_AtomicSet(&MIPMAP_TABLES_READY, 1);
+}
+
+/*
+ * Row parallelism
+ */
+// Take next chunk of job, unlinking job once every chunk is taken (pool mutex held)
+static int takeMipmapChunk(MipmapRowJob* job) {
+	MipmapRowJob** link;
+	int chunk;
+
+	if (job->next == job->count) return -1;
+	chunk = job->next++;
+	if (job->next == job->count) {
+		for (link = &MIPMAP_POOL_JOBS; *link != NULL; link = &(*link)->link) {
+			if (*link == job) {
+				*link = job->link;
+				break;
+			}
+		}
+	}
+
+	return chunk;
+}
+
+static void runMipmapChunk(MipmapRowJob* job, int chunk) {
+	job->run(job->data, (int)((Sint64)job->rows * chunk / job->count), (int)((Sint64)job->rows * (chunk + 1) / job->count));
+}
+
+static int mipmapPoolThread(void* data) {
+	MipmapRowJob* job;
+	int chunk;
+	(void)data;
+
+	SDL_LockMutex(MIPMAP_POOL_MUTEX);
+	while (true) {
+		while (!MIPMAP_POOL_QUIT && MIPMAP_POOL_JOBS == NULL) SDL_CondWait(MIPMAP_POOL_WORK, MIPMAP_POOL_MUTEX);
+		if (MIPMAP_POOL_JOBS == NULL) break;
+
+		job = MIPMAP_POOL_JOBS;
+		chunk = takeMipmapChunk(job);
+		SDL_UnlockMutex(MIPMAP_POOL_MUTEX);
+		runMipmapChunk(job, chunk);
+		SDL_LockMutex(MIPMAP_POOL_MUTEX);
+		if (++job->done == job->count) SDL_CondBroadcast(MIPMAP_POOL_DONE);
+	}
+	SDL_UnlockMutex(MIPMAP_POOL_MUTEX);
+
+	return 0;
+}
+
+static bool startMipmapPool() {
+	int size;
+	bool ready;
+
+	SDL_AtomicLock(&MIPMAP_POOL_LOCK);
+	if (!MIPMAP_POOL_STARTED) {
+		// Attempted once; failure leaves every chunk on the calling thread
+		MIPMAP_POOL_STARTED = true;
+		MIPMAP_POOL_QUIT = false;
+		MIPMAP_POOL_MUTEX = SDL_CreateMutex();
+		MIPMAP_POOL_WORK = SDL_CreateCond();
+		MIPMAP_POOL_DONE = SDL_CreateCond();
+		if (MIPMAP_POOL_MUTEX != NULL && MIPMAP_POOL_WORK != NULL && MIPMAP_POOL_DONE != NULL) {
+			// Calling thread always takes chunks too
+			size = SDL_GetCPUCount() - 1;
+			if (size > MIPMAP_MAX_THREADS - 1) size = MIPMAP_MAX_THREADS - 1;
+			while (MIPMAP_POOL_SIZE < size) {
+				MIPMAP_POOL_THREADS[MIPMAP_POOL_SIZE] = SDL_CreateThread(mipmapPoolThread, "mipmap", NULL);
+				if (MIPMAP_POOL_THREADS[MIPMAP_POOL_SIZE] == NULL) break;
+				MIPMAP_POOL_SIZE++;
+			}
+		}
+	}
+	ready = MIPMAP_POOL_SIZE > 0;
+	SDL_AtomicUnlock(&MIPMAP_POOL_LOCK);
+
+	return ready;
+}
+
+void quitTextureRowThreads() {
+	int i;
+
+	SDL_AtomicLock(&MIPMAP_POOL_LOCK);
+	if (MIPMAP_POOL_STARTED) {
+		if (MIPMAP_POOL_MUTEX != NULL) {
+			SDL_LockMutex(MIPMAP_POOL_MUTEX);
+			MIPMAP_POOL_QUIT = true;
+			if (MIPMAP_POOL_WORK != NULL) SDL_CondBroadcast(MIPMAP_POOL_WORK);
+			SDL_UnlockMutex(MIPMAP_POOL_MUTEX);
+		}
+		for (i = 0; i < MIPMAP_POOL_SIZE; i++) SDL_WaitThread(MIPMAP_POOL_THREADS[i], NULL);
+		if (MIPMAP_POOL_DONE != NULL) SDL_DestroyCond(MIPMAP_POOL_DONE);
+		if (MIPMAP_POOL_WORK != NULL) SDL_DestroyCond(MIPMAP_POOL_WORK);
+		if (MIPMAP_POOL_MUTEX != NULL) SDL_DestroyMutex(MIPMAP_POOL_MUTEX);
+		MIPMAP_POOL_DONE = NULL;
+		MIPMAP_POOL_WORK = NULL;
+		MIPMAP_POOL_MUTEX = NULL;
+		MIPMAP_POOL_SIZE = 0;
+		MIPMAP_POOL_STARTED = false;
+	}
+	SDL_AtomicUnlock(&MIPMAP_POOL_LOCK);
+}
+
+void runTextureRows(TextureRowFunction run, void* data, int rows, int row_cost, int num_threads) {
+	MipmapRowJob job;
+	int count;
+	int chunk;
+
+	if (num_threads <= 0) num_threads = SDL_GetCPUCount();
+	if (num_threads > MIPMAP_MAX_THREADS) num_threads = MIPMAP_MAX_THREADS;
+	count = (int)(((Sint64)rows * row_cost) / MIPMAP_MIN_ROW_COST);
+	if (count > num_threads) count = num_threads;
+	if (count > rows) count = rows;
+
+	// Small jobs (eg: low mip levels) are not worth waking workers
+	if (count <= 1 || !startMipmapPool()) {
+		if (rows > 0) run(data, 0, rows);
+		return;
+	}
+
+	job.run = run;
+	job.data = data;
+	job.rows = rows;
+	job.count = count;
+	job.next = 0;
+	job.done = 0;
+
+	SDL_LockMutex(MIPMAP_POOL_MUTEX);
+	job.link = MIPMAP_POOL_JOBS;
+	MIPMAP_POOL_JOBS = &job;
+	SDL_CondBroadcast(MIPMAP_POOL_WORK);
+
+	// Take chunks alongside workers, then wait for chunks they took
+	while ((chunk = takeMipmapChunk(&job)) >= 0) {
+		SDL_UnlockMutex(MIPMAP_POOL_MUTEX);
+		runMipmapChunk(&job, chunk);
+		SDL_LockMutex(MIPMAP_POOL_MUTEX);
+		job.done++;
+	}
+	while (job.done < job.count) SDL_CondWait(MIPMAP_POOL_DONE, MIPMAP_POOL_MUTEX);
+	SDL_UnlockMutex(MIPMAP_POOL_MUTEX);
+}
+
+/*
+ * Filter kernels
+ */
+static float besselI0(float x) {
+	float sum = 1.0f, term = 1.0f, y = x * x * 0.25f;
+	int k;
+
+	for (k = 1; k < 32 && term > sum * 1e-7f; k++) {
+		term *= y / (float)(k * k);
+		sum += term;
+	}
+	return sum;
+}
+
+static float mipmapFilterRadius(int filter) {
+	return filter == MIPMAP_FILTER_KAISER ? MIPMAP_KAISER_RADIUS : 0.5f;
+}
+
+static float mipmapFilterWeight(int filter, float x) {
+	float t, sinc;
+
+	if (filter != MIPMAP_FILTER_KAISER) return fabsf(x) <= 0.5f ? 1.0f : 0.0f;
+
+	t = x / MIPMAP_KAISER_RADIUS;
+	if (t <= -1.0f || t >= 1.0f) return 0.0f;
+	sinc = x == 0.0f ? 1.0f : sinf(3.1415926537f * x) / (3.1415926537f * x);
+	return sinc * besselI0(MIPMAP_KAISER_ALPHA * sqrtf(1.0f - t * t)) / besselI0(MIPMAP_KAISER_ALPHA);
+}
+
+static void freeMipmapTaps(MipmapTaps* taps) {
+	free(taps->counts);
+	free(taps->indices);
+	free(taps->weights);
+}
+
+static bool buildMipmapTaps(MipmapTaps* taps, int in_size, int out_size, int filter) {
+	float ratio, scale, support, center, sum, weight;
+	int i, j, left, right, n;
+
+	// Widen kernel when minifying so every source pixel contributes
+	ratio = (float)in_size / out_size;
+	scale = ratio > 1.0f ? ratio : 1.0f;
+	support = mipmapFilterRadius(filter) * scale;
+
+	taps->max_taps = (int)ceilf(support * 2.0f) + 1;
+	taps->counts = (int*)malloc(sizeof(int) * out_size);
+	taps->indices = (int*)malloc(sizeof(int) * out_size * taps->max_taps);
+	taps->weights = (float*)malloc(sizeof(float) * out_size * taps->max_taps);
+	if (!taps->counts || !taps->indices || !taps->weights) {
+		freeMipmapTaps(taps);
+		return false;
+	}
+
+	for (i = 0; i < out_size; i++) {
+		center = (i + 0.5f) * ratio - 0.5f;
+		left = (int)ceilf(center - support);
+		right = (int)floorf(center + support);
+		n = 0;
+		sum = 0.0f;
+		for (j = left; j <= right && n < taps->max_taps; j++) {
+			weight = mipmapFilterWeight(filter, (j - center) / scale);
+			if (weight == 0.0f) continue;
+			taps->indices[i * taps->max_taps + n] = j < 0 ? 0 : j >= in_size ? in_size - 1 : j;
+			taps->weights[i * taps->max_taps + n] = weight;
+			sum += weight;
+			n++;
+		}
+		// Degenerate kernel (eg: box on exact pixel edges), use nearest
+		if (n == 0 || sum == 0.0f) {
+			j = (int)floorf(center + 0.5f);
+			taps->indices[i * taps->max_taps] = j < 0 ? 0 : j >= in_size ? in_size - 1 : j;
+			taps->weights[i * taps->max_taps] = 1.0f;
+			n = 1;
+			sum = 1.0f;
+		}
+		for (j = 0; j < n; j++) taps->weights[i * taps->max_taps + j] /= sum;
+		taps->counts[i] = n;
+	}
+	return true;
+}
+
+/*
+ * Image conversion (8-bit sRGB <-> linear premultiplied float)
+ */
+typedef struct {
+	SDL_Surface* surface;
+	MipmapImage* image;
+} MipmapConvertJob;
+
+static void decodeMipmapRows(void* data, int y_begin, int y_end) {
+	MipmapConvertJob* job = (MipmapConvertJob*)data;
+	const Uint8* src;
+	float* dst;
+	float a;
+	int x, y;
+
+	for (y = y_begin; y < y_end; y++) {
+		src = (const Uint8*)job->surface->pixels + (size_t)y * job->surface->pitch;
+		dst = job->image->data + (size_t)y * job->image->w * 4;
+		for (x = 0; x < job->image->w; x++) {
+			a = src[x * 4 + 3] / 255.0f;
+			dst[x * 4 + 0] = SRGB_TO_LINEAR[src[x * 4 + 0]] * a;
+			dst[x * 4 + 1] = SRGB_TO_LINEAR[src[x * 4 + 1]] * a;
+			dst[x * 4 + 2] = SRGB_TO_LINEAR[src[x * 4 + 2]] * a;
+			dst[x * 4 + 3] = a;
+		}
+	}
+}
+
+static Uint8 encodeMipmapChannel(float linear) {
+	if (linear <= 0.0f) return 0;
+	if (linear >= 1.0f) return 255;
+	return LINEAR_TO_SRGB[(int)(linear * MIPMAP_LINEAR_TO_SRGB_SIZE + 0.5f)];
+}
+
+static void encodeMipmapRows(void* data, int y_begin, int y_end) {
+	MipmapConvertJob* job = (MipmapConvertJob*)data;
+	const float* src;
+	Uint8* dst;
+	float a, inv;
+	int x, y;
+
+	for (y = y_begin; y < y_end; y++) {
+		src = job->image->data + (size_t)y * job->image->w * 4;
+		dst = (Uint8*)job->surface->pixels + (size_t)y * job->surface->pitch;
+		for (x = 0; x < job->image->w; x++) {
+			// Kaiser lobes can overshoot, clamp before un-premultiplying
+			a = src[x * 4 + 3];
+			a = a < 0.0f ? 0.0f : a > 1.0f ? 1.0f : a;
+			inv = a > 0.0f ? 1.0f / a : 0.0f;
+			dst[x * 4 + 0] = encodeMipmapChannel(src[x * 4 + 0] * inv);
+			dst[x * 4 + 1] = encodeMipmapChannel(src[x * 4 + 1] * inv);
+			dst[x * 4 + 2] = encodeMipmapChannel(src[x * 4 + 2] * inv);
+			dst[x * 4 + 3] = (Uint8)(a * 255.0f + 0.5f);
+		}
+	}
+}
+
+static bool createMipmapImage(MipmapImage* image, int w, int h) {
+	image->w = w;
+	image->h = h;
+	image->data = (float*)malloc(sizeof(float) * 4 * w * h);
+	return image->data != NULL;
+}
+
+static bool decodeMipmapImage(SDL_Surface* surface, MipmapImage* image, int num_threads) {
+	MipmapConvertJob job;
+
+	if (!createMipmapImage(image, surface->w, surface->h)) return false;
+	job.surface = surface;
+	job.image = image;
+	runTextureRows(decodeMipmapRows, &job, image->h, image->w, num_threads);
+	return true;
+}
+
+static SDL_Surface* encodeMipmapImage(MipmapImage* image, int num_threads) {
+	MipmapConvertJob job;
+
+	job.surface = SDL_CreateRGBSurfaceWithFormat(0, image->w, image->h, 32, SDL_PIXELFORMAT_RGBA32);
+	if (!job.surface) return NULL;
+	job.image = image;
+	runTextureRows(encodeMipmapRows, &job, image->h, image->w, num_threads);
+	return job.surface;
+}
+
+/*
+ * Separable resampling (horizontal pass, then vertical pass)
+ */
+typedef struct {
+	const MipmapImage* src;
+	MipmapImage* dst;
+	const MipmapTaps* taps;
+} MipmapResampleJob;
+
+static void resampleMipmapRowsH(void* data, int y_begin, int y_end) {
+	MipmapResampleJob* job = (MipmapResampleJob*)data;
+	const MipmapTaps* taps = job->taps;
+	const float* src;
+	const int* indices;
+	const float* weights;
+	float* dst;
+	int x, y, t;
+#ifdef MIPMAP_SSE
+	__m128 acc;
+#else
+	float acc[4];
+#endif
+
+	for (y = y_begin; y < y_end; y++) {
+		src = job->src->data + (size_t)y * job->src->w * 4;
+		dst = job->dst->data + (size_t)y * job->dst->w * 4;
+		for (x = 0; x < job->dst->w; x++) {
+			indices = taps->indices + x * taps->max_taps;
+			weights = taps->weights + x * taps->max_taps;
+#ifdef MIPMAP_SSE
+			// One RGBA pixel per SSE register
+			acc = _mm_setzero_ps();
+			for (t = 0; t < taps->counts[x]; t++) {
+				acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(src + indices[t] * 4), _mm_set1_ps(weights[t])));
+			}
+			_mm_storeu_ps(dst + x * 4, acc);
+#else
+			acc[0] = acc[1] = acc[2] = acc[3] = 0.0f;
+			for (t = 0; t < taps->counts[x]; t++) {
+				acc[0] += src[indices[t] * 4 + 0] * weights[t];
+				acc[1] += src[indices[t] * 4 + 1] * weights[t];
+				acc[2] += src[indices[t] * 4 + 2] * weights[t];
+				acc[3] += src[indices[t] * 4 + 3] * weights[t];
+			}
+			memcpy(dst + x * 4, acc, sizeof(acc));
+#endif
+		}
+	}
+}
+
+static void resampleMipmapRowsV(void* data, int y_begin, int y_end) {
+	MipmapResampleJob* job = (MipmapResampleJob*)data;
+	const MipmapTaps* taps = job->taps;
+	const float* src;
+	float* dst;
+	float weight;
+	int y, t, i, n;
+#ifdef MIPMAP_SSE
+	__m128 w;
+#endif
+
+	n = job->dst->w * 4;
+	for (y = y_begin; y < y_end; y++) {
+		dst = job->dst->data + (size_t)y * n;
+		memset(dst, 0, sizeof(float) * n);
+		for (t = 0; t < taps->counts[y]; t++) {
+			src = job->src->data + (size_t)taps->indices[y * taps->max_taps + t] * n;
+			weight = taps->weights[y * taps->max_taps + t];
+			i = 0;
+#ifdef MIPMAP_SSE
+			// Whole row is a multiple of 4 floats (RGBA)
+			w = _mm_set1_ps(weight);
+			for (; i < n; i += 4) {
+				_mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), w)));
+			}
+#endif
+			for (; i < n; i++) dst[i] += src[i] * weight;
+		}
+	}
+}
+
+static bool resampleMipmapImage(const MipmapImage* src, MipmapImage* dst, int w, int h, int filter, int num_threads) {
+	MipmapResampleJob job;
+	MipmapImage temp;
+	MipmapTaps taps;
+
+	if (!createMipmapImage(&temp, w, src->h)) return false;
+	if (!createMipmapImage(dst, w, h)) {
+		free(temp.data);
+		return false;
+	}
+
+	// Horizontal: src -> temp (rows independent)
+	if (!buildMipmapTaps(&taps, src->w, w, filter)) goto fail;
+	job.src = src;
+	job.dst = &temp;
+	job.taps = &taps;
+	runTextureRows(resampleMipmapRowsH, &job, temp.h, temp.w * taps.max_taps, num_threads);
+	freeMipmapTaps(&taps);
+
+	// Vertical: temp -> dst (output rows independent)
+	if (!buildMipmapTaps(&taps, src->h, h, filter)) goto fail;
+	job.src = &temp;
+	job.dst = dst;
+	job.taps = &taps;
+	runTextureRows(resampleMipmapRowsV, &job, dst->h, dst->w * taps.max_taps, num_threads);
+	freeMipmapTaps(&taps);
+
+	free(temp.data);
+	return true;
+
+fail:
+	free(temp.data);
+	free(dst->data);
+	dst->data = NULL;
+	return false;
+}
+
+/*
+ * Public API
+ */
+SDL_Surface* resampleSurface(SDL_Surface* src, int width, int height, int filter, int num_threads) {
+	MipmapImage in, out;
+	SDL_Surface* result;
+
+	if (src->format->format != SDL_PIXELFORMAT_RGBA32 || width < 1 || height < 1) {
+		SDL_SetError("Resample requires SDL_PIXELFORMAT_RGBA32 source and positive size");
+		return NULL;
+	}
+	buildMipmapTables();
+
+	if (!decodeMipmapImage(src, &in, num_threads)) {
+		SDL_SetError("Failed to allocate resample memory for %dx%d image", src->w, src->h);
+		return NULL;
+	}
+	if (!resampleMipmapImage(&in, &out, width, height, filter, num_threads)) {
+		free(in.data);
+		SDL_SetError("Failed to allocate resample memory for %dx%d image", width, height);
+		return NULL;
+	}
+	free(in.data);
+
+	result = encodeMipmapImage(&out, num_threads);
+	free(out.data);
+	return result;
+}
+
+MipmapChain* createMipmapChain(SDL_Surface* base, int filter, int num_threads) {
+	MipmapChain* chain;
+	MipmapImage prev, next;
+	bool failed = false;
+	int w, h;
+
+	if (base->format->format != SDL_PIXELFORMAT_RGBA32) {
+		SDL_SetError("Mipmap chain requires SDL_PIXELFORMAT_RGBA32 base");
+		return NULL;
+	}
+	buildMipmapTables();
+
+	chain = (MipmapChain*)calloc(1, sizeof(MipmapChain));
+	if (!chain) {
+		SDL_SetError("Failed to allocate mipmap chain");
+		return NULL;
+	}
+	if (!decodeMipmapImage(base, &prev, num_threads)) {
+		free(chain);
+		SDL_SetError("Failed to allocate mipmap memory for %dx%d image", base->w, base->h);
+		return NULL;
+	}
+	chain->levels[0] = base;
+	chain->num_levels = 1;
+
+	// Halve (rounding down, minimum 1) until 1x1
+	w = base->w;
+	h = base->h;
+	while ((w > 1 || h > 1) && chain->num_levels < MIPMAP_MAX_LEVELS) {
+		w = w > 1 ? w / 2 : 1;
+		h = h > 1 ? h / 2 : 1;
+		if (!resampleMipmapImage(&prev, &next, w, h, filter, num_threads)) {
+			failed = true;
+			break;
+		}
+		free(prev.data);
+		prev = next;
+
+		chain->levels[chain->num_levels] = encodeMipmapImage(&prev, num_threads);
+		if (!chain->levels[chain->num_levels]) {
+			failed = true;
+			break;
+		}
+		chain->num_levels++;
+	}
+	free(prev.data);
+
+	if (failed) {
+		// Ownership of base stays with caller on failure
+		chain->levels[0] = NULL;
+		freeMipmapChain(chain);
+		SDL_SetError("Failed to allocate mipmap level %dx%d", w, h);
+		return NULL;
+	}
+	return chain;
+}
+
+void uploadMipmapChain(const MipmapChain* chain) {
+	int i;
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, chain->num_levels - 1);
+	for (i = 0; i < chain->num_levels; i++) {
+		glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA8, chain->levels[i]->w, chain->levels[i]->h, 0, GL_RGBA, GL_UNSIGNED_BYTE, chain->levels[i]->pixels);
+	}
+}
+
+void freeMipmapChain(MipmapChain* chain) {
+	int i;
+
+	if (!chain) return;
+	for (i = 0; i < chain->num_levels; i++) {
+		if (chain->levels[i]) SDL_FreeSurface(chain->levels[i]);
+	}
+	free(chain);
+}
@@ -0,0 +1,102 @@
+#pragma once
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include <stdbool.h>
+
+#include <SDL.h>
+#include <SDL_opengl.h>
+
+#define MIPMAP_MAX_LEVELS 16
+
+// Resampling filters
+#define MIPMAP_FILTER_BOX    0 // Area average (exact 2x2 average for halving)
+#define MIPMAP_FILTER_KAISER 1 // Kaiser windowed sinc, sharper minification
+
+// Work callback for runTextureRows(), processes rows [row_begin, row_end)
+typedef void (*TextureRowFunction)(void* data, int row_begin, int row_end);
+
+typedef struct {
+	int num_levels;
+	SDL_Surface* levels[MIPMAP_MAX_LEVELS];
+} MipmapChain;
+
+/**
+ * Run row callback split across threads (calling thread takes chunks too)
+ *
+ * Chunks run on a persistent worker pool started by the first parallel
+ * call and shared by every caller. Small jobs (eg: low mip levels) split
+ * into fewer chunks or run inline, since waking workers outweighs the work.
+ *
+ * \param run Callback processing a range of rows
+ * \param data Passed to run
+ * \param rows Total rows
+ * \param row_cost Approximate work per row (eg: pixels)
+ * \param num_threads Maximum threads (0 or less for CPU count)
+ */
+extern void runTextureRows(TextureRowFunction run, void* data, int rows, int row_cost, int num_threads);
+
+/**
+ * Stop row worker pool (call at shutdown, once no thread is filtering textures)
+ *
+ * \sa runTextureRows
+ */
+extern void quitTextureRowThreads();
+
+/**
+ * Resample RGBA32 surface to a new size
+ *
+ * Filtering runs in linear light (sRGB decoded) on premultiplied alpha,
+ * split across threads by rows.
+ *
+ * \param src Source surface in SDL_PIXELFORMAT_RGBA32
+ * \param width Output width
+ * \param height Output height
+ * \param filter MIPMAP_FILTER_* to use
+ * \param num_threads Worker threads (0 or less for CPU count)
+ * \returns SDL_Surface in SDL_PIXELFORMAT_RGBA32 or NULL on failure;
+ *          call SDL_GetError() for more information.
+ *
+ * \warning User must free returned surface with SDL_FreeSurface()
+ */
+extern SDL_Surface* resampleSurface(SDL_Surface* src, int width, int height, int filter, int num_threads);
+
+/**
+ * Build full mip chain down to 1x1 from RGBA32 surface
+ *
+ * Each level is filtered from the previous one in linear light
+ * (not re-decoded from 8-bit), split across threads by rows.
+ *
+ * \param base Level 0 surface in SDL_PIXELFORMAT_RGBA32
+ *             (chain takes ownership on success)
+ * \param filter MIPMAP_FILTER_* to use
+ * \param num_threads Worker threads (0 or less for CPU count)
+ * \returns MipmapChain or NULL on failure; call SDL_GetError() for more information.
+ *
+ * \warning User must free returned chain with freeMipmapChain()
+ *
+ * \sa uploadMipmapChain
+ */
+extern MipmapChain* createMipmapChain(SDL_Surface* base, int filter, int num_threads);
+
+/**
+ * Upload every level of chain to currently bound GL_TEXTURE_2D
+ *
+ * Sets GL_TEXTURE_BASE_LEVEL/GL_TEXTURE_MAX_LEVEL so the texture is
+ * mipmap complete, min filter is left to caller.
+ *
+ * \param chain Chain to upload
+ */
+extern void uploadMipmapChain(const MipmapChain* chain);
+
+/**
+ * Free chain and all its level surfaces (including level 0)
+ *
+ * \param chain Chain to free (NULL is ignored)
+ */
+extern void freeMipmapChain(MipmapChain* chain);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,287 @@
+#include "texture_registry.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "gl_state.h"
+#include "texture_bc.h"
+
+#define TEXTURE_REGISTRY_INDEX_BITS 20
+#define TEXTURE_REGISTRY_INDEX_MASK ((1u << TEXTURE_REGISTRY_INDEX_BITS) - 1)
+#define TEXTURE_REGISTRY_MAX_ENTRIES ((int)TEXTURE_REGISTRY_INDEX_MASK - 1)
+#define TEXTURE_REGISTRY_GENERATION_MASK 0xFFF
+
+#define TEXTURE_SOURCE_BMP 0
+#define TEXTURE_SOURCE_BC 1
+
+typedef struct {
+	bool alive;
+	Uint32 generation;
+	char* filename;
+	Uint32 flags;
+	int source;
+	Texture* texture; // NULL while evicted
+	size_t bytes;
+	Uint32 last_used;
+	int prev, next;   // LRU list of resident entries (head is most recent)
+	int next_free;
+} TextureRegistryEntry;
+
+TextureRegistryEntry* TEXTURE_REGISTRY = NULL;
+int TEXTURE_REGISTRY_CAPACITY = 0;
+int TEXTURE_REGISTRY_FREE = -1;
+int TEXTURE_REGISTRY_LRU_HEAD = -1;
+int TEXTURE_REGISTRY_LRU_TAIL = -1;
+TextureRegistryStats TEXTURE_REGISTRY_STATS;
+
+/*
+ * LRU list
+ */
+static void unlinkTextureLRU(int index) {
+	TextureRegistryEntry* entry = &TEXTURE_REGISTRY[index];
+
+	if (entry->prev >= 0) TEXTURE_REGISTRY[entry->prev].next = entry->next;
+	else TEXTURE_REGISTRY_LRU_HEAD = entry->next;
+	if (entry->next >= 0) TEXTURE_REGISTRY[entry->next].prev = entry->prev;
+	else TEXTURE_REGISTRY_LRU_TAIL = entry->prev;
+	entry->prev = entry->next = -1;
+}
+
+static void pushTextureLRU(int index) {
+	TextureRegistryEntry* entry = &TEXTURE_REGISTRY[index];
+
+	entry->prev = -1;
+	entry->next = TEXTURE_REGISTRY_LRU_HEAD;
+	if (TEXTURE_REGISTRY_LRU_HEAD >= 0) TEXTURE_REGISTRY[TEXTURE_REGISTRY_LRU_HEAD].prev = index;
+	else TEXTURE_REGISTRY_LRU_TAIL = index;
+	TEXTURE_REGISTRY_LRU_HEAD = index;
+}
+
+/*
+ * Residency
+ */
+static void evictTextureEntry(int index) {
+	TextureRegistryEntry* entry = &TEXTURE_REGISTRY[index];
+
+	unlinkTextureLRU(index);
+	freeTexture(entry->texture);
+	entry->texture = NULL;
+	TEXTURE_REGISTRY_STATS.resident_bytes -= entry->bytes;
+	TEXTURE_REGISTRY_STATS.resident--;
+}
+
+// Evict least recently used until in budget, never evicting keep or textures bound this frame
+static void enforceTextureBudget(int keep) {
+	int index, prev;
+
+	index = TEXTURE_REGISTRY_LRU_TAIL;
+	while (index >= 0 &&
+		TEXTURE_REGISTRY_STATS.budget_bytes > 0 &&
+		TEXTURE_REGISTRY_STATS.resident_bytes > TEXTURE_REGISTRY_STATS.budget_bytes) {
+		prev = TEXTURE_REGISTRY[index].prev;
+		if (index != keep && TEXTURE_REGISTRY[index].last_used != TEXTURE_REGISTRY_STATS.frame) {
+			evictTextureEntry(index);
+			TEXTURE_REGISTRY_STATS.evictions++;
+		}
+		index = prev;
+	}
+}
+
+static bool loadTextureEntry(int index) {
+	TextureRegistryEntry* entry = &TEXTURE_REGISTRY[index];
+
+	if (entry->source == TEXTURE_SOURCE_BC) entry->texture = loadTextureBC(entry->filename);
+	else entry->texture = loadTextureBMPEx(entry->filename, entry->flags);
+	if (!entry->texture) return false;
+
+	entry->bytes = entry->texture->bytes;
+	pushTextureLRU(index);
+	TEXTURE_REGISTRY_STATS.resident_bytes += entry->bytes;
+	TEXTURE_REGISTRY_STATS.resident++;
+	return true;
+}
+
+static int findTextureEntry(TextureHandle handle) {
+	int index;
+
+	index = (int)(handle & TEXTURE_REGISTRY_INDEX_MASK) - 1;
+	if (index < 0 || index >= TEXTURE_REGISTRY_CAPACITY) return -1;
+	if (!TEXTURE_REGISTRY[index].alive || TEXTURE_REGISTRY[index].generation != (handle >> TEXTURE_REGISTRY_INDEX_BITS)) return -1;
+	return index;
+}
+
+static TextureHandle registerTextureFile(const char* filename, Uint32 flags, int source) {
+	TextureRegistryEntry* entry;
+	TextureRegistryEntry* grown;
+	int index, capacity, i;
+	size_t filename_len;
+
+	if (!TEXTURE_REGISTRY) {
+		SDL_SetError("Failed to register \"%s\": texture registry not initialized", filename);
+		return 0;
+	}
+
+	// Reuse freed slot or grow table (indices stay stable, LRU links are indices)
+	if (TEXTURE_REGISTRY_FREE < 0) {
+		if (TEXTURE_REGISTRY_CAPACITY >= TEXTURE_REGISTRY_MAX_ENTRIES) {
+			SDL_SetError("Failed to register \"%s\": texture registry full", filename);
+			return 0;
+		}
+		capacity = TEXTURE_REGISTRY_CAPACITY * 2;
+		if (capacity > TEXTURE_REGISTRY_MAX_ENTRIES) capacity = TEXTURE_REGISTRY_MAX_ENTRIES;
+		grown = (TextureRegistryEntry*)realloc(TEXTURE_REGISTRY, sizeof(TextureRegistryEntry) * capacity);
+		if (!grown) {
+			SDL_SetError("Failed to grow texture registry for \"%s\"", filename);
+			return 0;
+		}
+		TEXTURE_REGISTRY = grown;
+		for (i = capacity - 1; i >= TEXTURE_REGISTRY_CAPACITY; i--) {
+			memset(&TEXTURE_REGISTRY[i], 0, sizeof(TextureRegistryEntry));
+			TEXTURE_REGISTRY[i].next_free = TEXTURE_REGISTRY_FREE;
+			TEXTURE_REGISTRY_FREE = i;
+		}
+		TEXTURE_REGISTRY_CAPACITY = capacity;
+	}
+	index = TEXTURE_REGISTRY_FREE;
+	entry = &TEXTURE_REGISTRY[index];
+
+	filename_len = strlen(filename);
+	entry->filename = (char*)malloc(sizeof(char) * (filename_len + 1));
+	if (!entry->filename) {
+		SDL_SetError("Failed to allocate texture registry memory for \"%s\"", filename);
+		return 0;
+	}
+	memcpy(entry->filename, filename, filename_len + 1);
+	entry->flags = flags;
+	entry->source = source;
+	entry->last_used = TEXTURE_REGISTRY_STATS.frame - 1; // Not bound yet, so evictable this frame
+	entry->prev = entry->next = -1;
+	if (!loadTextureEntry(index)) {
+		free(entry->filename);
+		entry->filename = NULL;
+		return 0;
+	}
+
+	TEXTURE_REGISTRY_FREE = entry->next_free;
+	entry->alive = true;
+	TEXTURE_REGISTRY_STATS.registered++;
+	enforceTextureBudget(index);
+
+	return (entry->generation << TEXTURE_REGISTRY_INDEX_BITS) | (Uint32)(index + 1);
+}
+
+/*
+ * Public API
+ */
+bool initTextureRegistry(size_t budget_bytes) {
+	int i;
+
+	if (TEXTURE_REGISTRY) quitTextureRegistry();
+
+	TEXTURE_REGISTRY = (TextureRegistryEntry*)calloc(64, sizeof(TextureRegistryEntry));
+	if (!TEXTURE_REGISTRY) {
+		SDL_SetError("Failed to allocate texture registry");
+		return false;
+	}
+	TEXTURE_REGISTRY_CAPACITY = 64;
+	TEXTURE_REGISTRY_FREE = -1;
+	for (i = TEXTURE_REGISTRY_CAPACITY - 1; i >= 0; i--) {
+		TEXTURE_REGISTRY[i].next_free = TEXTURE_REGISTRY_FREE;
+		TEXTURE_REGISTRY_FREE = i;
+	}
+	TEXTURE_REGISTRY_LRU_HEAD = TEXTURE_REGISTRY_LRU_TAIL = -1;
+	memset(&TEXTURE_REGISTRY_STATS, 0, sizeof(TEXTURE_REGISTRY_STATS));
+	TEXTURE_REGISTRY_STATS.budget_bytes = budget_bytes;
+
+	return true;
+}
+
+void setTextureRegistryBudget(size_t budget_bytes) {
+	TEXTURE_REGISTRY_STATS.budget_bytes = budget_bytes;
+	if (TEXTURE_REGISTRY) enforceTextureBudget(-1);
+}
+
+TextureHandle registerTextureBMP(const char* filename, Uint32 flags) {
+	return registerTextureFile(filename, flags, TEXTURE_SOURCE_BMP);
+}
+
+TextureHandle registerTextureBC(const char* filename) {
+	return registerTextureFile(filename, 0, TEXTURE_SOURCE_BC);
+}
+
+Texture* bindTextureHandle(TextureHandle handle) {
+	TextureRegistryEntry* entry;
+	int index;
+
+	index = findTextureEntry(handle);
+	if (index < 0) {
+		glStateBindTexture(0);
+		return NULL;
+	}
+	entry = &TEXTURE_REGISTRY[index];
+
+	// Transparently bring evicted texture back
+	if (!entry->texture) {
+		if (!loadTextureEntry(index)) {
+			TEXTURE_REGISTRY_STATS.failed_reloads++;
+			printf("[WARN] Texture reload failed: %s\n", SDL_GetError());
+			glStateBindTexture(0);
+			return NULL;
+		}
+		TEXTURE_REGISTRY_STATS.reloads++;
+		enforceTextureBudget(index);
+	} else if (TEXTURE_REGISTRY_LRU_HEAD != index) {
+		unlinkTextureLRU(index);
+		pushTextureLRU(index);
+	}
+	entry->last_used = TEXTURE_REGISTRY_STATS.frame;
+
+	glStateBindTexture(entry->texture->data);
+	return entry->texture;
+}
+
+void unregisterTexture(TextureHandle handle) {
+	TextureRegistryEntry* entry;
+	int index;
+
+	index = findTextureEntry(handle);
+	if (index < 0) return;
+	entry = &TEXTURE_REGISTRY[index];
+
+	if (entry->texture) evictTextureEntry(index);
+	free(entry->filename);
+	entry->filename = NULL;
+	entry->alive = false;
+	entry->generation = (entry->generation + 1) & TEXTURE_REGISTRY_GENERATION_MASK;
+	entry->next_free = TEXTURE_REGISTRY_FREE;
+	TEXTURE_REGISTRY_FREE = index;
+	TEXTURE_REGISTRY_STATS.registered--;
+}
+
+void advanceTextureRegistryFrame() {
+	TEXTURE_REGISTRY_STATS.frame++;
+
+	// Textures kept over budget for the previous frame are evictable again
+	if (TEXTURE_REGISTRY) enforceTextureBudget(-1);
+}
+
+TextureRegistryStats getTextureRegistryStats() {
+	return TEXTURE_REGISTRY_STATS;
+}
+
+void quitTextureRegistry() {
+	int i;
+
+	for (i = 0; i < TEXTURE_REGISTRY_CAPACITY; i++) {
+		if (TEXTURE_REGISTRY[i].texture) freeTexture(TEXTURE_REGISTRY[i].texture);
+		free(TEXTURE_REGISTRY[i].filename);
+	}
+	free(TEXTURE_REGISTRY);
+	TEXTURE_REGISTRY = NULL;
+	TEXTURE_REGISTRY_CAPACITY = 0;
+	TEXTURE_REGISTRY_FREE = -1;
+	TEXTURE_REGISTRY_LRU_HEAD = TEXTURE_REGISTRY_LRU_TAIL = -1;
+	TEXTURE_REGISTRY_STATS.resident_bytes = 0;
+	TEXTURE_REGISTRY_STATS.resident = 0;
+	TEXTURE_REGISTRY_STATS.registered = 0;
+}
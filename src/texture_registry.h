@@ -0,0 +1,117 @@
+#pragma once
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include <stdbool.h>
+
+#include <SDL.h>
+#include <SDL_opengl.h>
+
+#include "sdl_gl.h"
+
+// Handle to registered texture (0 is never a valid handle)
+typedef Uint32 TextureHandle;
+
+typedef struct {
+	size_t budget_bytes;
+	size_t resident_bytes;
+	int registered;     // Handles alive
+	int resident;       // Handles with GL texture loaded
+	Uint32 evictions;   // Textures freed to stay in budget
+	Uint32 reloads;     // Evicted textures loaded again on bind
+	Uint32 failed_reloads;
+	Uint32 frame;
+} TextureRegistryStats;
+
+/**
+ * Start texture registry with a GPU memory budget
+ *
+ * \param budget_bytes Resident texture bytes allowed (0 for unlimited)
+ * \returns true on success or false on failure; call SDL_GetError() for more information.
+ *
+ * \sa registerTextureBMP
+ * \sa quitTextureRegistry
+ */
+extern bool initTextureRegistry(size_t budget_bytes);
+
+/**
+ * Change memory budget, evicting least recently used textures if now over it
+ *
+ * \param budget_bytes Resident texture bytes allowed (0 for unlimited)
+ */
+extern void setTextureRegistryBudget(size_t budget_bytes);
+
+/**
+ * Load BMP and register it for residency management
+ *
+ * Texture is loaded immediately (so bad files fail here), but may later be
+ * evicted and reloaded from filename with the same flags.
+ *
+ * \param filename BMP file to load from (kept for reloads)
+ * \param flags TEXTURE_* flags (see loadTextureBMPEx())
+ * \returns TextureHandle or 0 on failure; call SDL_GetError() for more information.
+ *
+ * \sa bindTextureHandle
+ * \sa unregisterTexture
+ */
+extern TextureHandle registerTextureBMP(const char* filename, Uint32 flags);
+
+/**
+ * Load block compressed texture and register it for residency management
+ *
+ * \param filename Compressed file written by saveCompressedImage() (kept for reloads)
+ * \returns TextureHandle or 0 on failure; call SDL_GetError() for more information.
+ *
+ * \sa loadTextureBC
+ */
+extern TextureHandle registerTextureBC(const char* filename);
+
+/**
+ * Bind texture on active unit (via gl_state), reloading it if evicted
+ *
+ * Marks texture as most recently used in current frame. Reloading may
+ * evict other textures to stay in budget; textures bound in the current
+ * frame are never evicted, so a frame may briefly exceed the budget.
+ *
+ * \param handle Handle from registerTexture*()
+ * \returns Bound Texture or NULL if handle is stale or reload failed
+ *          (texture 0 is bound instead)
+ *
+ * \warning Returned Texture (and its GL name) is only valid until a later
+ *          registry call evicts it; keep the handle, not the Texture.
+ */
+extern Texture* bindTextureHandle(TextureHandle handle);
+
+/**
+ * Free texture and forget its handle
+ *
+ * \param handle Handle to free (0 or stale handles are ignored)
+ */
+extern void unregisterTexture(TextureHandle handle);
+
+/**
+ * Advance registry frame counter (call once per frame, eg: after drawGLEnd())
+ *
+ * Textures bound before this call count as used in previous frames and
+ * are evicted if the registry is still over budget.
+ */
+extern void advanceTextureRegistryFrame();
+
+/**
+ * Get texture registry counters
+ *
+ * \sa TextureRegistryStats
+ */
+extern TextureRegistryStats getTextureRegistryStats();
+
+/**
+ * Free every registered texture and the registry itself
+ *
+ * \sa initTextureRegistry
+ */
+extern void quitTextureRegistry();
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,15 @@
+attribute mat4 a_instance_matrix;
+attribute vec4 a_instance_color;
+attribute float a_instance_layer;
+
+varying vec4 v_color;
+varying vec2 v_texCoord;
+varying float v_layer;
+
+void main()
+{
+    gl_Position = gl_ModelViewProjectionMatrix * (a_instance_matrix * gl_Vertex);
+    v_color = gl_Color * a_instance_color;
+	v_texCoord = gl_MultiTexCoord0.st;
+	v_layer = a_instance_layer;
+}
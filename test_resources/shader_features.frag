@@ -0,0 +1,24 @@
+varying vec4 v_color;
+varying vec2 v_texCoord;
+#ifdef USE_TEXTURE
+uniform sampler2D tex0;
+#endif
+
+// Features: USE_TEXTURE, USE_VERTEX_COLOR, USE_ALPHA (see loadShaderPermutations())
+void main()
+{
+    vec4 color = vec4(1.0, 1.0, 1.0, 1.0);
+
+#ifdef USE_TEXTURE
+    color *= texture2D(tex0, v_texCoord);
+#endif
+#ifdef USE_VERTEX_COLOR
+    color *= v_color;
+#endif
+#ifdef USE_ALPHA
+    vec2 delta = vec2(0.5, 0.5) - v_texCoord;
+    color.a *= 1.0 - (dot(delta, delta) * 4.0);
+#endif
+
+    gl_FragColor = color;
+}
\ No newline at end of file